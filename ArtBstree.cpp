@@ -0,0 +1,720 @@
+/**
+ * Implementation file for functions of the ArtBstree class
+ * @author Preston Gautreaux
+ * @see ArtBstree.h
+ * <pre>
+ * File: ArtBstree.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "ArtBstree.h"
+#include "ArtTree.cpp"
+#include "BstreeSnapshot.h"
+#include "BstreeOptimal.h"
+#include <algorithm>
+#include <utility>
+
+/* Nested Node class definitions */
+ArtBstree::Node::Node(Entry* entry)
+{
+    this->entry = entry;
+    left = nullptr;
+    right = nullptr;
+    parent = nullptr;
+}
+
+/* Nested Relatives class definitions */
+ArtBstree::Relatives::Relatives(vector<const Node*> start, bool expand, long count) : start(move(start))
+{
+    this->expand = expand;
+    this->count = count;
+}
+
+ArtBstree::Relatives::iterator ArtBstree::Relatives::begin() const
+{
+    return iterator(start, expand);
+}
+
+ArtBstree::Relatives::iterator ArtBstree::Relatives::end() const
+{
+    return iterator(vector<const Node*>(), expand);
+}
+
+long ArtBstree::Relatives::size() const
+{
+    return count;
+}
+
+bool ArtBstree::Relatives::empty() const
+{
+    return count == 0;
+}
+
+ArtBstree::Relatives::iterator::iterator(vector<const Node*> pending, bool expand) : pending(move(pending))
+{
+    this->expand = expand;
+}
+
+const string& ArtBstree::Relatives::iterator::operator*() const
+{
+    return pending.back()->entry->key();
+}
+
+const string* ArtBstree::Relatives::iterator::operator->() const
+{
+    return &pending.back()->entry->key();
+}
+
+ArtBstree::Relatives::iterator& ArtBstree::Relatives::iterator::operator++()
+{
+    const Node* cur = pending.back();
+    pending.pop_back();
+    if (!expand)
+    {
+        if (cur->parent)
+            pending.push_back(cur->parent);
+    }
+    else
+    {
+        if (cur->right)
+            pending.push_back(cur->right);
+        if (cur->left)
+            pending.push_back(cur->left);
+    }
+    return *this;
+}
+
+bool ArtBstree::Relatives::iterator::operator==(const iterator& other) const
+{
+    return pending.size() == other.pending.size() && (pending.empty() || pending.back() == other.pending.back());
+}
+
+bool ArtBstree::Relatives::iterator::operator!=(const iterator& other) const
+{
+    return !(*this == other);
+}
+
+/* Outer ArtBstree class definitions */
+ArtBstree::ArtBstree()
+{
+    root = nullptr;
+    order = 0;
+}
+
+ArtBstree::~ArtBstree()
+{
+    destroy(root);
+}
+
+void ArtBstree::destroy(Node* node)
+{
+    /* as Bstree::recDestroy: rotate left children up, free and go right */
+    while (node)
+    {
+        if (node->left)
+        {
+            Node* lft = node->left;
+            node->left = lft->right;
+            lft->right = node;
+            node = lft;
+        }
+        else
+        {
+            Node* rgt = node->right;
+            delete node;
+            node = rgt;
+        }
+    }
+}
+
+bool ArtBstree::empty() const
+{
+    return root == nullptr;
+}
+
+long ArtBstree::size() const
+{
+    return order;
+}
+
+ArtBstree::Node* ArtBstree::search(const string& item) const
+{
+    Entry* entry = index.find(item);
+    return entry ? entry->value : nullptr;
+}
+
+void ArtBstree::insert(string item)
+{
+    bool inserted;
+    Entry* entry = index.insert(item, nullptr, inserted);
+    if (!inserted)
+        return;
+    Node* newnode = new Node(entry);
+    entry->value = newnode;
+    order++;
+    if (!root)
+    {
+        root = newnode;
+        return;
+    }
+    /* a new leaf hangs off one of its inorder neighbours: the predecessor
+       when its right link is free, otherwise the successor, whose left link
+       is then necessarily free */
+    Entry* before = entry->prev();
+    if (before && !before->value->right)
+    {
+        newnode->parent = before->value;
+        before->value->right = newnode;
+    }
+    else
+    {
+        newnode->parent = entry->next()->value;
+        newnode->parent->left = newnode;
+    }
+}
+
+void ArtBstree::insert(Finger&, string item)
+{
+    insert(move(item));
+}
+
+bool ArtBstree::inTree(string item) const
+{
+    return index.find(item) != nullptr;
+}
+
+void ArtBstree::splice(Node* node)
+{
+    Node* child = node->left ? node->left : node->right;
+    if (child)
+        child->parent = node->parent;
+    if (!node->parent)
+        root = child;
+    else if (node->parent->left == node)
+        node->parent->left = child;
+    else
+        node->parent->right = child;
+}
+
+void ArtBstree::remove(Node* node)
+{
+    Entry* erased = node->entry;
+    Node* victim = node;
+    if (node->left && node->right)
+    {
+        /* the successor is the leftmost node of the right subtree; its entry
+           moves into this node and its own node is unlinked instead */
+        victim = erased->next()->value;
+        node->entry = victim->entry;
+        node->entry->value = node;
+    }
+    splice(victim);
+    delete victim;
+    index.erase(erased->key());
+    order--;
+}
+
+bool ArtBstree::remove(const string& item)
+{
+    Node* node = search(item);
+    if (!node)
+        return false;
+    remove(node);
+    return true;
+}
+
+long ArtBstree::erase_if(const function<bool(const string&)>& pred)
+{
+    return erase(pred, nullptr, nullptr);
+}
+
+long ArtBstree::erase(const string& lo, const string& hi)
+{
+    return erase([](const string&) { return true; }, &lo, &hi);
+}
+
+long ArtBstree::erase(const function<bool(const string&)>& pred, const string* lo, const string* hi)
+{
+    /* the same postorder walk as Bstree::erase, so both engines remove the
+       same nodes in the same order and keep identical shapes */
+    vector<pair<Node*, bool>> pending;
+    long removed = 0;
+    if (root)
+        pending.push_back(make_pair(root, false));
+    while (!pending.empty())
+    {
+        Node* node = pending.back().first;
+        if (!pending.back().second)
+        {
+            pending.back().second = true;
+            const string& key = node->entry->key();
+            if (node->right && (!hi || *hi > key))
+                pending.push_back(make_pair(node->right, false));
+            if (node->left && (!lo || key > *lo))
+                pending.push_back(make_pair(node->left, false));
+            continue;
+        }
+        pending.pop_back();
+        const string& key = node->entry->key();
+        if ((!lo || !(*lo > key)) && (!hi || *hi > key) && pred(key))
+        {
+            remove(node);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+const string& ArtBstree::retrieve(const string& key) const
+{
+    if (!root)
+        throw BstreeException("Exception:tree empty on retrieve().");
+    Entry* entry = index.find(key);
+    if (!entry)
+        throw BstreeException("Exception: non-existent key on retrieve().");
+    return entry->key();
+}
+
+void ArtBstree::preorderTraverse(Node* node, FuncType apply) const
+{
+    vector<Node*> pending;
+    while (node || !pending.empty())
+    {
+        if (!node)
+        {
+            node = pending.back();
+            pending.pop_back();
+        }
+        apply(node->entry->key());
+        if (node->right)
+            pending.push_back(node->right);
+        node = node->left;
+    }
+}
+
+void ArtBstree::postorderTraverse(Node* node, FuncType apply) const
+{
+    /* the parent links replace a stack: come up from a left child to go
+       right, and from a right child (or a missing one) to apply */
+    if (!node)
+        return;
+    Node* top = node->parent;
+    Node* last = top;
+    while (node != top)
+    {
+        if (last == node->parent && node->left)
+        {
+            last = node;
+            node = node->left;
+        }
+        else if (last != node->right && node->right)
+        {
+            last = node;
+            node = node->right;
+        }
+        else
+        {
+            apply(node->entry->key());
+            last = node;
+            node = node->parent;
+        }
+    }
+}
+
+void ArtBstree::preorderTraverse(FuncType apply) const
+{
+    preorderTraverse(root, apply);
+}
+
+void ArtBstree::inorderTraverse(FuncType apply) const
+{
+    for (Entry* entry = index.first(); entry; entry = entry->next())
+        apply(entry->key());
+}
+
+void ArtBstree::postorderTraverse(FuncType apply) const
+{
+    postorderTraverse(root, apply);
+}
+
+long ArtBstree::height(const Node* node) const
+{
+    vector<pair<const Node*, long>> pending;
+    long deepest = -1;
+    if (node)
+        pending.push_back({ node, 0 });
+    while (!pending.empty())
+    {
+        node = pending.back().first;
+        long depth = pending.back().second;
+        pending.pop_back();
+        deepest = max(deepest, depth);
+        if (node->right)
+            pending.push_back({ node->right, depth + 1 });
+        if (node->left)
+            pending.push_back({ node->left, depth + 1 });
+    }
+    return deepest;
+}
+
+long ArtBstree::height() const
+{
+    return height(root);
+}
+
+bool ArtBstree::isomorphic(const Node* lft, const Node* rgt) const
+{
+    vector<pair<const Node*, const Node*>> pending;
+    pending.push_back({ lft, rgt });
+    while (!pending.empty())
+    {
+        lft = pending.back().first;
+        rgt = pending.back().second;
+        pending.pop_back();
+        if (!lft && !rgt)
+            continue;
+        if (!lft || !rgt)
+            return false;
+        pending.push_back({ lft->right, rgt->right });
+        pending.push_back({ lft->left, rgt->left });
+    }
+    return true;
+}
+
+bool ArtBstree::isomorphic() const
+{
+    if (!root)
+        return true;
+    return isomorphic(root->left, root->right);
+}
+
+vector<string> ArtBstree::ancestors(string entry) const
+{
+    Relatives range = ancestor_range(entry);
+    vector<string> anc;
+    anc.reserve(range.size());
+    for (const string& key : range)
+        anc.push_back(key);
+    return anc;
+}
+
+vector<string> ArtBstree::descendants(string entry) const
+{
+    vector<string> desc;
+    if (!search(entry))
+        return desc;
+    Relatives range = descendant_range(entry);
+    desc.reserve(range.size());
+    for (const string& key : range)
+        desc.push_back(key);
+    return desc;
+}
+
+ArtBstree::Relatives ArtBstree::ancestor_range(const string& entry) const
+{
+    Node* cur = search(entry);
+    if (!cur)
+        throw BstreeException("Ancestors could not be found, element does not exist in tree");
+    long count = 0;
+    for (Node* up = cur->parent; up; up = up->parent)
+        count++;
+    vector<const Node*> start;
+    if (cur->parent)
+        start.push_back(cur->parent);
+    return Relatives(move(start), false, count);
+}
+
+ArtBstree::Relatives ArtBstree::descendant_range(const string& entry) const
+{
+    Node* cur = search(entry);
+    if (!cur)
+        throw BstreeException("Descendants could not be found, element does not exist in tree");
+    vector<const Node*> start;
+    if (cur->right)
+        start.push_back(cur->right);
+    if (cur->left)
+        start.push_back(cur->left);
+    /* no subtree sizes are kept: count the nodes below */
+    long count = 0;
+    vector<const Node*> pending(start);
+    while (!pending.empty())
+    {
+        const Node* node = pending.back();
+        pending.pop_back();
+        count++;
+        if (node->right)
+            pending.push_back(node->right);
+        if (node->left)
+            pending.push_back(node->left);
+    }
+    return Relatives(move(start), true, count);
+}
+
+long ArtBstree::descendant_count(const string& entry) const
+{
+    return descendant_range(entry).size();
+}
+
+const string* ArtBstree::getParent(string entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Entry does not exist in tree, cannot use getParent");
+    return node->parent ? &node->parent->entry->key() : nullptr;
+}
+
+const string* ArtBstree::getSibling(string entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Cannot find sibling: element does not exist in this tree");
+    if (!node->parent)
+        return nullptr;
+    Node* sibling = node->parent->left == node ? node->parent->right : node->parent->left;
+    return sibling ? &sibling->entry->key() : nullptr;
+}
+
+const string* ArtBstree::leftChild(string entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Entry does not exist in tree");
+    return node->left ? &node->left->entry->key() : nullptr;
+}
+
+const string* ArtBstree::rightChild(string entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Entry does not exist in tree");
+    return node->right ? &node->right->entry->key() : nullptr;
+}
+
+void ArtBstree::bias(bool& hlb, bool& hrb, Node* cur) const
+{
+    /* one postorder pass over the parent links, as in postorderTraverse;
+       the heights of finished subtrees are stacked */
+    if (!cur)
+        return;
+    vector<long> heights;
+    Node* top = cur->parent;
+    Node* last = top;
+    while (cur != top)
+    {
+        if (last == cur->parent && cur->left)
+        {
+            last = cur;
+            cur = cur->left;
+        }
+        else if (last != cur->right && cur->right)
+        {
+            last = cur;
+            cur = cur->right;
+        }
+        else
+        {
+            long rightH = -1, leftH = -1;
+            if (cur->right)
+            {
+                rightH = heights.back();
+                heights.pop_back();
+            }
+            if (cur->left)
+            {
+                leftH = heights.back();
+                heights.pop_back();
+            }
+            if (leftH < rightH)
+                hrb = true;
+            if (leftH > rightH)
+                hlb = true;
+            heights.push_back(1 + max(leftH, rightH));
+            last = cur;
+            cur = cur->parent;
+        }
+    }
+}
+
+bool ArtBstree::isFibonacci() const
+{
+    bool leftcheck = false;
+    bool rightcheck = false;
+    bias(leftcheck, rightcheck, root);
+    if (size() <= 1)
+        return true;
+    if (leftcheck && rightcheck)
+        return false;
+    int prev = 0;
+    int fib = 1;
+    int next = 1;
+    int final = size() + 1;
+    int h = height(root);
+    int i = 3;
+    for (; fib < final; i++)
+    {
+        next = prev + fib;
+        prev = fib;
+        fib = next;
+    }
+    return fib == final && h == i - 2;
+}
+
+void ArtBstree::compact()
+{
+    relink(nullptr);
+}
+
+void ArtBstree::optimize(const vector<double>& hits, const vector<double>& misses)
+{
+    if (static_cast<long>(hits.size()) != order)
+        throw BstreeException("Exception: there must be one access frequency per item on optimize().");
+    vector<size_t> shape = optimalShape(hits, misses);
+    relink(&shape);
+}
+
+void ArtBstree::relink(const vector<size_t>* preorder)
+{
+    vector<Node*> sorted;
+    sorted.reserve(index.size());
+    for (Entry* entry = index.first(); entry; entry = entry->next())
+        sorted.push_back(entry->value);
+    /* the middle node of each range, or the next node of the preorder,
+       roots the range, as in Bstree::rebuild */
+    struct Range
+    {
+        Node* parent;
+        Node** link;
+        size_t lo, hi;
+    };
+    vector<Range> ranges;
+    ranges.push_back({ nullptr, &root, 0, sorted.size() });
+    size_t next = 0;
+    while (!ranges.empty())
+    {
+        Range range = ranges.back();
+        ranges.pop_back();
+        if (range.lo == range.hi)
+        {
+            *range.link = nullptr;
+            continue;
+        }
+        size_t mid = preorder ? (*preorder)[next++] : range.lo + (range.hi - range.lo) / 2;
+        Node* node = sorted[mid];
+        node->parent = range.parent;
+        *range.link = node;
+        ranges.push_back({ node, &node->right, mid + 1, range.hi });
+        ranges.push_back({ node, &node->left, range.lo, mid });
+    }
+}
+
+void ArtBstree::save(const string& filename) const
+{
+    vector<const string*> keys;
+    vector<unsigned char> shape;
+    vector<const Node*> pending;
+    keys.reserve(index.size());
+    shape.reserve(index.size());
+    if (root)
+        pending.push_back(root);
+    while (!pending.empty())
+    {
+        const Node* cur = pending.back();
+        pending.pop_back();
+        keys.push_back(&cur->entry->key());
+        shape.push_back((cur->left ? 1 : 0) | (cur->right ? 2 : 0));
+        if (cur->right)
+            pending.push_back(cur->right);
+        if (cur->left)
+            pending.push_back(cur->left);
+    }
+    writeSnapshot<string>(filename, keys, shape);
+}
+
+void ArtBstree::open(const string& filename)
+{
+    SnapshotReader<string> snapshot(filename);
+
+    /* Rebuild in preorder as Bstree::open does; parent is the node whose
+       link is being filled, and the pending nodes still owe a right child */
+    ArtBstree loaded;
+    vector<Node*> pending;
+    Node* parent = nullptr;
+    bool rightLink = false, open = true, valid = true;
+    for (uint64_t k = 0; valid && k < snapshot.size(); k++)
+    {
+        bool inserted;
+        Entry* entry = open ? loaded.index.insert(snapshot.key(k), nullptr, inserted) : nullptr;
+        if (!entry || !inserted)
+        {
+            valid = false;
+            break;
+        }
+        Node* node = new Node(entry);
+        entry->value = node;
+        node->parent = parent;
+        if (!parent)
+            loaded.root = node;
+        else if (rightLink)
+            parent->right = node;
+        else
+            parent->left = node;
+        loaded.order++;
+        if (snapshot.shape(k) & 2)
+            pending.push_back(node);
+        if (snapshot.shape(k) & 1)
+        {
+            parent = node;
+            rightLink = false;
+        }
+        else if (!pending.empty())
+        {
+            parent = pending.back();
+            rightLink = true;
+            pending.pop_back();
+        }
+        else
+            open = false;
+    }
+    if (valid && (snapshot.size() > 0 && open))
+        valid = false;
+    /* the index orders the keys; the shape must agree with that order */
+    if (valid)
+    {
+        vector<const Node*> path;
+        const Node* cur = loaded.root;
+        Entry* expected = loaded.index.first();
+        while (valid && (cur || !path.empty()))
+        {
+            while (cur)
+            {
+                path.push_back(cur);
+                cur = cur->left;
+            }
+            cur = path.back();
+            path.pop_back();
+            valid = cur->entry == expected;
+            expected = expected->next();
+            cur = cur->right;
+        }
+    }
+    if (!valid || !pending.empty())
+        throw BstreeException("Exception: " + filename + " is corrupt or of another key type on open().");
+
+    swap(root, loaded.root);
+    swap(order, loaded.order);
+    index.swap(loaded.index);
+}
+
+const BstreeStats* ArtBstree::statistics() const
+{
+    return nullptr;
+}
+
+void ArtBstree::resetStatistics()
+{
+}
@@ -0,0 +1,581 @@
+/**
+ * The specification for a binary search tree of strings whose keys are
+ * located through an adaptive radix tree.
+ * @author Preston Gautreaux
+ * @see Bstree, ArtTree
+ * <pre>
+ * File: ArtBstree.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * ArtBstree offers the interface of Bstree<string> and keeps exactly the tree
+ * Bstree<string> would build for the same operations, so the shape-dependent
+ * answers (traversals, height, genealogy, properties) are identical. The
+ * shape nodes carry parent links, and an ArtTree maps every key to its shape
+ * node, so locating a key costs O(key length) instead of O(height) whole
+ * string comparisons:
+ * - insert finds the inorder neighbours of the new key in the ArtTree; the
+ *   new node becomes the right child of its predecessor when that is free,
+ *   and the left child of its successor otherwise
+ * - remove takes the inorder successor from the ArtTree's leaf order
+ * - inorder traversal walks the ArtTree's leaves
+ * The shape nodes keep no subtree sizes, which every insert would have to
+ * update up to the root, so descendant_count walks the subtree; the
+ * ancestors are walked lazily through the parent links.
+ * </pre>
+ */
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <iterator>
+
+#include "BstreeException.h"
+#include "BstreeStats.h"
+#include "ArtTree.h"
+
+#ifndef ARTBSTREE_H
+#define ARTBSTREE_H
+
+using namespace std;
+
+/**
+ * A binary search tree of strings indexed by an adaptive radix tree
+ */
+class ArtBstree
+{
+private:
+    /**
+     * forward declaration of a function pointer of type (const string&) -> void
+     */
+    typedef void (*FuncType)(const string& item);
+    /**
+     * forward declaration of the Node class
+     */
+    class Node;
+    /**
+     * a leaf of the index: a key and its shape node
+     */
+    typedef ArtTree<Node*>::Leaf Entry;
+    /**
+     * the number of nodes in this tree
+     */
+    long order;
+    /**
+     * A pointer to the root node of this tree
+     */
+    Node* root;
+    /**
+     * the keys of this tree and their nodes
+     */
+    ArtTree<Node*> index;
+
+    /**
+     * Gives the node holding the specified entry
+     * @param item the search key
+     * @return the node, or null if the key is not in the tree
+     */
+    Node* search(const string& item) const;
+
+    /**
+     * Replaces a node that has at most one child by that child
+     * @param node the node to be unlinked
+     */
+    void splice(Node* node);
+
+    /**
+     * Removes a node as Bstree::remove(Node**) does: a node with two
+     * children takes over the entry of its inorder successor, whose node
+     * is freed instead
+     * @param node the node to be removed
+     */
+    void remove(Node* node);
+
+    /**
+     * Removes, in postorder, the nodes whose key satisfies a predicate and
+     * lies within optional bounds, in the order Bstree::erase uses
+     * @param pred the predicate
+     * @param lo the inclusive lower bound, or null
+     * @param hi the exclusive upper bound, or null
+     * @return the number of nodes removed
+     */
+    long erase(const function<bool(const string&)>& pred, const string* lo, const string* hi);
+
+    /**
+     * Deletes a subtree
+     * @param node the root of the subtree
+     */
+    static void destroy(Node* node);
+
+    /**
+     * Relinks the nodes, taken in order from the index, into perfect
+     * balance or into a given shape
+     * @param preorder the inorder ranks of the nodes in the preorder of the
+     * new shape, or null for perfect balance
+     */
+    void relink(const vector<size_t>* preorder);
+
+    /**
+     * Traverses the subtree rooted at the specified node in preorder
+     * @param node a node of this tree
+     * @param apply the function applied to each entry
+     */
+    void preorderTraverse(Node* node, FuncType apply) const;
+
+    /**
+     * Traverses the subtree rooted at the specified node in postorder
+     * @param node a node of this tree
+     * @param apply the function applied to each entry
+     */
+    void postorderTraverse(Node* node, FuncType apply) const;
+
+    /**
+     * Computes the height of the subtree rooted at the specified node
+     * @param node the root of a subtree
+     * @return the height of the subtree
+     */
+    long height(const Node* node) const;
+
+    /**
+     * Determines whether two subtrees have the same shape
+     * @param lft the root of the left subtree
+     * @param rgt the root of the right subtree
+     * @return true if the subtrees are isomorphic; otherwise, false
+     */
+    bool isomorphic(const Node* lft, const Node* rgt) const;
+
+    /**
+     * Determines whether the subtree rooted at the specified node has a
+     * left-heavy and/or a right-heavy node
+     * @param hlb set when a left-heavy node is found
+     * @param hrb set when a right-heavy node is found
+     * @param cur the root of a subtree
+     */
+    void bias(bool& hlb, bool& hrb, Node* cur) const;
+
+public:
+    /**
+     * forward declaration of the Relatives class
+     */
+    class Relatives;
+
+    /**
+     * Constructs an empty tree
+     */
+    ArtBstree();
+
+    /**
+     * The index refers to the shape nodes, so a tree cannot be copied
+     */
+    ArtBstree(const ArtBstree& other) = delete;
+    ArtBstree& operator=(const ArtBstree& other) = delete;
+
+    /**
+     * Returns the memory of this tree to the system
+     */
+    virtual ~ArtBstree();
+
+    /**
+     * Determines whether the tree is empty.
+     * @return true if the tree is empty; otherwise, false
+     */
+    bool empty() const;
+
+    /**
+     * Inserts an item into the tree; an item that is already in the tree
+     * is left in place.
+     * @param item the value to be inserted.
+     */
+    void insert(string item);
+
+    /**
+     * A finger for the interface of Bstree::insert(Finger&, T); the index
+     * already finds the neighbours of a key in O(key length), so it holds
+     * no position
+     */
+    struct Finger
+    {
+    };
+
+    /**
+     * Inserts an item into the tree as insert(item) does
+     * @param finger ignored
+     * @param item the value to be inserted.
+     */
+    void insert(Finger& finger, string item);
+
+    /**
+     * Determines whether an item is in the tree.
+     * @param item item with a specified search key.
+     * @return true on success; false on failure.
+     */
+    bool inTree(string item) const;
+
+    /**
+     * Deletes an item from the tree.
+     * @param item item with a specified search key.
+     * @return true on success; false on failure.
+     */
+    bool remove(const string& item);
+
+    /**
+     * Deletes every item that satisfies a predicate
+     * @param pred a function of type (const string&) -> bool
+     * @return the number of items deleted
+     */
+    long erase_if(const function<bool(const string&)>& pred);
+
+    /**
+     * Deletes every item in the half-open range [lo, hi)
+     * @param lo the smallest item to be deleted
+     * @param hi the bound above the items to be deleted
+     * @return the number of items deleted
+     */
+    long erase(const string& lo, const string& hi);
+
+    /**
+     * Returns the item in the tree with the specified key.
+     * @param key the key to the item to be retrieved.
+     * @return it with the specified key.
+     * @throws BstreeException if the item is not in the tree
+     */
+    const string& retrieve(const string& key) const;
+
+    /**
+     * Gives the number of node in this tree
+     * @return the size of the tree; the number of nodes in this tree.
+     */
+    long size() const;
+
+    /**
+     * Traverses the tree in preorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const string&) -> void
+     */
+    void preorderTraverse(FuncType apply) const;
+
+    /**
+     * Traverses the tree in inorder by walking the leaves of the index,
+     * and applies the function visit once for each node.
+     * @param apply a pointer to a function of type (const string&) -> void
+     */
+    void inorderTraverse(FuncType apply) const;
+
+    /**
+     * Traverses the tree in postorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const string&) -> void
+     */
+    void postorderTraverse(FuncType apply) const;
+
+    /**
+     * Gives the height of this tree
+     * @return the height of this tree
+     */
+    long height() const;
+
+    /**
+     * Generates a vector of ancestors of the specified entry, nearest first
+     * @param entry an entry in this tree
+     * @return a vector of ancestors of the specified entry
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    vector<string> ancestors(string entry) const;
+
+    /**
+     * Generates the descendants of the specified entry as
+     * Bstree::descendants does
+     * @param entry an entry in this tree
+     * @return a vector of descendants of the specified entry, empty when
+     * the entry is not in this tree
+     */
+    vector<string> descendants(string entry) const;
+
+    /**
+     * Gives the ancestors of the specified entry, nearest first, without
+     * copying them; the parent links are followed as the range is iterated
+     * @param entry an entry in this tree
+     * @return the ancestors, valid until this tree is next modified
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    Relatives ancestor_range(const string& entry) const;
+
+    /**
+     * Gives the descendants of the specified entry in preorder, the entry
+     * itself excluded, without copying them
+     * @param entry an entry in this tree
+     * @return the descendants, valid until this tree is next modified
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    Relatives descendant_range(const string& entry) const;
+
+    /**
+     * Gives the number of descendants of the specified entry by walking
+     * its subtree
+     * @param entry an entry in this tree
+     * @return the number of nodes in the subtree of the entry, less one
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    long descendant_count(const string& entry) const;
+
+    /**
+     * Determines whether the left and right subtrees of the root
+     * of this tree are isomorphic
+     * @return true if they are isomorphic or the tree is empty;
+     * otherwise, false
+     */
+    bool isomorphic() const;
+
+    /**
+     * Gives a pointer to the parent of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the parent's entry or null for the root
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const string* getParent(string entry) const;
+
+    /**
+     * Gives a pointer to the sibling of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the sibling's entry or null if it has none
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const string* getSibling(string entry) const;
+
+    /**
+     * Gives a pointer to the left child of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the left child's entry or null if it has none
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const string* leftChild(string entry) const;
+
+    /**
+     * Gives a pointer to the right child of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the right child's entry or null if it has none
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const string* rightChild(string entry) const;
+
+    /**
+     * Determines whether this tree is a Fibonacci tree
+     * @return true if the tree is a Fibonacci tree; otherwise, false
+     */
+    bool isFibonacci() const;
+
+    /**
+     * Rebuilds the tree into perfect balance, as Bstree::compact does; the
+     * nodes are taken in order from the index and relinked
+     */
+    void compact();
+
+    /**
+     * Reshapes the tree into one of least expected search cost for the
+     * given access frequencies, as Bstree::optimize does
+     * @param hits hits[k] is the frequency of lookups of the kth key in
+     * inorder
+     * @param misses misses[g] is the frequency of lookups of missing keys
+     * below the gth key and above the one before it, or empty
+     * @throw BstreeException when the frequencies are negative or of the
+     * wrong sizes; the tree is then unchanged
+     */
+    void optimize(const vector<double>& hits, const vector<double>& misses);
+
+    /**
+     * Writes the tree to a snapshot file; see BstreeSnapshot.h
+     * @param filename the name of the snapshot
+     * @throw BstreeException when the file cannot be written
+     */
+    void save(const string& filename) const;
+
+    /**
+     * Replaces the tree by the contents of a snapshot file; the tree is
+     * unchanged when the file cannot be read
+     * @param filename the name of the snapshot
+     * @throw BstreeException when the file is missing, corrupt, holds
+     * duplicate keys or is not in search tree order
+     */
+    void open(const string& filename);
+
+    /**
+     * This engine has no instrumentation counters
+     * @return null
+     */
+    const BstreeStats* statistics() const;
+
+    /**
+     * Does nothing; this engine has no instrumentation counters
+     */
+    void resetStatistics();
+};
+
+/**
+ * nested Node class definition: the shape of the tree; the key is held by
+ * the index entry
+ */
+class ArtBstree::Node
+{
+private:
+    /**
+     * the index entry holding the key of this Node
+     */
+    Entry* entry;
+    /**
+     * pointers to the children and the parent of this Node
+     */
+    Node* left;
+    Node* right;
+    Node* parent;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * ArtBstree class
+     */
+    friend class ArtBstree;
+public:
+    /**
+     * Constructs a node for an index entry
+     * @param entry the entry holding the key
+     */
+    Node(Entry* entry);
+};
+
+/**
+ * nested Relatives class definition: a range over the ancestors or the
+ * descendants of an entry that yields the keys in place, as
+ * Bstree::Relatives does
+ */
+class ArtBstree::Relatives
+{
+public:
+    /**
+     * forward declaration of the iterator class
+     */
+    class iterator;
+
+private:
+    /**
+     * the nodes the iteration starts from, the first one last
+     */
+    vector<const Node*> start;
+    /**
+     * whether the children of each node are visited after it (descendants)
+     * or its parent is (ancestors)
+     */
+    bool expand;
+    /**
+     * the number of keys in the range
+     */
+    long count;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * ArtBstree class
+     */
+    friend class ArtBstree;
+
+    /**
+     * Constructs a range
+     * @param start the nodes the iteration starts from, the first one last
+     * @param expand whether the children of each node are visited after it
+     * rather than its parent
+     * @param count the number of keys in the range
+     */
+    Relatives(vector<const Node*> start, bool expand, long count);
+
+public:
+    /**
+     * Gives an iterator at the first key of the range
+     * @return the iterator
+     */
+    iterator begin() const;
+
+    /**
+     * Gives the iterator past the last key of the range
+     * @return the iterator
+     */
+    iterator end() const;
+
+    /**
+     * Gives the number of keys in the range; O(1)
+     * @return the number of keys
+     */
+    long size() const;
+
+    /**
+     * Determines whether the range has no keys
+     * @return true if the range is empty; otherwise, false
+     */
+    bool empty() const;
+};
+
+/**
+ * nested iterator class definition of Relatives: a forward iterator whose
+ * pending nodes are kept on an explicit stack, the next one on top
+ */
+class ArtBstree::Relatives::iterator
+{
+private:
+    /**
+     * the nodes still to be visited, the current one on top
+     */
+    vector<const Node*> pending;
+    /**
+     * whether the children of the current node are visited after it rather
+     * than its parent
+     */
+    bool expand;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * Relatives class
+     */
+    friend class Relatives;
+
+    /**
+     * Constructs an iterator
+     * @param pending the nodes to be visited, the first one last
+     * @param expand whether the children of each node are visited after it
+     * rather than its parent
+     */
+    iterator(vector<const Node*> pending, bool expand);
+
+public:
+    typedef forward_iterator_tag iterator_category;
+    typedef string value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const string* pointer;
+    typedef const string& reference;
+
+    /**
+     * Gives the current key
+     * @return the key, in place
+     */
+    const string& operator*() const;
+
+    /**
+     * Gives the address of the current key
+     * @return the address
+     */
+    const string* operator->() const;
+
+    /**
+     * Advances to the next key
+     * @return this iterator
+     */
+    iterator& operator++();
+
+    /**
+     * Determines whether two iterators of one range are at the same key
+     * @param other another iterator
+     * @return true if they are; otherwise, false
+     */
+    bool operator==(const iterator& other) const;
+
+    /**
+     * Determines whether two iterators of one range are at different keys
+     * @param other another iterator
+     * @return true if they are; otherwise, false
+     */
+    bool operator!=(const iterator& other) const;
+};
+#endif //ARTBSTREE_H
@@ -0,0 +1,756 @@
+/**
+ * Implementation file for functions of the ArtTree<V> class
+ * @author Preston Gautreaux
+ * @see ArtTree.h
+ * <pre>
+ * File: ArtTree.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "ArtTree.h"
+#include <cstring>
+#include <utility>
+
+/* Nested node class definitions */
+
+/**
+ * The part shared by every inner node layout
+ */
+template <typename V>
+class ArtTree<V>::Inner : public ArtTree<V>::Node
+{
+public:
+    /**
+     * the number of children
+     */
+    uint16_t children;
+    /**
+     * the key bytes shared by every key below this node, after the byte
+     * that led to it
+     */
+    string prefix;
+    /**
+     * the leaf of the key that ends at this node, or null
+     */
+    Leaf* terminal;
+
+    Inner(NodeType layout)
+    {
+        this->type = layout;
+        children = 0;
+        terminal = nullptr;
+    }
+};
+
+/**
+ * An inner node with up to 4 children, kept in byte order
+ */
+template <typename V>
+class ArtTree<V>::Node4 : public ArtTree<V>::Inner
+{
+public:
+    unsigned char bytes[4];
+    Node* child[4];
+
+    Node4() : Inner(NODE4) {}
+};
+
+/**
+ * An inner node with up to 16 children, kept in byte order
+ */
+template <typename V>
+class ArtTree<V>::Node16 : public ArtTree<V>::Inner
+{
+public:
+    unsigned char bytes[16];
+    Node* child[16];
+
+    Node16() : Inner(NODE16) {}
+};
+
+/**
+ * An inner node with up to 48 children, reached through a 256-entry index
+ * holding slot + 1, or 0 for no child
+ */
+template <typename V>
+class ArtTree<V>::Node48 : public ArtTree<V>::Inner
+{
+public:
+    unsigned char index[256];
+    Node* child[48];
+
+    Node48() : Inner(NODE48)
+    {
+        memset(index, 0, sizeof(index));
+        memset(child, 0, sizeof(child));
+    }
+};
+
+/**
+ * An inner node with a slot for every byte
+ */
+template <typename V>
+class ArtTree<V>::Node256 : public ArtTree<V>::Inner
+{
+public:
+    Node* child[256];
+
+    Node256() : Inner(NODE256)
+    {
+        memset(child, 0, sizeof(child));
+    }
+};
+
+template <typename V>
+ArtTree<V>::Leaf::Leaf(const string& key, const V& value) : word(key), value(value)
+{
+    this->type = LEAF;
+    before = nullptr;
+    after = nullptr;
+}
+
+template <typename V>
+const string& ArtTree<V>::Leaf::key() const
+{
+    return word;
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::Leaf::prev() const
+{
+    return before;
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::Leaf::next() const
+{
+    return after;
+}
+
+/* Outer ArtTree class definitions */
+
+template <typename V>
+ArtTree<V>::ArtTree()
+{
+    root = nullptr;
+    head = nullptr;
+    tail = nullptr;
+    count = 0;
+}
+
+template <typename V>
+ArtTree<V>::~ArtTree()
+{
+    destroy(root);
+}
+
+template <typename V>
+void ArtTree<V>::destroy(Node* node)
+{
+    if (!node)
+        return;
+    if (node->type == LEAF)
+    {
+        delete static_cast<Leaf*>(node);
+        return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    destroy(inner->terminal);
+    unsigned char byte;
+    for (Node* child = childAtOrAfter(inner, 0, byte); child; child = byte < 255 ? childAtOrAfter(inner, byte + 1, byte) : nullptr)
+        destroy(child);
+    switch (node->type)
+    {
+    case NODE4:
+        delete static_cast<Node4*>(node);
+        break;
+    case NODE16:
+        delete static_cast<Node16*>(node);
+        break;
+    case NODE48:
+        delete static_cast<Node48*>(node);
+        break;
+    default:
+        delete static_cast<Node256*>(node);
+        break;
+    }
+}
+
+template <typename V>
+size_t ArtTree<V>::size() const
+{
+    return count;
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::first() const
+{
+    return head;
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::last() const
+{
+    return tail;
+}
+
+template <typename V>
+typename ArtTree<V>::Node** ArtTree<V>::findChild(Inner* node, unsigned char byte)
+{
+    switch (node->type)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        for (int k = 0; k < n->children; k++)
+            if (n->bytes[k] == byte)
+                return &n->child[k];
+        return nullptr;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        for (int k = 0; k < n->children; k++)
+            if (n->bytes[k] == byte)
+                return &n->child[k];
+        return nullptr;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        return n->index[byte] ? &n->child[n->index[byte] - 1] : nullptr;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        return n->child[byte] ? &n->child[byte] : nullptr;
+    }
+    }
+}
+
+template <typename V>
+typename ArtTree<V>::Node* ArtTree<V>::childAtOrAfter(Inner* node, int byte, unsigned char& found)
+{
+    switch (node->type)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        for (int k = 0; k < n->children; k++)
+            if (n->bytes[k] >= byte)
+            {
+                found = n->bytes[k];
+                return n->child[k];
+            }
+        return nullptr;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        for (int k = 0; k < n->children; k++)
+            if (n->bytes[k] >= byte)
+            {
+                found = n->bytes[k];
+                return n->child[k];
+            }
+        return nullptr;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        for (int b = byte; b < 256; b++)
+            if (n->index[b])
+            {
+                found = b;
+                return n->child[n->index[b] - 1];
+            }
+        return nullptr;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        for (int b = byte; b < 256; b++)
+            if (n->child[b])
+            {
+                found = b;
+                return n->child[b];
+            }
+        return nullptr;
+    }
+    }
+}
+
+/**
+ * Inserts a child into the sorted arrays of a Node4 or Node16 that has room
+ * @param bytes the sorted bytes
+ * @param child the children, parallel to bytes
+ * @param used the number of children
+ * @param byte the byte of the new child
+ * @param node the new child
+ */
+template <typename N>
+static void insertSorted(unsigned char* bytes, N** child, int used, unsigned char byte, N* node)
+{
+    int pos = used;
+    while (pos > 0 && bytes[pos - 1] > byte)
+    {
+        bytes[pos] = bytes[pos - 1];
+        child[pos] = child[pos - 1];
+        pos--;
+    }
+    bytes[pos] = byte;
+    child[pos] = node;
+}
+
+template <typename V>
+void ArtTree<V>::addChild(Node*& ref, unsigned char byte, Node* child)
+{
+    Inner* inner = static_cast<Inner*>(ref);
+    switch (inner->type)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(inner);
+        if (n->children < 4)
+        {
+            insertSorted(n->bytes, n->child, n->children, byte, child);
+            n->children++;
+            return;
+        }
+        Node16* grown = new Node16();
+        grown->prefix = move(n->prefix);
+        grown->terminal = n->terminal;
+        memcpy(grown->bytes, n->bytes, 4);
+        memcpy(grown->child, n->child, 4 * sizeof(Node*));
+        grown->children = 4;
+        delete n;
+        ref = grown;
+        addChild(ref, byte, child);
+        return;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(inner);
+        if (n->children < 16)
+        {
+            insertSorted(n->bytes, n->child, n->children, byte, child);
+            n->children++;
+            return;
+        }
+        Node48* grown = new Node48();
+        grown->prefix = move(n->prefix);
+        grown->terminal = n->terminal;
+        for (int k = 0; k < 16; k++)
+        {
+            grown->child[k] = n->child[k];
+            grown->index[n->bytes[k]] = k + 1;
+        }
+        grown->children = 16;
+        delete n;
+        ref = grown;
+        addChild(ref, byte, child);
+        return;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(inner);
+        if (n->children < 48)
+        {
+            int slot = 0;
+            while (n->child[slot])
+                slot++;
+            n->child[slot] = child;
+            n->index[byte] = slot + 1;
+            n->children++;
+            return;
+        }
+        Node256* grown = new Node256();
+        grown->prefix = move(n->prefix);
+        grown->terminal = n->terminal;
+        for (int b = 0; b < 256; b++)
+            if (n->index[b])
+                grown->child[b] = n->child[n->index[b] - 1];
+        grown->children = 48;
+        delete n;
+        ref = grown;
+        addChild(ref, byte, child);
+        return;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(inner);
+        n->child[byte] = child;
+        n->children++;
+        return;
+    }
+    }
+}
+
+template <typename V>
+void ArtTree<V>::removeChild(Node*& ref, unsigned char byte)
+{
+    Inner* inner = static_cast<Inner*>(ref);
+    switch (inner->type)
+    {
+    case NODE4:
+    case NODE16:
+    {
+        unsigned char* bytes;
+        Node** child;
+        if (inner->type == NODE4)
+        {
+            bytes = static_cast<Node4*>(inner)->bytes;
+            child = static_cast<Node4*>(inner)->child;
+        }
+        else
+        {
+            bytes = static_cast<Node16*>(inner)->bytes;
+            child = static_cast<Node16*>(inner)->child;
+        }
+        int pos = 0;
+        while (bytes[pos] != byte)
+            pos++;
+        for (; pos + 1 < inner->children; pos++)
+        {
+            bytes[pos] = bytes[pos + 1];
+            child[pos] = child[pos + 1];
+        }
+        inner->children--;
+        if (inner->type == NODE16 && inner->children <= 3)
+        {
+            Node16* n = static_cast<Node16*>(inner);
+            Node4* shrunk = new Node4();
+            shrunk->prefix = move(n->prefix);
+            shrunk->terminal = n->terminal;
+            memcpy(shrunk->bytes, n->bytes, n->children);
+            memcpy(shrunk->child, n->child, n->children * sizeof(Node*));
+            shrunk->children = n->children;
+            delete n;
+            ref = shrunk;
+        }
+        break;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(inner);
+        n->child[n->index[byte] - 1] = nullptr;
+        n->index[byte] = 0;
+        n->children--;
+        if (n->children <= 12)
+        {
+            Node16* shrunk = new Node16();
+            shrunk->prefix = move(n->prefix);
+            shrunk->terminal = n->terminal;
+            for (int b = 0; b < 256; b++)
+                if (n->index[b])
+                {
+                    shrunk->bytes[shrunk->children] = b;
+                    shrunk->child[shrunk->children] = n->child[n->index[b] - 1];
+                    shrunk->children++;
+                }
+            delete n;
+            ref = shrunk;
+        }
+        break;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(inner);
+        n->child[byte] = nullptr;
+        n->children--;
+        if (n->children <= 37)
+        {
+            Node48* shrunk = new Node48();
+            shrunk->prefix = move(n->prefix);
+            shrunk->terminal = n->terminal;
+            for (int b = 0; b < 256; b++)
+                if (n->child[b])
+                {
+                    shrunk->child[shrunk->children] = n->child[b];
+                    shrunk->index[b] = shrunk->children + 1;
+                    shrunk->children++;
+                }
+            delete n;
+            ref = shrunk;
+        }
+        break;
+    }
+    }
+    collapse(ref);
+}
+
+template <typename V>
+void ArtTree<V>::collapse(Node*& ref)
+{
+    Inner* inner = static_cast<Inner*>(ref);
+    if (inner->children == 0)
+    {
+        ref = inner->terminal;
+        delete static_cast<Node4*>(inner);
+    }
+    else if (inner->children == 1 && !inner->terminal)
+    {
+        /* only a Node4 can be down to one child */
+        Node4* n = static_cast<Node4*>(inner);
+        Node* child = n->child[0];
+        if (child->type != LEAF)
+        {
+            Inner* below = static_cast<Inner*>(child);
+            below->prefix = n->prefix + static_cast<char>(n->bytes[0]) + below->prefix;
+        }
+        ref = child;
+        delete n;
+    }
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::find(const string& key) const
+{
+    Node* node = root;
+    size_t depth = 0;
+    while (node)
+    {
+        if (node->type == LEAF)
+        {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            return leaf->word == key ? leaf : nullptr;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        const string& prefix = inner->prefix;
+        if (key.size() - depth < prefix.size() || key.compare(depth, prefix.size(), prefix) != 0)
+            return nullptr;
+        depth += prefix.size();
+        if (depth == key.size())
+            return inner->terminal;
+        Node** child = findChild(inner, key[depth]);
+        node = child ? *child : nullptr;
+        depth++;
+    }
+    return nullptr;
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::minimum(Node* node)
+{
+    while (node && node->type != LEAF)
+    {
+        Inner* inner = static_cast<Inner*>(node);
+        if (inner->terminal)
+            return inner->terminal;
+        unsigned char byte;
+        node = childAtOrAfter(inner, 0, byte);
+    }
+    return static_cast<Leaf*>(node);
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::lowerBound(Node* node, const string& key, size_t depth)
+{
+    if (!node)
+        return nullptr;
+    if (node->type == LEAF)
+    {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        return leaf->word >= key ? leaf : nullptr;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    const string& prefix = inner->prefix;
+    for (size_t k = 0; k < prefix.size(); k++)
+    {
+        /* a key that ends inside the prefix or diverges below it precedes
+           every key of this subtree; one that diverges above it follows them */
+        if (depth + k == key.size())
+            return minimum(node);
+        unsigned char mine = key[depth + k], theirs = prefix[k];
+        if (mine < theirs)
+            return minimum(node);
+        if (mine > theirs)
+            return nullptr;
+    }
+    depth += prefix.size();
+    if (depth == key.size())
+        return minimum(node);
+    unsigned char byte = key[depth], found;
+    Node** child = findChild(inner, byte);
+    if (child)
+    {
+        Leaf* leaf = lowerBound(*child, key, depth + 1);
+        if (leaf)
+            return leaf;
+    }
+    Node* next = byte < 255 ? childAtOrAfter(inner, byte + 1, found) : nullptr;
+    return next ? minimum(next) : nullptr;
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::lowerBound(const string& key) const
+{
+    return lowerBound(root, key, 0);
+}
+
+template <typename V>
+typename ArtTree<V>::Leaf* ArtTree<V>::insert(const string& key, const V& value, bool& inserted)
+{
+    Leaf* successor = lowerBound(key);
+    if (successor && successor->word == key)
+    {
+        inserted = false;
+        return successor;
+    }
+    inserted = true;
+    Leaf* leaf = new Leaf(key, value);
+    leaf->after = successor;
+    leaf->before = successor ? successor->before : tail;
+    if (leaf->before)
+        leaf->before->after = leaf;
+    else
+        head = leaf;
+    if (successor)
+        successor->before = leaf;
+    else
+        tail = leaf;
+    count++;
+
+    Node** ref = &root;
+    size_t depth = 0;
+    while (true)
+    {
+        Node* node = *ref;
+        if (!node)
+        {
+            *ref = leaf;
+            return leaf;
+        }
+        if (node->type == LEAF)
+        {
+            /* lazy expansion: split the leaf at the first differing byte */
+            Leaf* other = static_cast<Leaf*>(node);
+            size_t common = depth;
+            while (common < key.size() && common < other->word.size() && key[common] == other->word[common])
+                common++;
+            Node4* split = new Node4();
+            split->prefix = key.substr(depth, common - depth);
+            Node* splitRef = split;
+            Leaf* pair[2] = { other, leaf };
+            for (Leaf* member : pair)
+            {
+                if (member->word.size() == common)
+                    split->terminal = member;
+                else
+                    addChild(splitRef, member->word[common], member);
+            }
+            *ref = split;
+            return leaf;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        const string& prefix = inner->prefix;
+        size_t matched = 0;
+        while (matched < prefix.size() && depth + matched < key.size() && key[depth + matched] == prefix[matched])
+            matched++;
+        if (matched < prefix.size())
+        {
+            /* the key diverges inside the compressed path: split the path */
+            Node4* split = new Node4();
+            split->prefix = prefix.substr(0, matched);
+            unsigned char byte = prefix[matched];
+            inner->prefix = prefix.substr(matched + 1);
+            Node* splitRef = split;
+            addChild(splitRef, byte, inner);
+            if (depth + matched == key.size())
+                split->terminal = leaf;
+            else
+                addChild(splitRef, key[depth + matched], leaf);
+            *ref = split;
+            return leaf;
+        }
+        depth += prefix.size();
+        if (depth == key.size())
+        {
+            inner->terminal = leaf;
+            return leaf;
+        }
+        Node** child = findChild(inner, key[depth]);
+        if (!child)
+        {
+            addChild(*ref, key[depth], leaf);
+            return leaf;
+        }
+        ref = child;
+        depth++;
+    }
+}
+
+template <typename V>
+bool ArtTree<V>::erase(const string& key)
+{
+    /* every inner node holds at least two keys, so removing one changes at
+       most the slot of the leaf and the node just above it */
+    Node** parent = nullptr;
+    unsigned char byte = 0;
+    Node** ref = &root;
+    size_t depth = 0;
+    Leaf* leaf = nullptr;
+    while (*ref && !leaf)
+    {
+        Node* node = *ref;
+        if (node->type == LEAF)
+        {
+            if (static_cast<Leaf*>(node)->word != key)
+                return false;
+            leaf = static_cast<Leaf*>(node);
+            if (parent)
+                removeChild(*parent, byte);
+            else
+                root = nullptr;
+            break;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        const string& prefix = inner->prefix;
+        if (key.size() - depth < prefix.size() || key.compare(depth, prefix.size(), prefix) != 0)
+            return false;
+        depth += prefix.size();
+        if (depth == key.size())
+        {
+            leaf = inner->terminal;
+            if (!leaf)
+                return false;
+            inner->terminal = nullptr;
+            collapse(*ref);
+            break;
+        }
+        Node** child = findChild(inner, key[depth]);
+        if (!child)
+            return false;
+        parent = ref;
+        byte = key[depth];
+        ref = child;
+        depth++;
+    }
+    if (!leaf)
+        return false;
+    if (leaf->before)
+        leaf->before->after = leaf->after;
+    else
+        head = leaf->after;
+    if (leaf->after)
+        leaf->after->before = leaf->before;
+    else
+        tail = leaf->before;
+    delete leaf;
+    count--;
+    return true;
+}
+
+template <typename V>
+void ArtTree<V>::swap(ArtTree<V>& other)
+{
+    std::swap(root, other.root);
+    std::swap(head, other.head);
+    std::swap(tail, other.tail);
+    std::swap(count, other.count);
+}
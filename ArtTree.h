@@ -0,0 +1,278 @@
+/**
+ * The specification for an adaptive radix tree (ART) keyed by strings.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: ArtTree.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * Leis, Kemper and Neumann, "The Adaptive Radix Tree: ARTful Indexing for
+ * Main-Memory Databases". Inner nodes branch on one byte of the key and grow
+ * through four layouts (4, 16, 48 and 256 children) as they fill up, so
+ * sparse and dense levels both stay compact. Each inner node carries the
+ * compressed path (prefix) shared by all of its keys, and a key that ends at
+ * an inner node is held in that node's terminal slot. Leaves store the whole
+ * key and are chained in key order. Every operation costs O(key length),
+ * however many keys share a prefix.
+ * </pre>
+ */
+
+#include <string>
+#include <cstdint>
+
+#ifndef ARTTREE_H
+#define ARTTREE_H
+
+using namespace std;
+
+/**
+ * An ordered map from strings to values, with byte-wise (std::string) order
+ * @param <V> the type of the values
+ */
+template <typename V> class ArtTree
+{
+public:
+    /**
+     * forward declaration of the Leaf class
+     */
+    class Leaf;
+
+private:
+    /**
+     * the layouts of a node
+     */
+    enum NodeType { LEAF, NODE4, NODE16, NODE48, NODE256 };
+    /**
+     * forward declaration of the node classes; Node is the base of the
+     * leaves and of the inner node layouts
+     */
+    class Node;
+    class Inner;
+    class Node4;
+    class Node16;
+    class Node48;
+    class Node256;
+
+    /**
+     * the root node, or null for the empty tree
+     */
+    Node* root;
+    /**
+     * the smallest and largest leaves
+     */
+    Leaf* head;
+    Leaf* tail;
+    /**
+     * the number of keys
+     */
+    size_t count;
+
+    /**
+     * Gives the slot holding the child of an inner node for a byte
+     * @param node an inner node
+     * @param byte the next byte of a key
+     * @return the slot, or null when there is no such child
+     */
+    static Node** findChild(Inner* node, unsigned char byte);
+
+    /**
+     * Adds a child to an inner node, replacing the node by a larger layout
+     * when it is full
+     * @param ref the slot holding the inner node
+     * @param byte the byte the child is reached by
+     * @param child the child
+     */
+    static void addChild(Node*& ref, unsigned char byte, Node* child);
+
+    /**
+     * Removes the child of an inner node for a byte, replacing the node by a
+     * smaller layout when it becomes sparse, or by its only remaining
+     * descendant
+     * @param ref the slot holding the inner node
+     * @param byte the byte the child is reached by
+     */
+    static void removeChild(Node*& ref, unsigned char byte);
+
+    /**
+     * Collapses an inner node that holds a single key path: a node with no
+     * children becomes its terminal leaf; a node with one child and no
+     * terminal is merged into the child
+     * @param ref the slot holding the inner node
+     */
+    static void collapse(Node*& ref);
+
+    /**
+     * Gives the first child of an inner node whose byte is greater than or
+     * equal to the specified byte
+     * @param node an inner node
+     * @param byte the smallest byte of interest
+     * @param found receives the byte of the child
+     * @return the child, or null when there is none
+     */
+    static Node* childAtOrAfter(Inner* node, int byte, unsigned char& found);
+
+    /**
+     * Gives the smallest leaf of a subtree
+     * @param node the root of a subtree
+     * @return its smallest leaf
+     */
+    static Leaf* minimum(Node* node);
+
+    /**
+     * Gives the first leaf of a subtree whose key is at least the
+     * specified key
+     * @param node the root of a subtree
+     * @param key the search key
+     * @param depth the number of key bytes consumed above the subtree
+     * @return the leaf, or null when every key of the subtree is smaller
+     */
+    static Leaf* lowerBound(Node* node, const string& key, size_t depth);
+
+    /**
+     * Frees a subtree
+     * @param node the root of a subtree
+     */
+    static void destroy(Node* node);
+
+public:
+    /**
+     * Constructs an empty tree
+     */
+    ArtTree();
+
+    /**
+     * The leaves are linked to each other and to their owner, so a tree
+     * cannot be copied
+     */
+    ArtTree(const ArtTree<V>& other) = delete;
+    ArtTree<V>& operator=(const ArtTree<V>& other) = delete;
+
+    /**
+     * Returns the memory of this tree to the system
+     */
+    virtual ~ArtTree();
+
+    /**
+     * Gives the number of keys in this tree
+     * @return the number of keys
+     */
+    size_t size() const;
+
+    /**
+     * Gives the leaf holding a key
+     * @param key the search key
+     * @return the leaf, or null when the key is not in the tree
+     */
+    Leaf* find(const string& key) const;
+
+    /**
+     * Gives the first leaf whose key is at least the specified key
+     * @param key the search key
+     * @return the leaf, or null when every key is smaller
+     */
+    Leaf* lowerBound(const string& key) const;
+
+    /**
+     * Gives the leaf with the smallest key
+     * @return the leaf, or null for the empty tree
+     */
+    Leaf* first() const;
+
+    /**
+     * Gives the leaf with the largest key
+     * @return the leaf, or null for the empty tree
+     */
+    Leaf* last() const;
+
+    /**
+     * Inserts a key if it is not in the tree
+     * @param key the key
+     * @param value the value of the key if it is inserted
+     * @param inserted receives true if the key was inserted, false if it was
+     * already in the tree
+     * @return the leaf holding the key
+     */
+    Leaf* insert(const string& key, const V& value, bool& inserted);
+
+    /**
+     * Removes a key
+     * @param key the key
+     * @return true if the key was in the tree; otherwise, false
+     */
+    bool erase(const string& key);
+
+    /**
+     * Exchanges the keys of this tree with those of another tree
+     * @param other the other tree
+     */
+    void swap(ArtTree<V>& other);
+};
+
+/**
+ * nested Node class definition: the layout tag every node starts with
+ */
+template <typename V>
+class ArtTree<V>::Node
+{
+public:
+    /**
+     * the layout of this node; see NodeType
+     */
+    uint8_t type;
+};
+
+/**
+ * nested Leaf class definition: a key, its value, and its neighbours in
+ * key order
+ */
+template <typename V>
+class ArtTree<V>::Leaf : public ArtTree<V>::Node
+{
+private:
+    /**
+     * the key
+     */
+    string word;
+    /**
+     * the leaves with the next smaller and next larger keys
+     */
+    Leaf* before;
+    Leaf* after;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * ArtTree<V> class
+     */
+    friend class ArtTree<V>;
+public:
+    /**
+     * the value of the key
+     */
+    V value;
+
+    /**
+     * Constructs a leaf
+     * @param key the key
+     * @param value the value
+     */
+    Leaf(const string& key, const V& value);
+
+    /**
+     * Gives the key of this leaf
+     * @return the key
+     */
+    const string& key() const;
+
+    /**
+     * Gives the leaf with the next smaller key
+     * @return the leaf, or null if this is the smallest
+     */
+    Leaf* prev() const;
+
+    /**
+     * Gives the leaf with the next larger key
+     * @return the leaf, or null if this is the largest
+     */
+    Leaf* next() const;
+};
+#endif //ARTTREE_H
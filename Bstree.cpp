@@ -13,16 +13,128 @@
 using namespace std;
 
 #include "Bstree.h"
+#include "BstreeIndex.cpp"
 #include <algorithm>
+#include <cmath>
 #include <vector>
+#include <functional>
 
 /* Nested Node class definitions */
 template <typename T>
-Bstree<T>::Node::Node(T item)
+Bstree<T>::Node::Node(T item) : data(move(item))
 {
-    data = item;
     left = nullptr;
     right = nullptr;
+    dead = false;
+    stale = true;
+    leftSize = 0;
+    shape = 0;
+    content = 0;
+}
+
+/* Nested Finger class definitions */
+template <typename T>
+Bstree<T>::Finger::Finger()
+{
+    tree = nullptr;
+    reshapes = 0;
+}
+
+/* Nested Relatives class definitions */
+template <typename T>
+Bstree<T>::Relatives::Relatives(vector<const Node*> start, bool expand, long count) : start(move(start))
+{
+    this->expand = expand;
+    this->count = count;
+}
+
+template <typename T>
+typename Bstree<T>::Relatives::iterator Bstree<T>::Relatives::begin() const
+{
+    return iterator(start, expand);
+}
+
+template <typename T>
+typename Bstree<T>::Relatives::iterator Bstree<T>::Relatives::end() const
+{
+    return iterator(vector<const Node*>(), expand);
+}
+
+template <typename T>
+long Bstree<T>::Relatives::size() const
+{
+    return count;
+}
+
+template <typename T>
+bool Bstree<T>::Relatives::empty() const
+{
+    return count == 0;
+}
+
+template <typename T>
+Bstree<T>::Relatives::iterator::iterator(vector<const Node*> pending, bool expand) : pending(move(pending))
+{
+    this->expand = expand;
+    skip();
+}
+
+template <typename T>
+void Bstree<T>::Relatives::iterator::skip()
+{
+    while (!pending.empty() && pending.back()->dead)
+    {
+        const Node* cur = pending.back();
+        pending.pop_back();
+        if (expand)
+        {
+            if (cur->right)
+                pending.push_back(cur->right);
+            if (cur->left)
+                pending.push_back(cur->left);
+        }
+    }
+}
+
+template <typename T>
+const T& Bstree<T>::Relatives::iterator::operator*() const
+{
+    return pending.back()->data;
+}
+
+template <typename T>
+const T* Bstree<T>::Relatives::iterator::operator->() const
+{
+    return &pending.back()->data;
+}
+
+template <typename T>
+typename Bstree<T>::Relatives::iterator& Bstree<T>::Relatives::iterator::operator++()
+{
+    const Node* cur = pending.back();
+    pending.pop_back();
+    if (expand)
+    {
+        if (cur->right)
+            pending.push_back(cur->right);
+        if (cur->left)
+            pending.push_back(cur->left);
+    }
+    skip();
+    return *this;
+}
+
+template <typename T>
+bool Bstree<T>::Relatives::iterator::operator==(const iterator& other) const
+{
+    /* within one range, the stack is determined by the current node */
+    return pending.size() == other.pending.size() && (pending.empty() || pending.back() == other.pending.back());
+}
+
+template <typename T>
+bool Bstree<T>::Relatives::iterator::operator!=(const iterator& other) const
+{
+    return !(*this == other);
 }
 
 /* Outer Bstree class definitions */
@@ -31,6 +143,20 @@ Bstree<T>::Bstree()
 {
     root = nullptr;
     order = 0;
+    nodes = 0;
+    alpha = 0;
+    reshapes = 0;
+    reclaimer = nullptr;
+    index = nullptr;
+    payload = 0;
+    payloadOverhead = 0;
+    peak = 0;
+    mutations = 0;
+    for (int walk = 0; walk < WALKS; walk++)
+        sequenced[walk] = ~0UL;
+    inorderMoved = 0;
+    hashed = false;
+    batchRun = ~static_cast<size_t>(0);
 }
 
 template <typename T>
@@ -38,22 +164,69 @@ Bstree<T>::Bstree(const Bstree<T>& other)
 {
     root = nullptr;
     order = other.order;
+    nodes = other.nodes;
+    alpha = other.alpha;
+    reshapes = 0;
+    reclaimer = other.reclaimer;
+    index = nullptr;
+    payload = 0;
+    payloadOverhead = 0;
+    peak = 0;
+    mutations = 0;
+    for (int walk = 0; walk < WALKS; walk++)
+        sequenced[walk] = ~0UL;
+    inorderMoved = 0;
+    /* the nodes are copied with their hashes */
+    hashed = other.hashed;
+    batchRun = ~static_cast<size_t>(0);
     recCopy(root, other.root);
+    if (other.index)
+    {
+        index = other.index->emptyCopy();
+        reindex();
+    }
 }
 
 template <typename T>
-Bstree<T>::Bstree(Bstree<T>&& other)
+Bstree<T>::Bstree(Bstree<T>&& other) noexcept
 {
     root = other.root;
     other.root = nullptr;
     order = other.order;
     other.order = 0;
+    nodes = other.nodes;
+    other.nodes = 0;
+    alpha = other.alpha;
+    reshapes = 0;
+    other.reshapes++;
+    reclaimer = other.reclaimer;
+    index = other.index;
+    other.index = nullptr;
+    payload = other.payload;
+    payloadOverhead = other.payloadOverhead;
+    peak = other.peak;
+    other.payload = 0;
+    other.payloadOverhead = 0;
+    other.peak = 0;
+    /* the flattened sequences hold the nodes, so they move with them */
+    mutations = other.mutations;
+    for (int walk = 0; walk < WALKS; walk++)
+    {
+        sequences[walk] = move(other.sequences[walk]);
+        sequenced[walk] = other.sequenced[walk];
+        other.sequences[walk].clear();
+    }
+    inorderMoved = other.inorderMoved;
+    hashed = other.hashed;
+    batchRun = other.batchRun;
+    other.mutate(true);
 }
 
 template <typename T>
 Bstree<T>::~Bstree()
 {
-    recDestroy(root);
+    release(root, nodes);
+    delete index;
 }
 
 template <typename T>
@@ -61,71 +234,359 @@ Bstree<T>& Bstree<T>::operator=(const Bstree<T>& other)
 {
     if (this != &other)
     {
-        (*this).~Bstree();
-        Bstree<T> clone(other);
-        root = clone.root;
-        order = clone.order;
-        clone.order = 0;
-        clone.root = nullptr;
+        assign(other);
+        alpha = other.alpha;
     }
     return *this;
 }
 
+template <typename T>
+void Bstree<T>::assign(const Bstree<T>& other)
+{
+    if (this == &other)
+        return;
+    /* pair up the positions of the two shapes; data moves into place, the
+       subtrees only this tree has become spare nodes, and the subtrees only
+       the other tree has are copied afterwards, onto the spare nodes first */
+    struct Position
+    {
+        Node** dest;
+        Node* src;
+    };
+    vector<Position> pending, missing;
+    vector<Node*> spare;
+    reshapes++;
+    mutate(true);
+    try
+    {
+        pending.push_back({ &root, other.root });
+        while (!pending.empty())
+        {
+            Position position = pending.back();
+            pending.pop_back();
+            Node* node = *position.dest;
+            if (!position.src)
+            {
+                if (node)
+                {
+                    *position.dest = nullptr;
+                    size_t first = spare.size();
+                    spare.push_back(node);
+                    for (size_t k = first; k < spare.size(); k++)
+                    {
+                        if (spare[k]->left)
+                            spare.push_back(spare[k]->left);
+                        if (spare[k]->right)
+                            spare.push_back(spare[k]->right);
+                    }
+                }
+                continue;
+            }
+            if (!node)
+            {
+                missing.push_back(position);
+                continue;
+            }
+            overwrite(node, position.src->data);
+            node->dead = position.src->dead;
+            node->leftSize = position.src->leftSize;
+            node->stale = position.src->stale;
+            node->shape = position.src->shape;
+            node->content = position.src->content;
+            pending.push_back({ &node->right, position.src->right });
+            pending.push_back({ &node->left, position.src->left });
+        }
+        for (const Position& position : missing)
+            recCopy(*position.dest, position.src, &spare);
+    }
+    catch (...)
+    {
+        for (Node* node : spare)
+            destroyNode(node);
+        clear();
+        throw;
+    }
+    for (Node* node : spare)
+        destroyNode(node);
+    order = other.order;
+    nodes = other.nodes;
+    hashed = other.hashed;
+    /* the nodes now hold other keys */
+    if (index)
+        reindex();
+}
+
+template <typename T>
+Bstree<T>& Bstree<T>::operator=(Bstree<T>&& other) noexcept
+{
+    if (this != &other)
+    {
+        /* the old contents leave with the temporary */
+        Bstree<T> taken(move(other));
+        swap(taken);
+    }
+    return *this;
+}
+
+template <typename T>
+void Bstree<T>::swap(Bstree<T>& other) noexcept
+{
+    std::swap(root, other.root);
+    std::swap(order, other.order);
+    std::swap(nodes, other.nodes);
+    std::swap(alpha, other.alpha);
+    std::swap(reclaimer, other.reclaimer);
+    std::swap(index, other.index);
+    std::swap(payload, other.payload);
+    std::swap(payloadOverhead, other.payloadOverhead);
+    std::swap(peak, other.peak);
+    std::swap(hashed, other.hashed);
+    /* the counts are not exchanged, so no finger and no flattened sequence
+       matches the new contents */
+    reshapes++;
+    other.reshapes++;
+    mutate(true);
+    other.mutate(true);
+}
+
+template <typename T>
+void Bstree<T>::clear()
+{
+    if (index)
+        index->clear();
+    release(root, nodes);
+    root = nullptr;
+    order = 0;
+    nodes = 0;
+    reshapes++;
+    mutate(true);
+    for (int walk = 0; walk < WALKS; walk++)
+        vector<const Node*>().swap(sequences[walk]);
+}
+
+template <typename T>
+void Bstree<T>::setReclaimer(BstreeReclaimer* background)
+{
+    reclaimer = background;
+}
+
+template <typename T>
+void Bstree<T>::setIndexed(bool on)
+{
+    if (on && !index)
+    {
+        index = new BstreeIndex<T, Node*>([](const T& key) { return hash<T>()(key); },
+            [](const T& lft, const T& rgt) { return lft == rgt; });
+        reindex();
+    }
+    else if (!on)
+    {
+        notePeak();
+        delete index;
+        index = nullptr;
+    }
+}
+
+template <typename T>
+bool Bstree<T>::indexed() const
+{
+    return index != nullptr;
+}
+
+template <typename T>
+unsigned long Bstree<T>::version() const
+{
+    return mutations;
+}
+
+template <typename T>
+void swap(Bstree<T>& lft, Bstree<T>& rgt) noexcept
+{
+    lft.swap(rgt);
+}
+
 template <typename T>
 bool Bstree<T>::empty() const
 {
-    return root == nullptr;
+    return order == 0;
 }
 
 template<typename T>
 void Bstree<T>::insert(T item)
 {
-    Node* tmp;
-    Node* newnode = new Node(item);
-
-    /* If it is the first node in the tree */
-    if (!root)
+    if (index)
     {
-        root = newnode;
-        order++;
-        return;
+        /* a present key is overwritten without a descent */
+        Node* tmp = index->find(item);
+        if (tmp)
+        {
+            overwrite(tmp, item);
+            if (tmp->dead)
+            {
+                /* a revived item changes the content hashes up to the root */
+                tmp->dead = false;
+                order++;
+                if (hashed)
+                    touch(item);
+            }
+            mutate(false);
+            BSTREE_STAT(stats.descent(INSERT_DESCENT, 1));
+            return;
+        }
     }
-    /*find where it should go */
-    tmp = root;
-    while (true)
+    /* follow the links down to the empty one the item belongs in; the
+       scapegoat policy needs the links on the way to find the scapegoat */
+    vector<Node**> path;
+    Node** link = &root;
+    BSTREE_STAT(long visited = 0);
+    while (*link)
     {
-        if (tmp->data == item)
+        Node* tmp = *link;
+        BSTREE_STAT(visited++);
+        tmp->stale = true;
+        if (BSTREE_COMPARED(stats, tmp->data == item))
         { /* Key already exists. */
-            tmp->data = item;
-            delete newnode; /* dont need it */
+            overwrite(tmp, item);
+            if (tmp->dead)
+            {
+                tmp->dead = false;
+                order++;
+            }
+            mutate(false);
+            /* no node was added after all */
+            shift(item, -1);
+            BSTREE_STAT(stats.descent(INSERT_DESCENT, visited));
             return;
         }
-        else if (tmp->data > item)
+        if (alpha > 0)
+            path.push_back(link);
+        if (BSTREE_COMPARED(stats, tmp->data > item))
         {
-            if (!(tmp->left))
-            {/* If the key is less than tmp */
-                tmp->left = newnode;
+            tmp->leftSize++;
+            link = &tmp->left;
+        }
+        else
+            link = &tmp->right;
+    }
+    *link = createNode(item);
+    order++;
+    nodes++;
+    linked(*link);
+    if (index)
+        index->insert((*link)->data, *link);
+    BSTREE_STAT(stats.descent(INSERT_DESCENT, visited));
+    if (alpha > 0)
+        rebalance(path, path.size(), link);
+}
+
+template<typename T>
+void Bstree<T>::insert(Finger& finger, T item)
+{
+    if (finger.tree != this || finger.reshapes != reshapes)
+    {
+        finger.tree = this;
+        finger.reshapes = reshapes;
+        finger.links.assign(1, &root);
+        finger.lower.assign(1, -1);
+        finger.upper.assign(1, -1);
+    }
+    /* climb to the lowest node on the path whose subtree spans the item;
+       the nearest bounds of a subtree are the only ones that can fail */
+    size_t level = finger.links.size() - 1;
+    while (level > 0)
+    {
+        long lower = finger.lower[level], upper = finger.upper[level];
+        if (upper >= 0 && !BSTREE_COMPARED(stats, (*finger.links[upper])->data > item))
+            level = upper;
+        else if (lower >= 0 && !BSTREE_COMPARED(stats, item > (*finger.links[lower])->data))
+            level = lower;
+        else
+            break;
+    }
+    finger.links.resize(level + 1);
+    finger.lower.resize(level + 1);
+    finger.upper.resize(level + 1);
+    /* the ancestors above are marked stale up to the first one that is
+       already, above which all are */
+    for (size_t k = level; k-- > 0 && !(*finger.links[k])->stale;)
+        (*finger.links[k])->stale = true;
+
+    /* descend from there as insert does, extending the path */
+    Node** link = finger.links[level];
+    BSTREE_STAT(long visited = 0);
+    while (*link)
+    {
+        Node* tmp = *link;
+        BSTREE_STAT(visited++);
+        tmp->stale = true;
+        if (BSTREE_COMPARED(stats, tmp->data == item))
+        { /* Key already exists. */
+            overwrite(tmp, item);
+            if (tmp->dead)
+            {
+                tmp->dead = false;
                 order++;
-                return;
-            }
-            else
-            {/* continue searching for insertion pt. */
-                tmp = tmp->left;
             }
+            mutate(false);
+            BSTREE_STAT(stats.descent(INSERT_DESCENT, visited));
+            return;
+        }
+        long depth = finger.links.size() - 1;
+        if (BSTREE_COMPARED(stats, tmp->data > item))
+        {
+            link = &tmp->left;
+            finger.lower.push_back(finger.lower[depth]);
+            finger.upper.push_back(depth);
         }
         else
         {
-            if (!(tmp->right))
-            {/* If the key is greater than tmp */
-                tmp->right = newnode;
-                order++;
-                return;
-            }
-            else
-            {/* continue searching for insertion point*/
-                tmp = tmp->right;
-            }
+            link = &tmp->right;
+            finger.lower.push_back(depth);
+            finger.upper.push_back(finger.upper[depth]);
+        }
+        finger.links.push_back(link);
+    }
+    *link = createNode(item);
+    order++;
+    nodes++;
+    linked(*link);
+    if (index)
+        index->insert((*link)->data, *link);
+    /* the ancestors that hold the new node in their left subtree are the
+       chain of nearest upper bounds */
+    for (long k = finger.upper.back(); k >= 0; k = finger.upper[k])
+        (*finger.links[k])->leftSize++;
+    BSTREE_STAT(stats.descent(INSERT_DESCENT, visited));
+    if (alpha > 0)
+        rebalance(finger.links, finger.links.size() - 1, link);
+}
+
+template<typename T>
+void Bstree<T>::rebalance(const vector<Node**>& path, size_t depth, Node** link)
+{
+    if (depth <= log(nodes) / log(1 / alpha))
+        return;
+    /* too deep: rebuild the lowest ancestor whose child on the path holds
+       more than alpha of its nodes */
+    long below = 1;
+    for (size_t k = depth; k-- > 0;)
+    {
+        Node* ancestor = *path[k];
+        Node* other = (link == &ancestor->left) ? ancestor->right : ancestor->left;
+        long size = below + 1 + count(other);
+        if (below > alpha * size)
+        {
+            /* the rebuild frees the tombstones of the subtree, which the
+               ancestors that hold it on their left no longer count */
+            long before = nodes;
+            rebuild(path[k]);
+            for (size_t j = 0; j < k && nodes < before; j++)
+                if (path[j + 1] == &(*path[j])->left)
+                    (*path[j])->leftSize -= before - nodes;
+            break;
         }
+        below = size;
+        link = path[k];
     }
 }
 
@@ -133,18 +594,28 @@ template<typename T>
 bool Bstree<T>::inTree(T item) const
 {
     Node* tmp;
+    if (index)
+        return search(item) != nullptr;
     if (!root)
         return false;
     /*find where it is */
     tmp = root;
+    BSTREE_STAT(long visited = 0);
     while (true)
     {
-        if (tmp->data == item)
-            return true;
-        else if (tmp->data > item)
+        BSTREE_STAT(visited++);
+        if (BSTREE_COMPARED(stats, tmp->data == item))
+        {
+            BSTREE_STAT(stats.descent(SEARCH_DESCENT, visited));
+            return !tmp->dead;
+        }
+        else if (BSTREE_COMPARED(stats, tmp->data > item))
         {
             if (!(tmp->left))
+            {
+                BSTREE_STAT(stats.descent(SEARCH_DESCENT, visited));
                 return false;
+            }
             else
             {/* continue searching */
                 tmp = tmp->left;
@@ -153,7 +624,10 @@ bool Bstree<T>::inTree(T item) const
         else
         {
             if (!(tmp->right))
+            {
+                BSTREE_STAT(stats.descent(SEARCH_DESCENT, visited));
                 return false;
+            }
             else
                 /* continue searching for insertion pt. */
                 tmp = tmp->right;
@@ -164,18 +638,439 @@ bool Bstree<T>::inTree(T item) const
 template<typename T>
 bool Bstree<T>::remove(const T& item)
 {
-    /* find item in tree */
-    Node* nodeptr = search(item);
-    /* if it exists in tree remove, update order, return true. otherwise return false */
-    if (nodeptr)
+    if (index)
     {
-        remove(nodeptr);
-        order--;
-        return true;
+        /* a missing key, or a lazy delete, takes no descent */
+        Node* tmp = index->find(item);
+        if (!tmp || tmp->dead)
+        {
+            BSTREE_STAT(stats.descent(REMOVE_DESCENT, tmp ? 1 : 0));
+            return false;
+        }
+        if (alpha > 0)
+        {
+            BSTREE_STAT(stats.descent(REMOVE_DESCENT, 1));
+            order--;
+            tmp->dead = true;
+            if (hashed)
+                touch(item);
+            mutate(false);
+            if (order < alpha * nodes)
+                compact();
+            return true;
+        }
     }
+    /* one descent, remembering the link that holds the current node */
+    Node** link = &root;
+    BSTREE_STAT(long visited = 0);
+    while (*link)
+    {
+        Node* tmp = *link;
+        BSTREE_STAT(visited++);
+        tmp->stale = true;
+        if (BSTREE_COMPARED(stats, tmp->data == item))
+        {
+            BSTREE_STAT(stats.descent(REMOVE_DESCENT, visited));
+            if (tmp->dead)
+            {
+                if (alpha == 0)
+                    shift(item, 1);
+                return false;
+            }
+            order--;
+            if (alpha == 0)
+                remove(link);
+            else
+            {
+                /* lazily: leave a tombstone, and rebuild once the live
+                   nodes are too few */
+                tmp->dead = true;
+                mutate(false);
+                if (order < alpha * nodes)
+                    compact();
+            }
+            return true;
+        }
+        else if (BSTREE_COMPARED(stats, tmp->data > item))
+        {
+            /* a tombstone keeps its place; only a plain tree loses a node */
+            if (alpha == 0)
+                tmp->leftSize--;
+            link = &tmp->left;
+        }
+        else
+            link = &tmp->right;
+    }
+    /* no node was removed after all */
+    if (alpha == 0)
+        shift(item, 1);
+    BSTREE_STAT(stats.descent(REMOVE_DESCENT, visited));
     return false;
 }
 
+template<typename T>
+template<typename Pred>
+long Bstree<T>::erase_if(Pred pred)
+{
+    return erase(pred, nullptr, nullptr);
+}
+
+template<typename T>
+long Bstree<T>::erase(const T& lo, const T& hi)
+{
+    return erase([](const T&) { return true; }, &lo, &hi);
+}
+
+template<typename T>
+template<typename Pred>
+long Bstree<T>::erase(Pred pred, const T* lo, const T* hi)
+{
+    /* Postorder over links: a node is examined after both of its subtrees,
+       so a two-child node that is removed takes over a successor that has
+       already been kept, and the links above the current node never change.
+       A frame collects the nodes removed below it, and hands them to its
+       parent's frame when it is done. */
+    struct Frame
+    {
+        Node** link;
+        bool expanded;
+        long parent;
+        bool onLeft;
+        long removed;
+        long removedLeft;
+    };
+    vector<Frame> pending;
+    long removed = 0;
+    /* patching the flattened inorder once per removed node could cost more
+       than flattening it again */
+    sequenced[INORDER] = ~0UL;
+    if (root)
+        pending.push_back({ &root, false, -1, false, 0, 0 });
+    while (!pending.empty())
+    {
+        Frame& top = pending.back();
+        Node* node = *top.link;
+        if (!top.expanded)
+        {
+            top.expanded = true;
+            node->stale = true;
+            long parent = pending.size() - 1;
+            /* the right subtree only holds data above node, the left subtree
+               only data below it */
+            if (node->right && (!hi || BSTREE_COMPARED(stats, *hi > node->data)))
+                pending.push_back({ &node->right, false, parent, false, 0, 0 });
+            if (node->left && (!lo || BSTREE_COMPARED(stats, node->data > *lo)))
+                pending.push_back({ &node->left, false, parent, true, 0, 0 });
+            continue;
+        }
+        Frame done = top;
+        pending.pop_back();
+        node->leftSize -= done.removedLeft;
+        if (!node->dead && (!lo || !BSTREE_COMPARED(stats, *lo > node->data))
+            && (!hi || BSTREE_COMPARED(stats, *hi > node->data)) && pred(node->data))
+        {
+            remove(done.link);
+            order--;
+            removed++;
+            done.removed++;
+        }
+        if (done.parent >= 0)
+        {
+            pending[done.parent].removed += done.removed;
+            if (done.onLeft)
+                pending[done.parent].removedLeft += done.removed;
+        }
+    }
+    return removed;
+}
+
+template<typename T>
+void Bstree<T>::apply_batch(const vector<Op>& batch, vector<bool>* outcomes)
+{
+    if (outcomes)
+        outcomes->assign(batch.size(), true);
+    /* a run is merged up to the op that needs the tree as the ops before
+       it left it; that op is applied alone, and the next run is at most
+       twice as long as the prefix merged, so a batch that breaks often
+       is not sorted and descended again and again. Once the runs are too
+       short to merge, they only grow back slowly. */
+    Finger finger;
+    size_t first = 0, window = alpha > 0 ? min(batchRun, batch.size()) : batch.size();
+    while (first < batch.size())
+    {
+        size_t last = min(batch.size(), first + window);
+        /* an eager remove reshapes the tree where it stands */
+        if (alpha == 0)
+            last = find_if(batch.begin() + first, batch.begin() + last, [](const Op& next) { return next.remove; })
+                - batch.begin();
+        if (last - first < SHORTEST_MERGE)
+        {
+            /* a short run, or a remove on a plain tree, costs less to
+               descend for op by op than to sort */
+            for (last = max(last, first + 1); first < last; first++)
+                if (batch[first].remove)
+                {
+                    bool removed = remove(batch[first].item);
+                    if (outcomes)
+                        (*outcomes)[first] = removed;
+                }
+                else
+                    insert(finger, batch[first].item);
+            window = min(window + window / RUN_GROWTH + 1, batch.size());
+            continue;
+        }
+        size_t merged = merge(batch, first, last, outcomes);
+        if (merged == last)
+        {
+            window = min(2 * window, batch.size());
+            first = last;
+            continue;
+        }
+        const Op& alone = batch[merged];
+        if (alone.remove)
+        {
+            bool removed = remove(alone.item);
+            if (outcomes)
+                (*outcomes)[merged] = removed;
+        }
+        else
+            insert(finger, alone.item);
+        window = 2 * (merged - first + 1);
+        first = merged + 1;
+    }
+    if (alpha > 0 && batch.size() >= SHORTEST_MERGE)
+        batchRun = window;
+}
+
+template<typename T>
+size_t Bstree<T>::merge(const vector<Op>& batch, size_t first, size_t last, vector<bool>* outcomes)
+{
+    const size_t NONE = ~static_cast<size_t>(0);
+    enum State { ABSENT, LIVE, DEAD };
+    /* group the ops by item; a stable sort keeps each group in order */
+    size_t count = last - first;
+    vector<size_t> sorted(count);
+    for (size_t k = 0; k < count; k++)
+        sorted[k] = first + k;
+    stable_sort(sorted.begin(), sorted.end(), [&](size_t lft, size_t rgt) { return batch[rgt].item > batch[lft].item; });
+    vector<const T*> keys;
+    vector<size_t> groupOf(count);
+    for (size_t k = 0; k < count; k++)
+    {
+        if (keys.empty() || !(batch[sorted[k]].item == *keys.back()))
+            keys.push_back(&batch[sorted[k]].item);
+        groupOf[sorted[k] - first] = keys.size() - 1;
+    }
+    size_t groups = keys.size();
+
+    /* one descent places every group; the subtrees below the top levels
+       are independent, so a large batch descends them on several threads */
+    vector<Place> places(groups);
+    vector<Visit> visited;
+    vector<Frame> pending;
+    pending.push_back({ &root, 0, groups, 0 });
+    size_t threads = groups >= PARALLEL_GROUPS ? min(thread::hardware_concurrency(), 8u) : 1;
+    if (threads > 1)
+    {
+        vector<Frame> level;
+        while (!pending.empty() && pending.size() < 4 * threads)
+        {
+            level.swap(pending);
+            pending.clear();
+            for (const Frame& frame : level)
+                locate(frame, keys, pending, places, visited);
+        }
+        vector<vector<Visit>> seen(threads);
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; t++)
+            workers.emplace_back([&, t]()
+            {
+                vector<Frame> stack;
+                for (size_t k = t; k < pending.size(); k += threads)
+                {
+                    stack.push_back(pending[k]);
+                    while (!stack.empty())
+                    {
+                        Frame frame = stack.back();
+                        stack.pop_back();
+                        locate(frame, keys, stack, places, seen[t]);
+                    }
+                }
+            });
+        for (thread& worker : workers)
+            worker.join();
+        for (const vector<Visit>& part : seen)
+            visited.insert(visited.end(), part.begin(), part.end());
+    }
+    else
+        while (!pending.empty())
+        {
+            Frame frame = pending.back();
+            pending.pop_back();
+            locate(frame, keys, pending, places, visited);
+        }
+    BSTREE_STAT(stats.descent(INSERT_DESCENT, visited.size()));
+
+    /* a missing item is created by the first insert of it; the new items of
+       one empty link form the treap whose priorities are those positions */
+    vector<State> state(groups);
+    vector<size_t> created(groups, NONE), lastInsert(groups, NONE);
+    for (size_t g = 0; g < groups; g++)
+        state[g] = !places[g].node ? ABSENT : places[g].node->dead ? DEAD : LIVE;
+    for (size_t k = 0; k < count; k++)
+    {
+        size_t g = groupOf[k];
+        if (!batch[first + k].remove && state[g] == ABSENT && created[g] == NONE)
+            created[g] = first + k;
+    }
+    vector<size_t> lower(groups, NONE), upper(groups, NONE), tops, stack;
+    vector<long> depth(groups);
+    for (size_t g = 0; g < groups;)
+    {
+        size_t end = g + 1;
+        if (places[g].node)
+        {
+            g = end;
+            continue;
+        }
+        while (end < groups && !places[end].node && places[end].link == places[g].link)
+            end++;
+        stack.clear();
+        for (size_t k = g; k < end; k++)
+        {
+            if (created[k] == NONE)
+                continue;
+            size_t below = NONE;
+            while (!stack.empty() && created[stack.back()] > created[k])
+            {
+                below = stack.back();
+                stack.pop_back();
+            }
+            lower[k] = below;
+            if (!stack.empty())
+                upper[stack.back()] = k;
+            stack.push_back(k);
+        }
+        if (!stack.empty())
+        {
+            tops.push_back(stack.front());
+            depth[stack.front()] = places[g].depth;
+            stack.resize(1);
+            while (!stack.empty())
+            {
+                size_t k = stack.back();
+                stack.pop_back();
+                for (size_t child : { lower[k], upper[k] })
+                    if (child != NONE)
+                    {
+                        depth[child] = depth[k] + 1;
+                        stack.push_back(child);
+                    }
+            }
+        }
+        g = end;
+    }
+
+    /* replay the ops in order on the states of their items, stopping at
+       the first after which the scapegoat policy would rebuild */
+    long live = order, total = nodes;
+    size_t stop = first;
+    for (; stop < last; stop++)
+    {
+        size_t g = groupOf[stop - first];
+        if (!batch[stop].remove)
+        {
+            if (state[g] == ABSENT && alpha > 0 && !(depth[g] <= log(total + 1) / log(1 / alpha)))
+                break;
+            if (state[g] == ABSENT)
+                total++;
+            if (state[g] != LIVE)
+                live++;
+            state[g] = LIVE;
+            lastInsert[g] = stop;
+        }
+        else if (state[g] == LIVE)
+        {
+            if (live - 1 < alpha * total)
+                break;
+            live--;
+            state[g] = DEAD;
+        }
+        else if (outcomes)
+            (*outcomes)[stop] = false;
+    }
+    if (stop == first)
+        return stop;
+
+    /* apply the outcome of each group, then link the new nodes and count
+       them in the left subtree counts of the nodes above */
+    vector<Node*> made(groups, nullptr);
+    vector<long> madeBefore(groups + 1, 0);
+    for (size_t g = 0; g < groups; g++)
+    {
+        Node* node = places[g].node;
+        if (!node && created[g] < stop)
+        {
+            node = made[g] = createNode(batch[lastInsert[g]].item);
+            nodes++;
+            if (index)
+                index->insert(node->data, node);
+        }
+        else if (node && lastInsert[g] != NONE)
+            overwrite(node, batch[lastInsert[g]].item);
+        if (node)
+            node->dead = state[g] == DEAD;
+        madeBefore[g + 1] = madeBefore[g] + (made[g] ? 1 : 0);
+    }
+    for (size_t g = 0; g < groups; g++)
+        if (made[g])
+        {
+            if (lower[g] != NONE)
+                made[g]->left = made[lower[g]];
+            if (upper[g] != NONE)
+                made[g]->right = made[upper[g]];
+        }
+    for (size_t top : tops)
+        if (made[top])
+        {
+            *places[top].link = made[top];
+            recount(made[top]);
+        }
+    for (const Visit& visit : visited)
+    {
+        visit.node->leftSize += madeBefore[visit.mid] - madeBefore[visit.lo];
+        visit.node->stale = true;
+    }
+    order = live;
+    mutate(madeBefore[groups] > 0);
+    return stop;
+}
+
+template<typename T>
+void Bstree<T>::locate(const Frame& frame, const vector<const T*>& keys, vector<Frame>& pending,
+    vector<Place>& places, vector<Visit>& visited) const
+{
+    Node* node = *frame.link;
+    if (!node)
+    {
+        for (size_t g = frame.lo; g < frame.hi; g++)
+            places[g] = { nullptr, frame.link, frame.depth };
+        return;
+    }
+    /* the groups below the node go left, one equal to it stops here and
+       the rest go right */
+    size_t mid = lower_bound(keys.begin() + frame.lo, keys.begin() + frame.hi, node->data,
+        [](const T* key, const T& data) { return data > *key; }) - keys.begin();
+    size_t right = mid;
+    if (mid < frame.hi && *keys[mid] == node->data)
+        places[right++] = { node, frame.link, frame.depth };
+    visited.push_back({ node, frame.lo, mid });
+    if (right < frame.hi)
+        pending.push_back({ &node->right, right, frame.hi, frame.depth + 1 });
+    if (mid > frame.lo)
+        pending.push_back({ &node->left, frame.lo, mid, frame.depth + 1 });
+}
+
 template<typename T>
 const T& Bstree<T>::retrieve(const T& key) const
 {
@@ -191,7 +1086,9 @@ const T& Bstree<T>::retrieve(const T& key) const
 template<typename T>
 void Bstree<T>::inorderTraverse(FuncType apply) const
 {
-    inorderTraverse(root, apply);
+    for (const Node* node : sequence(INORDER))
+        if (!node->dead)
+            apply(node->data);
 }
 
 template<typename T>
@@ -202,43 +1099,281 @@ long Bstree<T>::size() const
 
 
 template <typename T>
-void Bstree<T>::recCopy(Node*& dest, Node* src)
+typename Bstree<T>::Node* Bstree<T>::createNode(T item)
+{
+    BSTREE_STAT(stats.allocations++);
+    Node* node = new Node(move(item));
+    account(node->data, true);
+    return node;
+}
+
+template <typename T>
+typename Bstree<T>::Node* Bstree<T>::unlink(Node** link)
+{
+    Node* node = *link;
+    /* the inorder is not patched: that needs the ordering of the items,
+       which BstreeMap, the user of unlink, keeps to itself */
+    mutate(true);
+    /* nor are the hashes marked, having no path to the root */
+    hashed = false;
+    if (index)
+        index->erase(node->data);
+    if (node->left && node->right)
+    {
+        Node** succ = &node->right;
+        while ((*succ)->left)
+        {
+            (*succ)->leftSize--;
+            succ = &(*succ)->left;
+        }
+        Node* replacement = *succ;
+        *succ = replacement->right;
+        replacement->left = node->left;
+        replacement->right = node->right;
+        replacement->leftSize = node->leftSize;
+        *link = replacement;
+    }
+    else
+        *link = node->left ? node->left : node->right;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->leftSize = 0;
+    reshapes++;
+    return node;
+}
+
+template <typename T>
+void Bstree<T>::destroyNode(Node* node)
+{
+    account(node->data, false);
+    delete node;
+    BSTREE_STAT(stats.deallocations++);
+}
+
+template <typename T>
+void Bstree<T>::account(const T& item, bool held)
 {
-    if (src)
+    /* the node itself is let go of too, even when its item holds nothing
+       outside it */
+    if (!held)
+        notePeak();
+    size_t bytes = BstreePayload<T>::bytes(item);
+    if (bytes == 0)
+        return;
+    if (held)
     {
-        dest = new Node(src->data);
-        recCopy(dest->left, src->left);
-        recCopy(dest->right, src->right);
+        payload += bytes;
+        payloadOverhead += BstreeMemory::overhead(bytes);
+    }
+    else
+    {
+        payload -= bytes;
+        payloadOverhead -= BstreeMemory::overhead(bytes);
+    }
+}
+
+template <typename T>
+void Bstree<T>::overwrite(Node* node, const T& item)
+{
+    account(node->data, false);
+    node->data = item;
+    account(node->data, true);
+}
+
+template <typename T>
+void Bstree<T>::notePeak()
+{
+    peak = memory_usage().peakBytes;
+}
+
+template <typename T>
+void Bstree<T>::mutate(bool reshaped, bool inorderKept)
+{
+    for (int walk = 0; walk < WALKS; walk++)
+        if (sequenced[walk] == mutations && (!reshaped || (walk == INORDER && inorderKept)))
+            sequenced[walk] = mutations + 1;
+    mutations++;
+}
+
+template <typename T>
+void Bstree<T>::linked(Node* node)
+{
+    bool patch = sequenced[INORDER] == mutations;
+    if (patch)
+    {
+        vector<const Node*>& inorder = sequences[INORDER];
+        size_t rank = inorderRank(node->data);
+        patch = patchInorder(inorder.size() - rank);
+        if (patch)
+            inorder.insert(inorder.begin() + rank, node);
+    }
+    mutate(true, patch);
+}
+
+template <typename T>
+void Bstree<T>::unlinking(Node* node)
+{
+    bool patch = sequenced[INORDER] == mutations;
+    if (patch)
+    {
+        vector<const Node*>& inorder = sequences[INORDER];
+        size_t rank = inorderRank(node->data);
+        patch = patchInorder(inorder.size() - rank);
+        if (patch)
+            inorder.erase(inorder.begin() + rank);
+    }
+    mutate(true, patch);
+}
+
+template <typename T>
+bool Bstree<T>::patchInorder(size_t moved)
+{
+    inorderMoved += moved;
+    return inorderMoved <= PATCH_BUDGET * sequences[INORDER].size();
+}
+
+template <typename T>
+size_t Bstree<T>::inorderRank(const T& item) const
+{
+    const vector<const Node*>& inorder = sequences[INORDER];
+    return lower_bound(inorder.begin(), inorder.end(), item,
+        [](const Node* node, const T& key) { return key > node->data; }) - inorder.begin();
+}
+
+template <typename T>
+const vector<const typename Bstree<T>::Node*>& Bstree<T>::sequence(Walk walk) const
+{
+    if (sequenced[walk] != mutations)
+    {
+        sequences[walk].clear();
+        if (walk == PREORDER)
+            preorderTraverse(root, sequences[walk]);
+        else if (walk == INORDER)
+        {
+            inorderTraverse(root, sequences[walk]);
+            inorderMoved = 0;
+        }
+        else
+            postorderTraverse(root, sequences[walk]);
+        sequenced[walk] = mutations;
+    }
+    return sequences[walk];
+}
+
+template <typename T>
+void Bstree<T>::recCopy(Node*& dest, Node* src, vector<Node*>* spare)
+{
+    /* copy down the left spine, leaving each right subtree pending with
+       the link it must fill; a degenerate tree keeps the stack short */
+    struct Pending
+    {
+        Node** dest;
+        Node* src;
+    };
+    vector<Pending> pending;
+    Node** link = &dest;
+    while (src || !pending.empty())
+    {
+        if (!src)
+        {
+            link = pending.back().dest;
+            src = pending.back().src;
+            pending.pop_back();
+        }
+        if (spare && !spare->empty())
+        {
+            /* the node stays spare until its data is overwritten, so a
+               throwing copy leaves it to be freed with the other spares */
+            Node* node = spare->back();
+            overwrite(node, src->data);
+            spare->pop_back();
+            node->left = nullptr;
+            node->right = nullptr;
+            *link = node;
+        }
+        else
+            *link = createNode(src->data);
+        (*link)->dead = src->dead;
+        (*link)->leftSize = src->leftSize;
+        (*link)->stale = src->stale;
+        (*link)->shape = src->shape;
+        (*link)->content = src->content;
+        if (src->right)
+            pending.push_back({ &(*link)->right, src->right });
+        link = &(*link)->left;
+        src = src->left;
     }
 }
 
 template<typename T>
 void Bstree<T>::recDestroy(Node* root)
 {
-    if (root)
+    /* rotate every left child up until the node has none, then free the
+       node and go right: O(1) extra space at any height */
+    while (root)
     {
-        if (root->left) recDestroy(root->left);
-        if (root->right) recDestroy(root->right);
-        delete root;
+        if (root->left)
+        {
+            Node* lft = root->left;
+            root->left = lft->right;
+            lft->right = root;
+            root = lft;
+        }
+        else
+        {
+            Node* rgt = root->right;
+            delete root;
+            root = rgt;
+        }
     }
 }
 
+template<typename T>
+void Bstree<T>::reclaim(void* garbage)
+{
+    recDestroy(static_cast<Node*>(garbage));
+}
+
+template<typename T>
+void Bstree<T>::release(Node* subtreeRoot, [[maybe_unused]] long count)
+{
+    notePeak();
+    payload = 0;
+    payloadOverhead = 0;
+    BSTREE_STAT(stats.deallocations += count);
+    if (reclaimer && subtreeRoot)
+        reclaimer->defer(subtreeRoot, &Bstree<T>::reclaim);
+    else
+        recDestroy(subtreeRoot);
+}
+
 template<typename T>
 typename Bstree<T>::Node* Bstree<T>::findParent(Node* node) const          
 {
     Node* tmp = root;
     if (tmp == node)
+    {
+        BSTREE_STAT(stats.descent(FIND_PARENT_DESCENT, 1));
         return nullptr;
+    }
+    BSTREE_STAT(long visited = 0);
     while (true)                                 
     {
         //assert(tmp->data != node->data);
         if (!tmp)
+        {
+            BSTREE_STAT(stats.descent(FIND_PARENT_DESCENT, visited));
             return nullptr;
-        if (tmp->data > node->data)
+        }
+        BSTREE_STAT(visited++);
+        if (BSTREE_COMPARED(stats, tmp->data > node->data))
         {
             //assert(tmp->left);
             if (tmp->left == node)
+            {
+                BSTREE_STAT(stats.descent(FIND_PARENT_DESCENT, visited));
                 return tmp;
+            }
             else
                 tmp = tmp->left;
         }
@@ -246,7 +1381,10 @@ typename Bstree<T>::Node* Bstree<T>::findParent(Node* node) const
         {
             //assert(tmp->right);
             if (tmp->right == node)
+            {
+                BSTREE_STAT(stats.descent(FIND_PARENT_DESCENT, visited));
                 return tmp;
+            }
             else
                 tmp = tmp->right;
         }
@@ -254,67 +1392,90 @@ typename Bstree<T>::Node* Bstree<T>::findParent(Node* node) const
 }
 
 template<typename T>
-void Bstree<T>::inorderTraverse(Node* node, FuncType apply) const
+void Bstree<T>::inorderTraverse(Node* node, vector<const Node*>& sequence) const
 {
-    if (node)
+    vector<Node*> pending;
+    while (node || !pending.empty())
     {
-        inorderTraverse(node->left, apply);
-        apply(node->data);
-        inorderTraverse(node->right, apply);
+        while (node)
+        {
+            pending.push_back(node);
+            node = node->left;
+        }
+        node = pending.back();
+        pending.pop_back();
+        sequence.push_back(node);
+        node = node->right;
     }
 }
 
 template<typename T>
 typename Bstree<T>::Node* Bstree<T>::search(const T& item) const    
 {
+    if (index)
+    {
+        Node* found = index->find(item);
+        BSTREE_STAT(stats.descent(SEARCH_DESCENT, found ? 1 : 0));
+        return found && !found->dead ? found : nullptr;
+    }
     Node* tmp = root;
+    BSTREE_STAT(long visited = 0);
     while (tmp)
     {
-        if (tmp->data == item)
-            return tmp;
-        else if (tmp->data > item)
+        BSTREE_STAT(visited++);
+        if (BSTREE_COMPARED(stats, tmp->data == item))
+            break;
+        else if (BSTREE_COMPARED(stats, tmp->data > item))
             tmp = tmp->left;
         else
             tmp = tmp->right;
     }
-    return tmp;
+    BSTREE_STAT(stats.descent(SEARCH_DESCENT, visited));
+    return tmp && !tmp->dead ? tmp : nullptr;
 }
 
 
 template<typename T>
-bool Bstree<T>::remove(Node* node)
+void Bstree<T>::remove(Node** link)
 {
-    T data;
-    Node* replacement;
-    Node* parent = findParent(node);
-    if (!parent)
-        return false;
+    Node* node = *link;
+    if (index)
+        index->erase(node->data);
     if (node->left && node->right)
     {
-        replacement = node->right;
-        while (replacement->left)
-            replacement = replacement->left;
-        data = replacement->data;
-        remove(replacement);
-        node->data = data;
+        /* the successor is the leftmost node of the right subtree; its data
+           moves up and its own node is unlinked instead */
+        Node** succ = &node->right;
+        BSTREE_STAT(stats.visits[REMOVE_DESCENT]++);
+        while ((*succ)->left)
+        {
+            (*succ)->leftSize--;
+            (*succ)->stale = true;
+            succ = &(*succ)->left;
+            BSTREE_STAT(stats.visits[REMOVE_DESCENT]++);
+        }
+        link = succ;
+        unlinking(*succ);
+        if (index)
+            index->erase((*succ)->data);
+        /* whatever the moved-from data still holds is taken off again
+           when its node is freed */
+        account(node->data, false);
+        account((*succ)->data, false);
+        node->data = move((*succ)->data);
+        account(node->data, true);
+        account((*succ)->data, true);
+        node->dead = (*succ)->dead;
+        if (index)
+            index->insert(node->data, node);
+        node = *succ;
     }
     else
-    {
-        if (!(node->left) && !(node->right))
-            replacement = nullptr;
-        else if (node->left == nullptr)
-            replacement = node->right;
-        else
-            replacement = node->left;
-        if (!parent)
-            root = replacement;
-        else if (parent->left == node)
-            parent->left = replacement;
-        else
-            parent->right = replacement;
-        delete node;
-    }
-    return true;
+        unlinking(node);
+    *link = node->left ? node->left : node->right;
+    destroyNode(node);
+    nodes--;
+    reshapes++;
 }
 
 /****** IMPLEMENT AUGMENTED PRIVATE Bstree FUNCTIONS BELOW ******/
@@ -322,46 +1483,76 @@ bool Bstree<T>::remove(Node* node)
     /*** BEGIN: AUGMENTED PRIVATE FUNCTIONS ***/
 
 template<typename T>                                                                                
-void Bstree<T>::preorderTraverse(Node* node, FuncType apply) const
+void Bstree<T>::preorderTraverse(Node* node, vector<const Node*>& sequence) const
 {
-    if (node)
-    {
-        apply(node->data);
-        preorderTraverse(node->left, apply);
-        preorderTraverse(node->right, apply);
-    }
-    else
+    /* only the pending right subtrees are stacked */
+    vector<Node*> pending;
+    while (node || !pending.empty())
     {
-        return;
+        if (!node)
+        {
+            node = pending.back();
+            pending.pop_back();
+        }
+        sequence.push_back(node);
+        if (node->right)
+            pending.push_back(node->right);
+        node = node->left;
     }
 }
 
 template<typename T>                                                                                
-void Bstree<T>::postorderTraverse(Node* node, FuncType apply) const
+void Bstree<T>::postorderTraverse(Node* node, vector<const Node*>& sequence) const
 {
-    if (node)
+    /* a node is applied when its right subtree is empty or was the last
+       subtree finished */
+    vector<Node*> pending;
+    Node* last = nullptr;
+    while (node || !pending.empty())
     {
-        postorderTraverse(node->left, apply);
-        postorderTraverse(node->right, apply);
-        apply(node->data);
-    }
-    else
-    {
-        return;
+        while (node)
+        {
+            pending.push_back(node);
+            node = node->left;
+        }
+        Node* top = pending.back();
+        if (top->right && top->right != last)
+            node = top->right;
+        else
+        {
+            sequence.push_back(top);
+            last = top;
+            pending.pop_back();
+        }
     }
 }
 
 template<typename T>                                                                                
 long Bstree<T>::height(const Node* node) const
 {
-    if (!node)
+    struct Pending
     {
-        return -1;
-    }
-    else
+        const Node* node;
+        long depth;
+    };
+    vector<Pending> pending;
+    long deepest = -1;
+    long depth = 0;
+    while (node || !pending.empty())
     {
-        return (1 + max(height(node->left), height(node->right)));
+        if (!node)
+        {
+            node = pending.back().node;
+            depth = pending.back().depth;
+            pending.pop_back();
+        }
+        deepest = max(deepest, depth);
+        if (node->right)
+            pending.push_back({ node->right, depth + 1 });
+        node = node->left;
+        depth++;
     }
+    return deepest;
 }
 
 /*  ---- OLD AND INCORRECT. ----
@@ -393,105 +1584,68 @@ bool Bstree<T>::isomorphic(const Node* lft, const Node* rgt) const
 
 template<typename T>
 bool Bstree<T>::isomorphic(const Node* lft, const Node* rgt) const
-{
-    if (!lft && !rgt) 
-    {
-        return true;
-    }
-    else if (!lft || !rgt) 
-    {
-        return false;
-    }
-    else 
-    {
-        return isomorphic(lft->left, rgt->left) &&
-            isomorphic(lft->right, rgt->right);
-    }
-}
-
-template<typename T>                                                                                
-void Bstree<T>::descendants(vector<T>& desc, const Node* node) const
-{
-    Node* cur = search(node->data);
-
-    if (!node)
-    {
-        return;
-    }
-    
-    if (!cur->left)
-    {
-        if (cur->right)
-        {
-            desc.push_back(cur->data);
-            cur = cur->right;
-        }
-        else
-        {
-            return;
-        }
-    }
-
-    if (!cur->right)
-    {
-        if (cur->left)
-        {
-            desc.push_back(cur->data);
-            cur = cur->left;
-        }
-        else
-        {
-            return;
-        }
-    }
-
-    if (cur->right && cur->left)
-    {
-        descendants(desc, cur->left);
-        descendants(desc, cur->right);
-    }
+{
+    return shapeOf(lft) == shapeOf(rgt);
 }
 
 template<typename T>                                                                                
 void Bstree<T>::bias(bool& hlb, bool& hrb, Node* cur) const
 {
-    if (!cur)
-    {
-        return;
-    }
-    
-    int leftH = height(cur->left);
-    int rightH = height(cur->right);
-
-    if (leftH < rightH)
+    /* one postorder pass: the heights of finished subtrees are stacked, and
+       a node compares those of its children when both are done */
+    struct Pending
     {
-        hrb = true;
-    }
-
-    if (leftH > rightH)
+        Node* node;
+        bool expanded;
+    };
+    vector<Pending> pending;
+    vector<long> heights;
+    if (cur)
     {
-        hlb = true;
+        pending.push_back({ cur, false });
     }
 
-    if (cur->left)
+    while (!pending.empty())
     {
+        Pending& top = pending.back();
+        cur = top.node;
+        if (!top.expanded)
+        {
+            top.expanded = true;
+            if (cur->right)
+            {
+                pending.push_back({ cur->right, false });
+            }
+            if (cur->left)
+            {
+                pending.push_back({ cur->left, false });
+            }
+            continue;
+        }
+        pending.pop_back();
+        long rightH = -1;
+        long leftH = -1;
         if (cur->right)
         {
-            bias(hlb, hrb, cur->left);
-            bias(hlb, hrb, cur->right);
+            rightH = heights.back();
+            heights.pop_back();
         }
-        else
+        if (cur->left)
         {
-            bias(hlb, hrb, cur->left);
+            leftH = heights.back();
+            heights.pop_back();
         }
-    }
-    else if (cur->right)
-    {
-        bias(hlb, hrb, cur->right);
-    }
-    else
-    {
-        return;
+
+        if (leftH < rightH)
+        {
+            hrb = true;
+        }
+
+        if (leftH > rightH)
+        {
+            hlb = true;
+        }
+        heights.push_back(1 + max(leftH, rightH));
     }
 }
 
@@ -507,13 +1661,17 @@ void Bstree<T>::bias(bool& hlb, bool& hrb, Node* cur) const
 template<typename T>                                                                                
 void Bstree<T>::preorderTraverse(FuncType apply) const
 {
-    preorderTraverse(root, apply);
+    for (const Node* node : sequence(PREORDER))
+        if (!node->dead)
+            apply(node->data);
 }
 
 template<typename T>                                                                                
 void Bstree<T>::postorderTraverse(FuncType apply) const
 {
-    postorderTraverse(root, apply);
+    for (const Node* node : sequence(POSTORDER))
+        if (!node->dead)
+            apply(node->data);
 }
 
 template<typename T>                                                                                
@@ -525,31 +1683,101 @@ long Bstree<T>::height() const
 template<typename T>                                                                                
 vector<T> Bstree<T>::ancestors(T entry) const
 {
-    
-    Node* cur = search(entry);
-    Node* parent = findParent(cur);
+    Relatives range = ancestor_range(entry);
     vector<T> anc;
+    anc.reserve(range.size());
+    for (const T& item : range)
+        anc.push_back(item);
+    return anc;
+}
 
-    if (!cur)
+template<typename T>                                                                                
+vector<T> Bstree<T>::descendants(T entry) const
+{
+    vector<T> desc;
+    if (!search(entry))
+        return desc;
+    Relatives range = descendant_range(entry);
+    desc.reserve(range.size());
+    for (const T& item : range)
+        desc.push_back(item);
+    return desc;
+}
+
+template<typename T>
+typename Bstree<T>::Relatives Bstree<T>::ancestor_range(const T& entry) const
+{
+    /* the live nodes on the path down to the entry, root first, so its top
+       is the nearest live ancestor */
+    vector<const Node*> path;
+    const Node* cur = root;
+    BSTREE_STAT(long visited = 0);
+    while (cur)
+    {
+        BSTREE_STAT(visited++);
+        if (BSTREE_COMPARED(stats, cur->data == entry))
+            break;
+        if (!cur->dead)
+            path.push_back(cur);
+        if (BSTREE_COMPARED(stats, cur->data > entry))
+            cur = cur->left;
+        else
+            cur = cur->right;
+    }
+    BSTREE_STAT(stats.descent(SEARCH_DESCENT, visited));
+    if (!cur || cur->dead)
     {
         throw BstreeException("Ancestors could not be found, element does not exist in tree");
     }
+    long count = path.size();
+    return Relatives(move(path), false, count);
+}
 
-    while (parent)
+template<typename T>
+typename Bstree<T>::Relatives Bstree<T>::descendant_range(const T& entry) const
+{
+    /* [lo, hi) are the inorder ranks of the subtree being descended */
+    const Node* cur = root;
+    long lo = 0;
+    long hi = nodes;
+    BSTREE_STAT(long visited = 0);
+    while (cur)
+    {
+        BSTREE_STAT(visited++);
+        if (BSTREE_COMPARED(stats, cur->data == entry))
+            break;
+        if (BSTREE_COMPARED(stats, cur->data > entry))
+        {
+            hi = lo + cur->leftSize;
+            cur = cur->left;
+        }
+        else
+        {
+            lo += cur->leftSize + 1;
+            cur = cur->right;
+        }
+    }
+    BSTREE_STAT(stats.descent(SEARCH_DESCENT, visited));
+    if (!cur || cur->dead)
     {
-        anc.push_back(parent->data);
-        cur = parent;
-        parent = findParent(cur);
+        throw BstreeException("Descendants could not be found, element does not exist in tree");
     }
-    return anc;
+    vector<const Node*> start;
+    if (cur->right)
+        start.push_back(cur->right);
+    if (cur->left)
+        start.push_back(cur->left);
+    Relatives range(move(start), true, hi - lo - 1);
+    /* the ranks count tombstones too, so then the live ones are counted */
+    if (nodes > order)
+        range.count = distance(range.begin(), range.end());
+    return range;
 }
 
-template<typename T>                                                                                
-vector<T> Bstree<T>::descendants(T entry) const
+template<typename T>
+long Bstree<T>::descendant_count(const T& entry) const
 {
-    vector<T> desc;
-    descendants(desc, search(entry));
-    return desc;
+    return descendant_range(entry).size();
 }
 
 template<typename T>
@@ -559,27 +1787,123 @@ bool Bstree<T>::isomorphic() const
     {
         return true;
     }
+    rehash();
     return isomorphic(root->left, root->right);
 }
 
-template<typename T>                                                                                
-const T* Bstree<T>::getParent(T entry) const
+template<typename T>
+bool Bstree<T>::operator==(const Bstree<T>& other) const
 {
-    if (!search(entry))
+    if (order != other.order)
+        return false;
+    if (HASHABLE)
     {
-        throw BstreeException("Entry does not exist in tree, cannot use getParent");
+        rehash();
+        other.rehash();
+        return contentOf(root) == contentOf(other.root);
+    }
+    const vector<const Node*>& mine = sequence(INORDER);
+    const vector<const Node*>& theirs = other.sequence(INORDER);
+    size_t k = 0;
+    for (const Node* node : mine)
+    {
+        if (node->dead)
+            continue;
+        while (theirs[k]->dead)
+            k++;
+        if (!(node->data == theirs[k++]->data))
+            return false;
     }
+    return true;
+}
+
+template<typename T>
+bool Bstree<T>::operator!=(const Bstree<T>& other) const
+{
+    return !(*this == other);
+}
 
-    else if (!findParent(search(entry)))
+template<typename T>
+void Bstree<T>::diff(const Bstree<T>& other, vector<T>& onlyHere, vector<T>& onlyThere) const
+{
+    rehash();
+    other.rehash();
+    /* pairs of subtrees spanning the same range of items, with their node
+       counts, taken in inorder: a pair rooted at equal items stacks its
+       right pair, itself and its left pair, so the differences come out in
+       increasing order */
+    struct Pair
     {
-        return nullptr;
+        Node* mine;
+        Node* theirs;
+        long mineCount, theirsCount;
+        bool self;
+    };
+    vector<Pair> pending;
+    vector<const Node*> mine, theirs;
+    pending.push_back({ root, other.root, nodes, other.nodes, false });
+    while (!pending.empty())
+    {
+        Pair pair = pending.back();
+        pending.pop_back();
+        if (pair.self)
+        {
+            if (!pair.mine->dead && pair.theirs->dead)
+                onlyHere.push_back(pair.mine->data);
+            else if (pair.mine->dead && !pair.theirs->dead)
+                onlyThere.push_back(pair.theirs->data);
+            continue;
+        }
+        if (HASHABLE && pair.mineCount == pair.theirsCount && contentOf(pair.mine) == contentOf(pair.theirs))
+            continue;
+        if (pair.mine && pair.theirs && BSTREE_COMPARED(stats, pair.mine->data == pair.theirs->data))
+        {
+            long mineLeft = pair.mine->leftSize, theirsLeft = pair.theirs->leftSize;
+            pending.push_back({ pair.mine->right, pair.theirs->right, pair.mineCount - mineLeft - 1,
+                pair.theirsCount - theirsLeft - 1, false });
+            pending.push_back({ pair.mine, pair.theirs, 0, 0, true });
+            pending.push_back({ pair.mine->left, pair.theirs->left, mineLeft, theirsLeft, false });
+            continue;
+        }
+        /* the shapes part here: merge the two subtrees in inorder */
+        mine.clear();
+        theirs.clear();
+        inorderTraverse(pair.mine, mine);
+        other.inorderTraverse(pair.theirs, theirs);
+        size_t j = 0, k = 0;
+        while (j < mine.size() || k < theirs.size())
+        {
+            if (j < mine.size() && mine[j]->dead)
+                j++;
+            else if (k < theirs.size() && theirs[k]->dead)
+                k++;
+            else if (k == theirs.size() || (j < mine.size() && BSTREE_COMPARED(stats, theirs[k]->data > mine[j]->data)))
+                onlyHere.push_back(mine[j++]->data);
+            else if (j == mine.size() || BSTREE_COMPARED(stats, mine[j]->data > theirs[k]->data))
+                onlyThere.push_back(theirs[k++]->data);
+            else
+            {
+                j++;
+                k++;
+            }
+        }
     }
+}
 
-    else
+template<typename T>                                                                                
+const T* Bstree<T>::getParent(T entry) const
+{
+    Node* node = search(entry);
+    if (!node)
     {
-        Node* parent = findParent(search(entry));
-        return &(parent->data);
+        throw BstreeException("Entry does not exist in tree, cannot use getParent");
     }
+
+    /* a tombstone is passed over, as ancestors() does */
+    Node* parent = findParent(node);
+    while (parent && parent->dead)
+        parent = findParent(parent);
+    return parent ? &(parent->data) : nullptr;
 }
 
 
@@ -602,7 +1926,7 @@ const T* Bstree<T>::getSibling(T entry) const
     
     else if (parent->left == cur)
     {
-        if (parent->right)
+        if (parent->right && !parent->right->dead)
         {
             result = &(parent->right->data);
         }
@@ -614,7 +1938,7 @@ const T* Bstree<T>::getSibling(T entry) const
     
     else if (parent->right == cur)
     {
-        if (parent->left)
+        if (parent->left && !parent->left->dead)
         {
             result = &(parent->left->data);
         }
@@ -635,7 +1959,7 @@ const T* Bstree<T>::leftChild(T entry) const
     {
         throw BstreeException("Entry does not exist in tree");
     }
-    else if (!node->left)
+    else if (!node->left || node->left->dead)
     {
         return nullptr;
     }
@@ -654,7 +1978,7 @@ const T* Bstree<T>::rightChild(T entry) const
     {
         throw BstreeException("Entry does not exist in tree");
     }
-    else if (!node->right)
+    else if (!node->right || node->right->dead)
     {
         return nullptr;
     }
@@ -669,13 +1993,14 @@ const T* Bstree<T>::rightChild(T entry) const
 template<typename T>                                 
 bool Bstree<T>::isFibonacci() const
 {
+    /* the shape is that of the nodes, tombstones included */
     bool leftcheck = false;
     bool rightcheck = false;
     bias(leftcheck, rightcheck, root);
 
     
 
-    if (size() <= 1)
+    if (nodes <= 1)
     {
         return true;
     }
@@ -688,7 +2013,7 @@ bool Bstree<T>::isFibonacci() const
     int prev = 0;
     int fib = 1;
     int next = 1;
-    int final = size() + 1;
+    int final = nodes + 1;
     int h = height(root);
     int i = 3;
 
@@ -709,7 +2034,490 @@ bool Bstree<T>::isFibonacci() const
     }
 }
 
-/**** END: AUGMENTED PUBLIC FUNCTIONS ***/
+template<typename T>
+void Bstree<T>::save(const string& filename) const
+{
+    vector<const T*> keys;
+    vector<unsigned char> shape;
+    keys.reserve(order);
+    shape.reserve(order);
+    if (nodes == order)
+    {
+        vector<const Node*> pending;
+        if (root)
+            pending.push_back(root);
+        while (!pending.empty())
+        {
+            const Node* cur = pending.back();
+            pending.pop_back();
+            keys.push_back(&cur->data);
+            shape.push_back((cur->left ? 1 : 0) | (cur->right ? 2 : 0));
+            if (cur->right)
+                pending.push_back(cur->right);
+            if (cur->left)
+                pending.push_back(cur->left);
+        }
+    }
+    else
+    {
+        /* a snapshot holds no tombstones: the live nodes are written in the
+           perfectly balanced shape compact() would give them, as rebuild()
+           splits the ranges, and this tree keeps its own shape */
+        vector<const Node*> live;
+        live.reserve(order);
+        for (const Node* node : sequence(INORDER))
+            if (!node->dead)
+                live.push_back(node);
+        struct Range
+        {
+            size_t lo, hi;
+        };
+        vector<Range> ranges;
+        if (!live.empty())
+            ranges.push_back({ 0, live.size() });
+        while (!ranges.empty())
+        {
+            Range range = ranges.back();
+            ranges.pop_back();
+            size_t mid = range.lo + (range.hi - range.lo) / 2;
+            keys.push_back(&live[mid]->data);
+            shape.push_back((mid > range.lo ? 1 : 0) | (mid + 1 < range.hi ? 2 : 0));
+            if (mid + 1 < range.hi)
+                ranges.push_back({ mid + 1, range.hi });
+            if (mid > range.lo)
+                ranges.push_back({ range.lo, mid });
+        }
+    }
+    writeSnapshot<T>(filename, keys, shape);
+}
+
+template<typename T>
+void Bstree<T>::open(const string& filename)
+{
+    SnapshotReader<T> snapshot(filename);
+
+    /* Rebuild in preorder: each node fills the link it was promised by its
+       parent; a node with a right child defers that link until its left
+       subtree is complete. */
+    Bstree<T> loaded;
+    vector<Node**> pending;
+    Node** link = &loaded.root;
+    bool valid = true;
+    for (uint64_t k = 0; k < snapshot.size(); k++)
+    {
+        if (!link)
+        {
+            valid = false;
+            break;
+        }
+        *link = loaded.createNode(snapshot.key(k));
+        loaded.order++;
+        loaded.nodes++;
+        if (snapshot.shape(k) & 2)
+            pending.push_back(&(*link)->right);
+        if (snapshot.shape(k) & 1)
+            link = &(*link)->left;
+        else if (!pending.empty())
+        {
+            link = pending.back();
+            pending.pop_back();
+        }
+        else
+            link = nullptr;
+    }
+    if (!valid || (snapshot.size() > 0 && link) || !pending.empty())
+        throw BstreeException("Exception: " + filename + " is corrupt or of another key type on open().");
+    recount(loaded.root);
+
+    /* both trees are held until the old one is let go of */
+    BstreeMemory held = memory_usage();
+    peak = max(held.peakBytes, held.total() + loaded.memory_usage().total());
+    release(root, nodes);
+    reshapes++;
+    mutate(true);
+    BSTREE_STAT(stats.allocations += loaded.stats.allocations);
+    root = loaded.root;
+    order = loaded.order;
+    nodes = loaded.nodes;
+    payload = loaded.payload;
+    payloadOverhead = loaded.payloadOverhead;
+    if (index)
+        reindex();
+    loaded.root = nullptr;
+    loaded.order = 0;
+    loaded.nodes = 0;
+    loaded.payload = 0;
+    loaded.payloadOverhead = 0;
+}
+
+template<typename T>
+void Bstree<T>::setScapegoat(double factor)
+{
+    if (factor != 0 && !(factor > 0.5 && factor < 1))
+        throw BstreeException("Exception: scapegoat balance factor must be in (0.5, 1) on setScapegoat().");
+    alpha = factor;
+    /* without lazy deletes no tombstone is ever freed otherwise */
+    if (alpha == 0 && nodes > order)
+        compact();
+}
+
+template<typename T>
+void Bstree<T>::compact()
+{
+    rebuild(&root);
+}
+
+template<typename T>
+void Bstree<T>::buildOptimal(const vector<T>& items, const vector<double>& hits, const vector<double>& misses)
+{
+    if (items.size() != hits.size())
+        throw BstreeException("Exception: there must be one access frequency per item on buildOptimal().");
+    for (size_t k = 1; k < items.size(); k++)
+        if (!(items[k] > items[k - 1]))
+            throw BstreeException("Exception: the items are not in increasing order on buildOptimal().");
+    vector<size_t> shape = optimalShape(hits, misses);
+
+    /* chain the new nodes in order and relink them into the shape */
+    Bstree<T> built;
+    Node** link = &built.root;
+    for (const T& item : items)
+    {
+        *link = built.createNode(item);
+        link = &(*link)->right;
+    }
+    built.order = built.nodes = items.size();
+    built.rebuild(&built.root, &shape);
+
+    /* both trees are held until the old one is let go of */
+    BstreeMemory held = memory_usage();
+    peak = max(held.peakBytes, held.total() + built.memory_usage().total());
+    release(root, nodes);
+    reshapes++;
+    mutate(true);
+    BSTREE_STAT(stats.allocations += built.stats.allocations);
+    root = built.root;
+    order = built.order;
+    nodes = built.nodes;
+    payload = built.payload;
+    payloadOverhead = built.payloadOverhead;
+    if (index)
+        reindex();
+    built.root = nullptr;
+    built.order = 0;
+    built.nodes = 0;
+    built.payload = 0;
+    built.payloadOverhead = 0;
+}
+
+template<typename T>
+void Bstree<T>::optimize(const vector<double>& hits, const vector<double>& misses)
+{
+    if (static_cast<long>(hits.size()) != order)
+        throw BstreeException("Exception: there must be one access frequency per item on optimize().");
+    vector<size_t> shape = optimalShape(hits, misses);
+    rebuild(&root, &shape);
+}
+
+template<typename T>
+void Bstree<T>::shift(const T& item, long delta)
+{
+    descend([&item](const T& here) { return here == item ? 0 : here > item ? -1 : 1; }, delta);
+}
+
+template<typename T>
+template <typename Side>
+typename Bstree<T>::Node** Bstree<T>::descend(Side side, long delta)
+{
+    Node** link = &root;
+    while (*link)
+    {
+        int way = side((*link)->data);
+        if (way == 0)
+            break;
+        if (way < 0)
+        {
+            (*link)->leftSize += delta;
+            link = &(*link)->left;
+        }
+        else
+            link = &(*link)->right;
+    }
+    return link;
+}
+
+template<typename T>
+void Bstree<T>::touch(const T& item)
+{
+    Node* cur = root;
+    while (cur)
+    {
+        cur->stale = true;
+        if (cur->data == item)
+            break;
+        cur = cur->data > item ? cur->left : cur->right;
+    }
+}
+
+template<typename T>
+void Bstree<T>::rehash() const
+{
+    /* postorder over the stale nodes: the subtree of a node that is not
+       stale is up to date, since the ancestors of stale nodes are stale */
+    struct Pending
+    {
+        Node* node;
+        bool expanded;
+    };
+    bool all = !hashed;
+    vector<Pending> pending;
+    if (root && (all || root->stale))
+        pending.push_back({ root, false });
+    while (!pending.empty())
+    {
+        Pending& top = pending.back();
+        Node* cur = top.node;
+        if (!top.expanded)
+        {
+            top.expanded = true;
+            if (cur->right && (all || cur->right->stale))
+                pending.push_back({ cur->right, false });
+            if (cur->left && (all || cur->left->stale))
+                pending.push_back({ cur->left, false });
+            continue;
+        }
+        pending.pop_back();
+        cur->shape = mix(mix(shapeOf(cur->left) + 0x9E3779B97F4A7C15ull) + shapeOf(cur->right));
+        cur->content = contentOf(cur->left) + contentOf(cur->right) + (cur->dead ? 0 : digest(cur->data));
+        cur->stale = false;
+    }
+    hashed = true;
+}
+
+template<typename T>
+uint64_t Bstree<T>::mix(uint64_t bits)
+{
+    /* the finalizer of splitmix64 */
+    bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ull;
+    bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBull;
+    return bits ^ (bits >> 31);
+}
+
+template<typename T>
+uint64_t Bstree<T>::digest(const T& item)
+{
+    if constexpr (HASHABLE)
+        return mix(hash<T>()(item) + 0x9E3779B97F4A7C15ull);
+    else
+        return 0;
+}
+
+template<typename T>
+uint64_t Bstree<T>::shapeOf(const Node* node)
+{
+    return node ? node->shape : 0;
+}
+
+template<typename T>
+uint64_t Bstree<T>::contentOf(const Node* node)
+{
+    return node ? node->content : 0;
+}
 
+template<typename T>
+void Bstree<T>::reindex()
+{
+    index->clear();
+    vector<Node*> pending;
+    if (root)
+        pending.push_back(root);
+    while (!pending.empty())
+    {
+        Node* node = pending.back();
+        pending.pop_back();
+        index->insert(node->data, node);
+        if (node->left)
+            pending.push_back(node->left);
+        if (node->right)
+            pending.push_back(node->right);
+    }
+}
+
+template<typename T>
+long Bstree<T>::recount(Node* node)
+{
+    /* one postorder pass: the sizes of finished subtrees are stacked, and a
+       node takes those of its children when both are done */
+    struct Pending
+    {
+        Node* node;
+        bool expanded;
+    };
+    vector<Pending> pending;
+    vector<long> sizes;
+    if (node)
+        pending.push_back({ node, false });
+    while (!pending.empty())
+    {
+        Pending& top = pending.back();
+        Node* cur = top.node;
+        if (!top.expanded)
+        {
+            top.expanded = true;
+            if (cur->right)
+                pending.push_back({ cur->right, false });
+            if (cur->left)
+                pending.push_back({ cur->left, false });
+            continue;
+        }
+        pending.pop_back();
+        long rightSize = 0;
+        long leftSize = 0;
+        if (cur->right)
+        {
+            rightSize = sizes.back();
+            sizes.pop_back();
+        }
+        if (cur->left)
+        {
+            leftSize = sizes.back();
+            sizes.pop_back();
+        }
+        cur->leftSize = leftSize;
+        sizes.push_back(leftSize + 1 + rightSize);
+    }
+    return sizes.empty() ? 0 : sizes.back();
+}
+
+template<typename T>
+long Bstree<T>::count(const Node* node)
+{
+    long total = 0;
+    vector<const Node*> pending;
+    if (node)
+        pending.push_back(node);
+    while (!pending.empty())
+    {
+        node = pending.back();
+        pending.pop_back();
+        total++;
+        if (node->left)
+            pending.push_back(node->left);
+        if (node->right)
+            pending.push_back(node->right);
+    }
+    return total;
+}
+
+template<typename T>
+void Bstree<T>::rebuild(Node** link, const vector<size_t>* preorder)
+{
+    reshapes++;
+    /* flatten the live nodes in inorder, freeing the tombstones; the
+       subtree is a block of the flattened inorder, which keeps its order
+       and only loses the tombstones */
+    bool patch = sequenced[INORDER] == mutations;
+    size_t start = 0, span = 0;
+    vector<Node*> sorted;
+    vector<Node*> pending;
+    Node* cur = *link;
+    while (cur || !pending.empty())
+    {
+        while (cur)
+        {
+            pending.push_back(cur);
+            cur = cur->left;
+        }
+        cur = pending.back();
+        pending.pop_back();
+        Node* next = cur->right;
+        if (patch && span++ == 0)
+            start = inorderRank(cur->data);
+        if (cur->dead)
+        {
+            if (index)
+                index->erase(cur->data);
+            destroyNode(cur);
+            nodes--;
+        }
+        else
+            sorted.push_back(cur);
+        cur = next;
+    }
+    if (patch && sorted.size() < span)
+    {
+        vector<const Node*>& inorder = sequences[INORDER];
+        patch = patchInorder(inorder.size() - start - sorted.size());
+        if (patch)
+        {
+            copy(sorted.begin(), sorted.end(), inorder.begin() + start);
+            inorder.erase(inorder.begin() + start + sorted.size(), inorder.begin() + start + span);
+        }
+    }
+    mutate(true, patch);
+    /* relink: the middle node of each range, or the next node of the
+       preorder, roots the range; a range is pending with the link it must
+       fill, and the left range is taken first, as the preorder demands */
+    struct Range
+    {
+        Node** link;
+        size_t lo, hi;
+    };
+    vector<Range> ranges;
+    ranges.push_back({ link, 0, sorted.size() });
+    size_t next = 0;
+    while (!ranges.empty())
+    {
+        Range range = ranges.back();
+        ranges.pop_back();
+        if (range.lo == range.hi)
+        {
+            *range.link = nullptr;
+            continue;
+        }
+        size_t mid = preorder ? (*preorder)[next++] : range.lo + (range.hi - range.lo) / 2;
+        Node* node = sorted[mid];
+        *range.link = node;
+        node->leftSize = mid - range.lo;
+        node->stale = true;
+        ranges.push_back({ &node->right, mid + 1, range.hi });
+        ranges.push_back({ &node->left, range.lo, mid });
+    }
+}
+
+template<typename T>
+const BstreeStats* Bstree<T>::statistics() const
+{
+#ifdef BSTREE_STATS
+    return &stats;
+#else
+    return nullptr;
+#endif
+}
+
+template<typename T>
+BstreeMemory Bstree<T>::memory_usage() const
+{
+    BstreeMemory usage;
+    usage.nodes = nodes;
+    usage.nodeBytes = nodes * sizeof(Node);
+    usage.payloadBytes = payload;
+    usage.indexBytes = index ? index->bytes() : 0;
+    usage.overheadBytes = nodes * BstreeMemory::overhead(sizeof(Node)) + payloadOverhead
+        + (usage.indexBytes > 0 ? BstreeMemory::overhead(usage.indexBytes) : 0);
+    for (int walk = 0; walk < WALKS; walk++)
+    {
+        size_t bytes = sequences[walk].capacity() * sizeof(const Node*);
+        usage.cacheBytes += bytes;
+        usage.overheadBytes += bytes > 0 ? BstreeMemory::overhead(bytes) : 0;
+    }
+    usage.peakBytes = max(peak, usage.total());
+    return usage;
+}
 
+template<typename T>
+void Bstree<T>::resetStatistics()
+{
+    BSTREE_STAT(stats.reset());
+}
 
+/**** END: AUGMENTED PUBLIC FUNCTIONS ***/
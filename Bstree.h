@@ -6,6 +6,72 @@
  * Date: 9999-99-99
  * Course: csc 1254 Section 1
  * Instructor: Dr. Duncan
+ *
+ * Balancing policy: by default the tree is a plain binary search tree.
+ * setScapegoat(alpha) selects scapegoat balancing with lazy deletes: remove
+ * only marks a node as a tombstone; a subtree is rebuilt into perfect balance
+ * when an insert lands deeper than log base 1/alpha of the number of nodes,
+ * and the whole tree is rebuilt once fewer than alpha of its nodes are
+ * alive. Updates then cost amortized O(log n). No query rebuilds the tree: a
+ * tombstone keeps its place in the shape (height, isomorphic, isFibonacci)
+ * but is never reported, so traversals and the genealogy functions pass
+ * over it, and save writes the live nodes in the shape compact() would
+ * give them.
+ *
+ * Every node counts the nodes of its left subtree (Knuth's RANK field), so
+ * the descent that locates an entry also gives the size of its subtree.
+ * Only left turns are counted so that inserting ascending keys through a
+ * Finger updates no ancestor.
+ *
+ * setIndexed(true) adds a hash index from every key to its node, so that
+ * inTree, retrieve, and the genealogy functions find a node in O(1)
+ * expected time instead of descending, and so that an insert of a present
+ * key or a lazy remove takes no descent. Updates of a new key still descend
+ * to keep the order. The keys need a std::hash only when the index is
+ * turned on.
+ *
+ * Traversals replay cached sequences of nodes. Each of the preorder, inorder
+ * and postorder is flattened on the first traversal after the tree changed
+ * shape, and replayed until it changes shape again; a change of what the
+ * nodes hold (an overwrite, a lazy remove, a revived tombstone) keeps them,
+ * since the data is read when they are replayed. An insert or a remove of a
+ * single node patches the flattened inorder in place, finding the node by
+ * binary search, and a rebuild only drops the freed tombstones from it, so
+ * a tree that is traversed between small edits is not walked again. A patch
+ * moves the entries after it, so the patches stop once they have moved a
+ * few times as many entries as a flattening visits, and a long run of edits
+ * costs no more than walking the tree again at the next traversal. The
+ * caches are filled by const traversals, so even traversals of an
+ * unchanged tree must not run concurrently.
+ *
+ * Every node also keeps two hashes of its subtree, tombstones included: a
+ * Merkle hash of its shape, mixed from those of its children, and a hash of
+ * its live items, the sum of a mixed std::hash of each one, so that subtrees
+ * holding the same items in other shapes agree. They are not refreshed by
+ * the updates: an update marks the nodes on its path stale, and the next
+ * query that needs the hashes recomputes the stale nodes only, so a run of
+ * updates costs one recomputation of the part of the tree it touched, and
+ * ascending inserts through a Finger still mark O(1) nodes each. Then
+ * isomorphic() and operator== compare two hashes, and diff() descends only
+ * where the hashes of two trees differ. Equal hashes are taken for equal
+ * subtrees; two different ones collide with a chance of about 2^-64. Items
+ * that compare equal must hash equally. Without a std::hash for the items,
+ * the content hashes are zero and operator== and diff() walk the trees.
+ *
+ * apply_batch applies a run of inserts and removes in one ordered pass:
+ * the ops are grouped by item, the last one of each item deciding its data
+ * and whether it is present, and one descent splits the sorted groups
+ * among the subtrees, on several threads for large batches. The new items
+ * that fall in the same empty link are linked as the treap whose
+ * priorities are the positions of their first inserts, which is the shape
+ * inserting them one by one gives, so the tree ends up exactly as if the
+ * ops had been applied in order. Where the order does change the shape,
+ * a remove on a plain tree or an op after which the scapegoat policy
+ * rebuilds, the op is applied by itself between two merged runs. A run
+ * shorter than SHORTEST_MERGE is applied op by op, as sorting it costs
+ * more than the descents it saves; a scapegoat tree remembers how long its
+ * runs last between rebuilds, so that a workload that rebuilds often is
+ * mostly applied op by op instead of merged and thrown away.
  * </pre>
  */
 
@@ -14,8 +80,19 @@
 #include <stdexcept>
 #include <algorithm>
 #include <vector>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <thread>
 
 #include "BstreeException.h"
+#include "BstreeSnapshot.h"
+#include "BstreeOptimal.h"
+#include "BstreeReclaimer.h"
+#include "BstreeIndex.h"
+#include "BstreeStats.h"
+#include "BstreeMemory.h"
 
 #ifndef BSTREE_H
 #define BSTREE_H
@@ -28,11 +105,50 @@ using namespace std;
  */
 template <typename T> class Bstree
 {
+    /**
+     * BstreeMap stores its entries in a Bstree and works on its nodes
+     */
+    template <typename K, typename V, typename Compare> friend class BstreeMap;
+public:
+    /**
+     * forward declaration of the Op struct
+     */
+    struct Op;
 private:
     /**
      * forward declaration of a function pointer of type (const T&) -> void
      */
     typedef void (*FuncType)(const T& item);
+    /**
+     * the orders the traversals visit the nodes in; they index the
+     * flattened sequences
+     */
+    enum Walk { PREORDER, INORDER, POSTORDER, WALKS };
+    /**
+     * whether the items have a std::hash, and so content hashes
+     */
+    static constexpr bool HASHABLE = is_default_constructible<hash<T>>::value;
+    /**
+     * the number of distinct items from which apply_batch descends on
+     * several threads
+     */
+    static constexpr size_t PARALLEL_GROUPS = 1 << 14;
+    /**
+     * the fewest ops that apply_batch merges; a shorter run costs less to
+     * apply an op at a time than to sort
+     */
+    static constexpr size_t SHORTEST_MERGE = 1 << 14;
+    /**
+     * the reciprocal of the fraction by which apply_batch lengthens the run
+     * it tries to merge on a scapegoat tree after each run applied op by op
+     */
+    static constexpr size_t RUN_GROWTH = 16;
+    /**
+     * the number of times its own length that the patches of the flattened
+     * inorder may move its entries before it is flattened again instead;
+     * moving an entry costs far less than visiting a node
+     */
+    static constexpr size_t PATCH_BUDGET = 8;
     /**
      * Constructs an empty binary search tree;
      */
@@ -48,19 +164,102 @@ private:
      * A pointer to the root node of this tree
      */
     Node* root;
+    /**
+     * the number of nodes in this tree including tombstones
+     */
+    long nodes;
+    /**
+     * the scapegoat balance factor, or 0 for no balancing
+     */
+    double alpha;
+    /**
+     * the number of times nodes were unlinked or relinked; a finger taken
+     * at another count may hold stale links and is not followed
+     */
+    unsigned long reshapes;
+    /**
+     * the thread that frees the nodes this tree lets go of, or null to free
+     * them on the spot
+     */
+    BstreeReclaimer* reclaimer;
+    /**
+     * the hash index from the keys to their nodes, tombstones included, or
+     * null when the tree is not indexed
+     */
+    BstreeIndex<T, Node*>* index;
+    /**
+     * the bytes the items of the nodes hold outside them, and the estimated
+     * allocator overhead of those bytes; see BstreeMemory.h
+     */
+    size_t payload, payloadOverhead;
+    /**
+     * the largest footprint recorded so far; the footprint only shrinks
+     * where memory is let go of, so it is recorded there
+     */
+    size_t peak;
+    /**
+     * the number of mutations applied to this tree; see version()
+     */
+    unsigned long mutations;
+    /**
+     * the nodes of this tree, tombstones included, in each order, as last
+     * flattened or patched
+     */
+    mutable vector<const Node*> sequences[WALKS];
+    /**
+     * the mutation count each sequence matches, or ~0 for none
+     */
+    mutable unsigned long sequenced[WALKS];
+    /**
+     * the entries the patches of the flattened inorder have moved since it
+     * was last flattened
+     */
+    mutable size_t inorderMoved;
+    /**
+     * whether the hashes of the nodes that are not stale are up to date;
+     * when false, every hash is recomputed on the next query
+     */
+    mutable bool hashed;
+    /**
+     * the longest run the next apply_batch merges on a scapegoat tree; a
+     * rebuild cuts it to twice the prefix merged before it, and it grows
+     * back by a fraction of each run then applied op by op
+     */
+    size_t batchRun;
+#ifdef BSTREE_STATS
+    /**
+     * the instrumentation counters; see BstreeStats.h
+     */
+    mutable BstreeStats stats;
+#endif
 
     /**
-     * An auxiliary recursive function for the copy constructor
-     * @param dest the root of a corresponding subtree of the destination tree
+     * An auxiliary function for the copy constructor and assign
+     * @param dest the empty link that receives the copy
      * @param src the root of a corresponding subtree of the source tree
+     * @param spare detached nodes to be overwritten before new ones are
+     * allocated, or null
      */
-    void recCopy(Node*& dest, Node* src);
+    void recCopy(Node*& dest, Node* src, vector<Node*>* spare = nullptr);
 
     /**
-     * An auxiliary recursive function for the destructor.
+     * An auxiliary function for the destructor: frees a detached subtree
      * @param subtreRoot a pointer to the root of a subtree of this tree
      */
-    void recDestroy(Node* subtreeRoot);
+    static void recDestroy(Node* subtreeRoot);
+    /**
+     * Frees a detached subtree for the reclaimer
+     * @param garbage the root of the subtree
+     */
+    static void reclaim(void* garbage);
+    /**
+     * Lets go of every node of this tree, detached as one subtree: hands it
+     * to the reclaimer, if any, or frees it, and clears the payload counts
+     * @param subtreeRoot the root of the subtree, or null
+     * @param count the number of its nodes, tombstones included; counted
+     * only with BSTREE_STATS
+     */
+    void release(Node* subtreeRoot, long count);
     /**
      * Give a pointer to the parent node of the specified Node
      * @param node the node whose parent node is to be found
@@ -68,18 +267,256 @@ private:
      */
     Node* findParent(Node* node) const;
     /**
-     * Traverses this tree in inorder
+     * Flattens a subtree in inorder
      * @param node a node of this tree
-     * @param apply a pointer to a function of type (const T&) -> void
-     * that is applied to the data field in the specified node
+     * @param sequence receives the nodes of the subtree, tombstones
+     * included
+     */
+    void inorderTraverse(Node* node, vector<const Node*>& sequence) const;
+    /**
+     * Unlinks and frees the node held by the specified link. A node with two
+     * children takes over the data of its inorder successor, whose node is
+     * freed instead.
+     * @param link the parent's link to the node, or the root link
+     */
+    void remove(Node** link);
+    /**
+     * Allocates a node; every node of this tree is created here
+     * @param item the data of the node, moved into it
+     * @return the new node
+     */
+    Node* createNode(T item);
+    /**
+     * Detaches the node held by the specified link without freeing it; a
+     * node with two children is replaced by its inorder successor, which is
+     * relinked, not copied
+     * @param link the parent's link to the node, or the root link
+     * @return the detached node, with no children
+     */
+    Node* unlink(Node** link);
+    /**
+     * Returns a node to the allocator; every node of this tree is freed here
+     * @param node the node to be freed
+     */
+    void destroyNode(Node* node);
+    /**
+     * Counts the storage an item holds outside its node in or out of the
+     * footprint of this tree
+     * @param item the data of a node
+     * @param held true when the node gains the item, false when it loses it
+     */
+    void account(const T& item, bool held);
+    /**
+     * Overwrites the data of a node, keeping the footprint up to date
+     * @param node the node
+     * @param item the new data
+     */
+    void overwrite(Node* node, const T& item);
+    /**
+     * Records the current footprint as the peak if it is larger; called
+     * before memory is let go of
+     */
+    void notePeak();
+    /**
+     * Counts a mutation of this tree. The flattened sequences only hold the
+     * shape, so a mutation that adds, frees or relinks no node keeps them.
+     * @param reshaped true when nodes were added, freed or relinked
+     * @param inorderKept true when the flattened inorder, if it matched the
+     * tree, still does or has been patched to
+     */
+    void mutate(bool reshaped, bool inorderKept = false);
+    /**
+     * Counts the linking of a new node into this tree, patching the
+     * flattened inorder if it matches the tree
+     * @param node the new node
+     */
+    void linked(Node* node);
+    /**
+     * Counts the unlinking of a node from this tree, patching the flattened
+     * inorder if it matches the tree; called while the node still holds
+     * its data
+     * @param node the node that leaves the inorder
+     */
+    void unlinking(Node* node);
+    /**
+     * Charges a patch of the flattened inorder to its budget; once the
+     * patches have moved PATCH_BUDGET times as many entries as it holds,
+     * it is left to be flattened again on the next traversal
+     * @param moved the number of entries the patch moves
+     * @return true if the patch is to be made; otherwise, false
+     */
+    bool patchInorder(size_t moved);
+    /**
+     * Gives the position of a node in the flattened inorder
+     * @param item the data of the node
+     * @return the index of the first node whose data is not below the item
+     */
+    size_t inorderRank(const T& item) const;
+    /**
+     * Gives the nodes of this tree, tombstones included, in an order,
+     * flattening them first if the tree has changed shape since
+     * @param walk the order
+     * @return the sequence of nodes
+     */
+    const vector<const Node*>& sequence(Walk walk) const;
+    /**
+     * Adds to the left subtree counts of the nodes whose left subtree holds
+     * the position of an item, from the root down to the item's node or
+     * empty link; corrects the counts after a descent that changed them
+     * but did not insert or remove
+     * @param item the item
+     * @param delta the amount added
+     */
+    void shift(const T& item, long delta);
+    /**
+     * Descends from the root to the node an ordering points at, or to the
+     * empty link where it belongs, adding to the left subtree counts of the
+     * nodes it passes on their left; shift and BstreeMap, which orders its
+     * entries by their keys alone, both descend with it
+     * @param <Side> a function of type (const T&) -> int
+     * @param side gives where the position lies from the data of a node:
+     * negative for its left subtree, positive for its right, 0 for the node
+     * @param delta the amount added to the left subtree counts; 0 for a
+     * search
+     * @return the link that holds the node, or the empty link
+     */
+    template <typename Side>
+    Node** descend(Side side, long delta);
+    /**
+     * Marks the nodes from the root down to an item's node stale; used
+     * where a node changes without a descent from the root
+     * @param item the item
+     */
+    void touch(const T& item);
+    /**
+     * Recomputes the hashes of the stale nodes, or of every node if the
+     * tree is not hashed
+     */
+    void rehash() const;
+    /**
+     * Mixes the bits of a hash; a bijection, so distinct inputs stay
+     * distinct
+     * @param bits the hash
+     * @return the mixed hash
+     */
+    static uint64_t mix(uint64_t bits);
+    /**
+     * Gives the hash an item adds to the content hash of its subtree
+     * @param item the item
+     * @return the mixed std::hash of the item, offset first so that no
+     * item, not even one whose std::hash is 0, adds 0; or 0 without one
+     */
+    static uint64_t digest(const T& item);
+    /**
+     * Gives the shape hash of a subtree
+     * @param node the root of the subtree, or null
+     * @return the hash kept by the node, or 0 for the empty subtree
+     */
+    static uint64_t shapeOf(const Node* node);
+    /**
+     * Gives the content hash of a subtree
+     * @param node the root of the subtree, or null
+     * @return the hash kept by the node, or 0 for the empty subtree
+     */
+    static uint64_t contentOf(const Node* node);
+    /**
+     * Where the descent of apply_batch found the item of a group: its node,
+     * or the empty link it belongs in
+     */
+    struct Place
+    {
+        Node* node;
+        Node** link;
+        long depth;
+    };
+    /**
+     * A subtree still to be descended by apply_batch with the groups whose
+     * items lie within it, [lo, hi), and the depth of its root
      */
-    void inorderTraverse(Node* node, FuncType apply) const;
+    struct Frame
+    {
+        Node** link;
+        size_t lo, hi;
+        long depth;
+    };
     /**
-     * Removes the specified node from the tree
-     * @param node a pointer to the node to be removed
-     * @return true if the node is removed; otherwise false
+     * A node the descent of apply_batch passed, and the groups, [lo, mid),
+     * it sent into its left subtree
      */
-    bool remove(Node* node);
+    struct Visit
+    {
+        Node* node;
+        size_t lo, mid;
+    };
+    /**
+     * Takes one step of the descent of apply_batch: places the groups of an
+     * empty subtree, or splits them among the children of its root; only
+     * writes the places of its own groups, so frames may be descended on
+     * different threads
+     * @param frame the subtree
+     * @param keys the items of the groups, in increasing order
+     * @param pending receives the child subtrees that hold groups
+     * @param places receives the places of the groups found or placed
+     * @param visited receives the root of the subtree
+     */
+    void locate(const Frame& frame, const vector<const T*>& keys, vector<Frame>& pending, vector<Place>& places,
+        vector<Visit>& visited) const;
+    /**
+     * Merges the longest prefix of a run of ops that leaves the tree as
+     * applying the ops one by one would
+     * @param batch the ops
+     * @param first the position of the first op of the run
+     * @param last the position past the run; the run holds no remove when
+     * the tree is plain
+     * @param outcomes receives what each merged op returned, or null
+     * @return the position past the merged prefix
+     */
+    size_t merge(const vector<Op>& batch, size_t first, size_t last, vector<bool>* outcomes);
+    /**
+     * Sets the left subtree counts of the nodes of a subtree from its shape
+     * @param node the root of the subtree, or null
+     * @return the number of nodes in the subtree
+     */
+    static long recount(Node* node);
+    /**
+     * Refills the hash index from the nodes of this tree
+     */
+    void reindex();
+    /**
+     * Applies the scapegoat policy after an insertion: when the new node is
+     * too deep, the lowest ancestor whose child on the path holds more than
+     * alpha of its nodes is rebuilt
+     * @param path the links to the ancestors of the new node, root first
+     * @param depth the number of ancestors, a prefix of path
+     * @param link the link to the new node
+     */
+    void rebalance(const vector<Node**>& path, size_t depth, Node** link);
+    /**
+     * Removes, in postorder, the nodes whose data satisfies a predicate and
+     * lies within optional bounds; subtrees wholly outside the bounds are
+     * not visited
+     * @param pred the predicate
+     * @param lo the inclusive lower bound, or null
+     * @param hi the exclusive upper bound, or null
+     * @return the number of nodes removed
+     */
+    template <typename Pred>
+    long erase(Pred pred, const T* lo, const T* hi);
+    /**
+     * Rebuilds the subtree held by a link into perfect balance, or into a
+     * given shape, freeing its tombstones; the nodes are relinked, not
+     * reallocated
+     * @param link the parent's link to the subtree, or the root link
+     * @param preorder the inorder ranks of the live nodes in the preorder of
+     * the new shape, or null for perfect balance
+     */
+    void rebuild(Node** link, const vector<size_t>* preorder = nullptr);
+    /**
+     * Gives the number of nodes, tombstones included, of a subtree
+     * @param node the root of a subtree
+     * @return the number of nodes
+     */
+    static long count(const Node* node);
     /**
      * searches for the specified item in this tree
      * @param item the search key
@@ -91,20 +528,20 @@ private:
     /*** BEGIN: AUGMENTED PRIVATE FUNCTIONS ***/
 
     /**
-     * Traverses this tree in preorder
+     * Flattens a subtree in preorder
      * @param node a node of this tree
-     * @param apply a pointer to a function of type (const T&) -> void
-     * that is applied to the data field in the specified node
+     * @param sequence receives the nodes of the subtree, tombstones
+     * included
      */
-    void preorderTraverse(Node* node, FuncType apply) const;
+    void preorderTraverse(Node* node, vector<const Node*>& sequence) const;
 
     /**
-     * Traverses this tree in postorder
+     * Flattens a subtree in postorder
      * @param node a node of this tree
-     * @param apply a pointer to a function of type (const T&) -> void
-     * that is applied to the data field in the specified node
+     * @param sequence receives the nodes of the subtree, tombstones
+     * included
      */
-    void postorderTraverse(Node* node, FuncType apply) const;
+    void postorderTraverse(Node* node, vector<const Node*>& sequence) const;
 
     /**
      * Recursively computes the height of the subtree rooted at the specified Node
@@ -114,23 +551,15 @@ private:
     long height(const Node* node) const;
 
     /**
-     * Recursively determines whether the subtrees rooted at the specified nodes
-     * are isomorphic; that is, the subtrees have the same shape
+     * Determines whether the subtrees rooted at the specified nodes are
+     * isomorphic, that is, have the same shape, from their shape hashes;
+     * the hashes must be up to date
      * @param lft the root of the left subtree
      * @param rgt the root of the right subtree
      * @return true if the subtrees are isomorphic; otherwise, false
      */
     bool isomorphic(const Node* lft, const Node* rgt) const;
 
-    /**
-     * Recursively generates a vector of entries of descendant nodes of
-     * the specied  node
-     * @param desc a vector of entries in the subtree rooted at the
-     * specified node, in pre-order.
-     * @param node the root of a subtree
-     */
-    void descendants(vector<T>& desc, const Node* node) const;
-
     /**
      * Recursively determines whether the subtree rooted at the specified
      * node is left-bias/right-bias or has an ancestor that is
@@ -146,6 +575,15 @@ private:
     /*** END: AUGMENTED PRIVATE FUNCTIONS ***/
 
 public:
+    /**
+     * forward declaration of the Finger class
+     */
+    class Finger;
+    /**
+     * forward declaration of the Relatives class
+     */
+    class Relatives;
+
     /**
      * Constructs an empty binary search tree;
      */
@@ -158,22 +596,87 @@ public:
     Bstree(const Bstree<T>& other);
 
     /**
-     * Move constructor
+     * Move constructor; the other tree is left empty
      * @param other the tree to move
      */
-    Bstree(Bstree<T>&& other);
+    Bstree(Bstree<T>&& other) noexcept;
 
     /**
-     * Returns the binary search tree memory to the system
+     * Returns the binary search tree memory to the system, or hands it to
+     * the reclaimer
      */
     virtual ~Bstree();
 
     /**
-     * copy assignment operator
+     * copy assignment operator: assign, plus the balancing policy of the
+     * other tree
      * @param other the src tree
      */
     Bstree<T>& operator=(const Bstree<T>& other);
 
+    /**
+     * Makes this tree a copy of another, recycling its own nodes: where the
+     * two trees have a node at the same position the data is overwritten
+     * in place, and only the difference in shape is allocated or freed
+     * (freed nodes are reused for the positions that need new ones first).
+     * Refreshing a replica from a primary that changed a little therefore
+     * costs one walk and almost no allocation. If copying an item throws,
+     * this tree is left empty.
+     * @param other the tree to copy
+     */
+    void assign(const Bstree<T>& other);
+
+    /**
+     * move assignment operator; the old contents are let go as the
+     * destructor does and the other tree is left empty
+     * @param other the src tree
+     */
+    Bstree<T>& operator=(Bstree<T>&& other) noexcept;
+
+    /**
+     * Exchanges the contents of two trees, together with their balancing
+     * policies and reclaimers, in O(1); fingers of either tree are
+     * invalidated
+     * @param other the other tree
+     */
+    void swap(Bstree<T>& other) noexcept;
+
+    /**
+     * Removes every item; the nodes are let go as the destructor does
+     */
+    void clear();
+
+    /**
+     * Selects where the nodes this tree lets go of are freed: when the tree
+     * is destroyed, cleared, assigned or opened
+     * @param background the reclaimer whose thread frees them, e.g.
+     * BstreeReclaimer::shared(), or null (the default) to free them before
+     * returning; it must outlive every hand-off
+     */
+    void setReclaimer(BstreeReclaimer* background);
+
+    /**
+     * Turns the hash index from keys to nodes on or off; see the file
+     * comment. Turning it on indexes the present nodes and requires
+     * std::hash<T>.
+     * @param on whether the tree is to be indexed
+     */
+    void setIndexed(bool on);
+
+    /**
+     * Determines whether the tree keeps a hash index
+     * @return true if it does; otherwise, false
+     */
+    bool indexed() const;
+
+    /**
+     * Gives the version of this tree: a count of the mutations applied to
+     * it, so a tree whose version has not moved is unchanged. Copies start
+     * at version 0.
+     * @return the version
+     */
+    unsigned long version() const;
+
     /**
      * Determines whether the binary search tree is empty.
      * @return true if the tree is empty; otherwise, false
@@ -186,6 +689,19 @@ public:
      */
     void insert(T item);
 
+    /**
+     * Inserts an item into the tree, or overwrites the item with the same
+     * key, starting from the position held by a finger instead of the root.
+     * The finger climbs only to the lowest node on its path whose subtree
+     * spans the item, so an item near the previous one costs O(1) plus the
+     * distance between them; a finger from another tree, or one taken
+     * before nodes were removed or rebuilt, starts at the root.
+     * @param finger the position of a previous insertion, or a new finger;
+     * it is moved to the inserted item
+     * @param item the value to be inserted.
+     */
+    void insert(Finger& finger, T item);
+
     /**
      * Determines whether an item is in the tree.
      * @param item item with a specified search key.
@@ -200,6 +716,74 @@ public:
      */
     bool remove(const T& item);
 
+    /**
+     * Deletes every item that satisfies a predicate
+     * @param pred a function of type (const T&) -> bool
+     * @return the number of items deleted
+     */
+    template <typename Pred>
+    long erase_if(Pred pred);
+
+    /**
+     * Applies a run of inserts and removes, leaving the tree as applying
+     * them one by one in order would; see the file comment. Every op whose
+     * item is already there, or whose item falls where no earlier op of
+     * the run put one, costs no descent of its own.
+     * @param batch the ops, in the order they are to take effect
+     * @param outcomes receives, for each op, what remove returns for a
+     * remove and true for an insert, or null
+     */
+    void apply_batch(const vector<Op>& batch, vector<bool>* outcomes = nullptr);
+
+    /**
+     * Deletes every item in the half-open range [lo, hi)
+     * @param lo the smallest item to be deleted
+     * @param hi the bound above the items to be deleted
+     * @return the number of items deleted
+     */
+    long erase(const T& lo, const T& hi);
+
+    /**
+     * Selects the balancing policy
+     * @param factor the scapegoat balance factor alpha, strictly between 0.5
+     * and 1 (smaller is better balanced but rebuilds more often), or 0 for
+     * a plain binary search tree with eager deletes
+     * @throw BstreeException when the factor is out of range
+     */
+    void setScapegoat(double factor);
+
+    /**
+     * Rebuilds the tree into perfect balance and frees its tombstones
+     */
+    void compact();
+
+    /**
+     * Replaces the contents of the tree by a tree of least expected search
+     * cost for the given access frequencies; see BstreeOptimal.h. The exact
+     * optimum is built for up to OPTIMAL_EXACT_LIMIT items and a
+     * weight-balanced tree of near optimal cost beyond.
+     * @param items the items, in increasing order
+     * @param hits hits[k] is the frequency of lookups of items[k]
+     * @param misses misses[g] is the frequency of lookups of missing items
+     * below items[g] and above items[g - 1]; empty when misses are ignored
+     * @throw BstreeException when the items are not increasing or the
+     * frequencies are negative or of the wrong sizes; the tree is then
+     * unchanged
+     */
+    void buildOptimal(const vector<T>& items, const vector<double>& hits, const vector<double>& misses);
+
+    /**
+     * Reshapes the tree for the given access frequencies as buildOptimal
+     * does, relinking its nodes and freeing its tombstones
+     * @param hits hits[k] is the frequency of lookups of the kth item in
+     * inorder
+     * @param misses the frequencies of lookups between the items, as for
+     * buildOptimal, or empty
+     * @throw BstreeException when the frequencies are negative or of the
+     * wrong sizes; the tree is then unchanged
+     */
+    void optimize(const vector<double>& hits, const vector<double>& misses);
+
     /**
      * Returns the item in the tree with the specified
      * key. If the item does not exists, an exception occurs.
@@ -246,7 +830,7 @@ public:
     long height() const;
 
     /**
-     * Generates a vector of ancestors of the specified entry
+     * Generates a vector of ancestors of the specified entry, nearest first
      * @param entry an entry in this tree
      * @return a vector of ancestors of the specified entry
      * @throw BstreeException when the specified entry is not in this tree
@@ -254,34 +838,89 @@ public:
     vector<T> ancestors(T entry) const;
 
     /**
-     * A wrapper function for a function that generates a vector of
-     * entries of nodes that are descendants of the node containing
-     * the specified entry; this function obtains a pointer to the
-     * node containing the entry and calls its corresponding auxiliary
-     * function to generate a vector of entries that are descendants
-     * of the subtree rooted at that node by traversing the subtree
-     * rooted at the node in pre-order.
+     * Generates a vector of the entries of the subtree rooted at the node
+     * containing the specified entry, the entry itself excluded, in
+     * preorder
      * @param entry an entry in this tree
-     * @return a vector of entries that are  descendants of the node
-     * containing the specified entry
-     * @throw BstreeException when the specified entry is not in this tree
+     * @return a vector of descendants of the specified entry, empty when
+     * the entry is not in this tree
      */
     vector<T> descendants(T entry) const;
 
+    /**
+     * Gives the ancestors of the specified entry, nearest first, without
+     * copying them; the range holds only the path to the entry
+     * @param entry an entry in this tree
+     * @return the ancestors, valid until this tree is next modified
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    Relatives ancestor_range(const T& entry) const;
+
+    /**
+     * Gives the descendants of the specified entry in preorder, the entry
+     * itself excluded, without copying them; the subtree is walked as the
+     * range is iterated
+     * @param entry an entry in this tree
+     * @return the descendants, valid until this tree is next modified
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    Relatives descendant_range(const T& entry) const;
+
+    /**
+     * Gives the number of descendants of the specified entry from the left
+     * subtree counts met on the way down to it, without visiting them; a
+     * tree holding tombstones counts its live descendants by walking them
+     * @param entry an entry in this tree
+     * @return the number of nodes in the subtree of the entry, less one
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    long descendant_count(const T& entry) const;
+
     /**
      * Determines whether the left and right subtrees of the root
-     * of this tree are isomorphic
+     * of this tree are isomorphic; O(1) when the tree has not changed
+     * since the last query of its hashes
      * @return true if the right and left subtrees of the root of
      * this tree are isomorphic; otherwise, false. The empty tree
      * and a tree of size 1 are vacously isomorphic
      */
     bool isomorphic() const;
 
+    /**
+     * Determines whether two trees hold the same items, whatever their
+     * shapes; O(1) from the content hashes, recomputed where stale
+     * @param other another tree
+     * @return true if they hold the same items; otherwise, false
+     */
+    bool operator==(const Bstree<T>& other) const;
+
+    /**
+     * Determines whether two trees hold different items
+     * @param other another tree
+     * @return true if they do; otherwise, false
+     */
+    bool operator!=(const Bstree<T>& other) const;
+
+    /**
+     * Gives the items the two trees do not share. Subtrees at the same
+     * position under equal items are paired, and a pair with equal content
+     * hashes is skipped, so replicas of one shape that differ in d items
+     * cost O(d log n); where the shapes part, the paired subtrees are
+     * merged in inorder.
+     * @param other another tree
+     * @param onlyHere receives the items of this tree that the other lacks,
+     * in increasing order
+     * @param onlyThere receives the items of the other tree that this one
+     * lacks, in increasing order
+     */
+    void diff(const Bstree<T>& other, vector<T>& onlyHere, vector<T>& onlyThere) const;
+
     /**
      * Gives a pointer to the parent of the specified entry
      * @param entry an entry of this tree
-     * @return a pointer to the parent data of the specified entry or
-     * null if the specified entry is the root.
+     * @return a pointer to the parent data of the specified entry, or of
+     * its nearest live ancestor when the parent is a tombstone, or null if
+     * the specified entry has no live ancestor
      * @throw BstreeException when this entry is not in this tree
      */
     const T* getParent(T entry) const;
@@ -290,7 +929,7 @@ public:
      * Gives a pointer to the sibling of the specified entry
      * @param entry an entry of this tree
      * @return a pointer to the sibling's data of the specified entry or
-     * null if the specified entry is the root or has no sibling
+     * null if the specified entry is the root or has no live sibling
      * @throw BstreeException when this entry is not in this tree
      */
     const T* getSibling(T entry) const;
@@ -299,7 +938,7 @@ public:
      * Gives a pointer to the left child of the specified entry
      * @param entry an entry in this tree
      * @return a pointer to the left child data of the specified entry
-     * or null if the specified entry does not have a left child
+     * or null if the specified entry does not have a live left child
      * @throw BstreeException when this entry is not in this tree
      */
     const T* leftChild(T entry) const;
@@ -308,7 +947,7 @@ public:
      * Gives a pointer to the right child of the specified entry
      * @param entry an entry in this tree
      * @return a pointer to the right child data of the specified entry
-     * or null if the specified entry does not have a right child
+     * or null if the specified entry does not have a live right child
      * @throw BstreeException when this entry is not in this tree
      */
     const T* rightChild(T entry) const;
@@ -319,6 +958,49 @@ public:
      */
     bool isFibonacci() const;
 
+    /**
+     * Writes this tree to a binary snapshot file; see BstreeSnapshot.h. The
+     * snapshot is written to a temporary file that then replaces the
+     * specified file, so an existing snapshot is never left half-written.
+     * @param filename the name of the snapshot file
+     * @throw BstreeException when the file cannot be written
+     */
+    void save(const string& filename) const;
+
+    /**
+     * Replaces the contents of this tree with a snapshot written by save.
+     * The file is memory-mapped and the tree is rebuilt from its preorder
+     * shape in O(n) without comparing keys, once its CRC has been checked.
+     * @param filename the name of the snapshot file
+     * @throw BstreeException when the file cannot be read, is damaged or
+     * is not a snapshot of a tree of this key type; the tree is then
+     * unchanged
+     */
+    void open(const string& filename);
+
+    /**
+     * Gives the instrumentation counters of this tree
+     * @return the counters, or null when the tree was compiled without
+     * BSTREE_STATS
+     */
+    const BstreeStats* statistics() const;
+
+    /**
+     * Gives the memory this tree holds: the nodes, the storage the items
+     * hold outside them (the characters of long strings), the table of
+     * the hash index, the flattened traversals and the allocator's
+     * overhead, with the peak total.
+     * The figures come from counters kept by the allocation paths, so this
+     * is O(1) and may be polled freely.
+     * @return the report; see BstreeMemory.h
+     */
+    BstreeMemory memory_usage() const;
+
+    /**
+     * Zeroes the instrumentation counters of this tree, if any
+     */
+    void resetStatistics();
+
     /**** END: AUGMENTED PUBLIC FUNCTIONS ***/
 
 };
@@ -344,17 +1026,245 @@ private:
      * a pointer to the right child of this Node
      */
     Node* right;
+    /**
+     * whether the data of this Node has been removed lazily
+     */
+    bool dead;
+    /**
+     * whether the hashes of this Node may be out of date; the ancestors
+     * of a stale Node are stale
+     */
+    bool stale;
+    /**
+     * the number of nodes, tombstones included, in the left subtree of
+     * this Node
+     */
+    long leftSize;
+    /**
+     * the shape hash and the content hash of the subtree of this Node
+     */
+    uint64_t shape, content;
     /**
      * Granting friendship - access to private members of this class to the
      * Bstee<U> class
      */
     friend class Bstree<T>;
+    template <typename K, typename V, typename Compare> friend class BstreeMap;
 public:
     /**
      * Constructs a node with a given data value.
-     * @param item the data to store in this node
+     * @param item the data to store in this node, moved into it
      */
     Node(T item);
 
 };
+
+/**
+ * nested Op struct definition: an insert or a remove, for apply_batch
+ * @param <T> the data type of the binary search tree
+ */
+template <typename T>
+struct Bstree<T>::Op
+{
+    /**
+     * the item to be inserted, or the key of the item to be removed
+     */
+    T item;
+    /**
+     * true for a remove, false for an insert
+     */
+    bool remove;
+};
+
+/**
+ * nested Finger class definition: the path from the root to the last item
+ * inserted through the finger, with the nearest bounding ancestors of each
+ * node on it. A finger must not outlive its tree.
+ * @param <T> the data type of the binary search tree
+ */
+template <typename T>
+class Bstree<T>::Finger
+{
+private:
+    /**
+     * the tree the path belongs to, or null
+     */
+    const Bstree<T>* tree;
+    /**
+     * the reshape count of the tree when the path was recorded
+     */
+    unsigned long reshapes;
+    /**
+     * links[k] is the link to the node at depth k; links[0] is the root link
+     */
+    vector<Node**> links;
+    /**
+     * lower[k] and upper[k] are the depths of the nearest ancestors below
+     * and above every item of the subtree at depth k, or -1 for none
+     */
+    vector<long> lower, upper;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * Bstree<T> class
+     */
+    friend class Bstree<T>;
+public:
+    /**
+     * Constructs a finger that starts at the root of any tree
+     */
+    Finger();
+};
+
+/**
+ * nested Relatives class definition: a range over the ancestors or the
+ * descendants of an entry that yields the entries in place. A range, and
+ * its iterators, must not outlive a modification of its tree.
+ * @param <T> the data type of the binary search tree
+ */
+template <typename T>
+class Bstree<T>::Relatives
+{
+public:
+    /**
+     * forward declaration of the iterator class
+     */
+    class iterator;
+
+private:
+    /**
+     * the nodes the iteration starts from, the first one last
+     */
+    vector<const Node*> start;
+    /**
+     * whether the children of each node are visited after it (descendants)
+     * or not (ancestors)
+     */
+    bool expand;
+    /**
+     * the number of entries in the range
+     */
+    long count;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * Bstree<T> class
+     */
+    friend class Bstree<T>;
+
+    /**
+     * Constructs a range
+     * @param start the nodes the iteration starts from, the first one last
+     * @param expand whether the children of each node are visited after it
+     * @param count the number of entries in the range
+     */
+    Relatives(vector<const Node*> start, bool expand, long count);
+
+public:
+    /**
+     * Gives an iterator at the first entry of the range
+     * @return the iterator
+     */
+    iterator begin() const;
+
+    /**
+     * Gives the iterator past the last entry of the range
+     * @return the iterator
+     */
+    iterator end() const;
+
+    /**
+     * Gives the number of entries in the range; O(1)
+     * @return the number of entries
+     */
+    long size() const;
+
+    /**
+     * Determines whether the range has no entries
+     * @return true if the range is empty; otherwise, false
+     */
+    bool empty() const;
+};
+
+/**
+ * nested iterator class definition of Relatives: a forward iterator whose
+ * pending nodes are kept on an explicit stack, the next one on top
+ * @param <T> the data type of the binary search tree
+ */
+template <typename T>
+class Bstree<T>::Relatives::iterator
+{
+private:
+    /**
+     * the nodes still to be visited, the current one on top
+     */
+    vector<const Node*> pending;
+    /**
+     * whether the children of the current node are visited after it
+     */
+    bool expand;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * Relatives class
+     */
+    friend class Relatives;
+
+    /**
+     * Constructs an iterator
+     * @param pending the nodes to be visited, the first one last
+     * @param expand whether the children of each node are visited after it
+     */
+    iterator(vector<const Node*> pending, bool expand);
+
+    /**
+     * Passes over the tombstones on top of the pending nodes, stacking
+     * their children when children are visited
+     */
+    void skip();
+
+public:
+    typedef forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    /**
+     * Gives the current entry
+     * @return the entry, in place
+     */
+    const T& operator*() const;
+
+    /**
+     * Gives the address of the current entry
+     * @return the address
+     */
+    const T* operator->() const;
+
+    /**
+     * Advances to the next entry
+     * @return this iterator
+     */
+    iterator& operator++();
+
+    /**
+     * Determines whether two iterators of one range are at the same entry
+     * @param other another iterator
+     * @return true if they are; otherwise, false
+     */
+    bool operator==(const iterator& other) const;
+
+    /**
+     * Determines whether two iterators of one range are at different entries
+     * @param other another iterator
+     * @return true if they are; otherwise, false
+     */
+    bool operator!=(const iterator& other) const;
+};
+
+/**
+ * Exchanges the contents of two trees; see Bstree::swap
+ * @param lft a tree
+ * @param rgt another tree
+ */
+template <typename T>
+void swap(Bstree<T>& lft, Bstree<T>& rgt) noexcept;
 #endif //BSTREE_H
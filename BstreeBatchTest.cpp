@@ -0,0 +1,139 @@
+/**
+ * A test of the batched updates of the binary search tree
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeBatchTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Applies runs of inserts and removes with apply_batch and the same runs
+ * op by op to copies of one tree, and checks that both give the same
+ * shape, size, footprint and outcomes: short runs, which apply_batch
+ * applies op by op, long mixed runs full of duplicate items, long runs of
+ * new items, which are descended on several threads, and mixed runs on
+ * scapegoat trees, which are split where the policy rebuilds. Prints each
+ * failed check and exits with the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeBatchTest BstreeBatchTest.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include "Bstree.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * the preorder a traversal has collected
+ */
+static vector<long> preorder;
+
+/**
+ * Collects an item of a preorder traversal
+ * @param item the item
+ */
+void collect(const long& item)
+{
+    preorder.push_back(item);
+}
+
+/**
+ * Gives the preorder of a tree, which determines its shape
+ * @param tree the tree
+ * @return the items in preorder
+ */
+vector<long> preorderOf(const Bstree<long>& tree)
+{
+    preorder.clear();
+    tree.preorderTraverse(collect);
+    return preorder;
+}
+
+/**
+ * Generates a run of ops
+ * @param random the generator
+ * @param length the number of ops
+ * @param keys the number of distinct items the ops draw from
+ * @param removes the percentage of the ops that are removes
+ * @return the run
+ */
+vector<Bstree<long>::Op> generate(mt19937& random, size_t length, long keys, int removes)
+{
+    vector<Bstree<long>::Op> batch(length);
+    for (Bstree<long>::Op& op : batch)
+    {
+        op.item = static_cast<long>(random() % keys);
+        op.remove = static_cast<int>(random() % 100) < removes;
+    }
+    return batch;
+}
+
+/**
+ * Applies a run to a copy of a tree with apply_batch and to another op by
+ * op, and checks that they agree
+ * @param tree the tree before the run
+ * @param batch the run
+ * @param what the description of the run
+ */
+void checkBatch(const Bstree<long>& tree, const vector<Bstree<long>::Op>& batch, const string& what)
+{
+    Bstree<long> batched(tree), stepped(tree);
+    vector<bool> outcomes, expected;
+    batched.apply_batch(batch, &outcomes);
+    for (const Bstree<long>::Op& op : batch)
+        if (op.remove)
+            expected.push_back(stepped.remove(op.item));
+        else
+        {
+            stepped.insert(op.item);
+            expected.push_back(true);
+        }
+    check(batched.size() == stepped.size(), what + ": the sizes agree");
+    check(batched.memory_usage().nodes == stepped.memory_usage().nodes, what + ": the node counts agree");
+    check(preorderOf(batched) == preorderOf(stepped), what + ": the shapes agree");
+    check(outcomes == expected, what + ": the outcomes agree");
+}
+
+int main()
+{
+    mt19937 random(1254);
+    Bstree<long> empty, plain, scapegoat;
+    scapegoat.setScapegoat(0.6);
+    for (long k = 0; k < 50000; k++)
+    {
+        long item = static_cast<long>(random() % 200000);
+        plain.insert(item);
+        scapegoat.insert(item);
+    }
+
+    /* shorter than SHORTEST_MERGE, so applied op by op */
+    checkBatch(plain, generate(random, 1000, 200000, 30), "short mixed run");
+    checkBatch(empty, generate(random, 100, 50, 40), "short run of duplicates");
+
+    /* merged runs; a remove on a plain tree splits them */
+    checkBatch(plain, generate(random, 40000, 200000, 0), "long run of inserts");
+    checkBatch(plain, generate(random, 40000, 200000, 2), "long run with a few removes");
+    checkBatch(empty, generate(random, 40000, 1000, 0), "long run of duplicates");
+    checkBatch(plain, generate(random, 40000, 200000, 100), "long run of removes");
+
+    /* more than PARALLEL_GROUPS distinct new items, descended on threads */
+    checkBatch(empty, generate(random, 100000, 1000000, 0), "threaded run into an empty tree");
+    checkBatch(plain, generate(random, 100000, 1000000, 0), "threaded run");
+
+    /* the scapegoat policy rebuilds within these runs */
+    checkBatch(scapegoat, generate(random, 40000, 200000, 30), "scapegoat mixed run");
+    checkBatch(scapegoat, generate(random, 40000, 2000, 50), "scapegoat run of duplicates");
+    vector<Bstree<long>::Op> ascending(40000);
+    for (size_t k = 0; k < ascending.size(); k++)
+        ascending[k] = { 200000 + static_cast<long>(k), false };
+    checkBatch(scapegoat, ascending, "scapegoat ascending run");
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
@@ -0,0 +1,541 @@
+/**
+ * A benchmark driver for the binary search tree implementation
+ * @author Preston Gautreaux
+ * @see Bstree, BstreeWorkload.h
+ * <pre>
+ * File: BstreeBench.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * For every workload and size, measures the throughput and latency of
+ * insert, lookup, traverse, prop, gen and remove on Bstree<long>, plain,
+ * with the scapegoat policy, and with the scapegoat policy and the hash
+ * index, and on Treap<long>, plus split+merge on the
+ * treap, and of insert, lookup, traverse and remove on std::set<long> as a
+ * baseline.
+ * It also measures refreshing a replica Bstree from a primary, by copy
+ * assignment (which recycles the replica's nodes) and by building a fresh
+ * copy, when the primary is unchanged (same shape) and when a small
+ * fraction of it changed since the last refresh (near shape).
+ * One JSON record is written per measurement.
+ *
+ * Usage: BstreeBench [--sizes=n,n,...] [--max-size=n] [--workloads=w,w,...]
+ *                    [--seed=n] [--degenerate-limit=n] [--json=<file>]
+ * --sizes            : the tree sizes; default 10^3, 10^4, ... up to --max-size
+ * --max-size         : the largest default size; default 10^6, at most 10^8
+ * --workloads        : any of sorted, reverse, random, zipfian, zigzag;
+ *                      default all
+ * --seed             : the seed of the random workloads and probe orders
+ * --degenerate-limit : the largest size at which the plain Bstree runs a
+ *                      workload that makes it degenerate (sorted, reverse,
+ *                      zigzag); each such insert costs O(n); default 20000
+ * --json             : the file the records are written to; default stdout
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeBench BstreeBench.cpp BstreeWorkload.cpp BstreeStats.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <set>
+#include <vector>
+#include <algorithm>
+#include "Bstree.cpp"
+#include "Treap.cpp"
+#include "BstreeWorkload.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+/**
+ * The most operations whose individual latency a measurement records;
+ * longer runs time every k-th operation so that timing stays a small
+ * fraction of the work.
+ */
+const long MAX_LATENCY_SAMPLES = 1 << 18;
+
+/**
+ * The number of entries whose geneology is generated per measurement, and
+ * the smaller number used on degenerate trees, where each costs O(n^2)
+ */
+const long GEN_PROBES = 1000, DEGENERATE_GEN_PROBES = 20;
+
+/**
+ * The balance factor of the scapegoat Bstree runs
+ */
+const double SCAPEGOAT_ALPHA = 0.7;
+
+/**
+ * The number of split+merge pairs timed per treap measurement
+ */
+const long SPLIT_PROBES = 1000;
+
+/**
+ * The number of replica refreshes timed per measurement, and the fraction
+ * of the primary's entries removed or reinserted before each near-shape
+ * refresh
+ */
+const long REFRESH_ROUNDS = 20;
+const double REFRESH_CHURN = 0.001;
+
+/**
+ * The outcome of timing one operation over one tree
+ */
+struct Measurement
+{
+    string container;
+    string workload;
+    string operation;
+    /**
+     * the number of entries the tree was built from
+     */
+    size_t size;
+    /**
+     * the number of items processed (operations, or visited nodes for a
+     * traversal)
+     */
+    long items;
+    /**
+     * the wall time of the whole run
+     */
+    double seconds;
+    /**
+     * the sampled latencies of individual operations in nanoseconds
+     */
+    vector<long> latencies;
+};
+
+/**
+ * Gives a percentile of the sampled latencies of a measurement
+ * @param sorted the latencies in ascending order
+ * @param fraction the percentile as a fraction, e.g. 0.99
+ * @return the latency in nanoseconds, or 0 when nothing was sampled
+ */
+long percentile(const vector<long>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+/**
+ * Times a run of operations, sampling individual latencies
+ * @param measurement receives the timings; its items field gives the
+ * number of operations
+ * @param operation performs the k-th operation when called with k
+ */
+template <typename Operation>
+void timeRun(Measurement& measurement, Operation operation)
+{
+    long stride = max(1L, measurement.items / MAX_LATENCY_SAMPLES);
+    measurement.latencies.reserve(measurement.items / stride + 1);
+    Clock::time_point start = Clock::now();
+    for (long k = 0; k < measurement.items; k++)
+    {
+        if (k % stride == 0)
+        {
+            Clock::time_point before = Clock::now();
+            operation(k);
+            measurement.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - before).count());
+        }
+        else
+            operation(k);
+    }
+    measurement.seconds = chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Times a single operation that processes many items, e.g. a traversal
+ * @param measurement receives the timings; its items field gives the
+ * number of items the operation processes
+ * @param operation the operation
+ */
+template <typename Operation>
+void timeOnce(Measurement& measurement, Operation operation)
+{
+    Clock::time_point start = Clock::now();
+    operation();
+    Clock::duration elapsed = Clock::now() - start;
+    measurement.seconds = chrono::duration<double>(elapsed).count();
+    measurement.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+}
+
+/**
+ * Formats a measurement as a JSON object
+ * @param m a measurement
+ * @return the JSON text
+ */
+string toJson(Measurement& m)
+{
+    sort(m.latencies.begin(), m.latencies.end());
+    ostringstream json;
+    json << "{\"container\": \"" << m.container << "\", \"workload\": \"" << m.workload
+        << "\", \"size\": " << m.size << ", \"operation\": \"" << m.operation
+        << "\", \"items\": " << m.items << ", \"seconds\": " << m.seconds
+        << ", \"items_per_second\": " << (m.seconds > 0 ? m.items / m.seconds : 0)
+        << ", \"latency_samples\": " << m.latencies.size()
+        << ", \"p50_ns\": " << percentile(m.latencies, 0.50)
+        << ", \"p99_ns\": " << percentile(m.latencies, 0.99)
+        << ", \"p999_ns\": " << percentile(m.latencies, 0.999)
+        << ", \"max_ns\": " << (m.latencies.empty() ? 0 : m.latencies.back()) << "}";
+    return json.str();
+}
+
+/**
+ * Keeps the optimizer from discarding the results of the timed operations
+ */
+static volatile long sink = 0;
+
+/**
+ * A traversal callback that touches every entry
+ * @param entry an entry of the tree
+ */
+void touch(const long& entry)
+{
+    sink = sink + entry;
+}
+
+/**
+ * Fills an empty tree from a key stream and measures every operation of the
+ * Bstree interface on it
+ * @param results receives the measurements
+ * @param container the name of the tree implementation
+ * @param workload the name of the workload
+ * @param keys the key stream, in insertion order
+ * @param probes the distinct keys in a random order
+ * @param degenerate whether the stream makes the tree degenerate
+ * @param tree the empty tree; a Bstree<long> or a Treap<long>
+ */
+template <typename Tree>
+void benchTree(vector<Measurement>& results, const string& container, const string& workload,
+    const vector<long>& keys, const vector<long>& probes, bool degenerate, Tree& tree)
+{
+    Measurement base;
+    base.container = container;
+    base.workload = workload;
+    base.size = keys.size();
+
+    Measurement m = base;
+    m.operation = "insert";
+    m.items = keys.size();
+    timeRun(m, [&](long k) { tree.insert(keys[k]); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "lookup";
+    m.items = probes.size();
+    timeRun(m, [&](long k) { sink = sink + tree.inTree(probes[k]); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "traverse";
+    m.items = tree.size();
+    timeOnce(m, [&]() { tree.inorderTraverse(touch); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "prop";
+    m.items = 1;
+    timeOnce(m, [&]() { sink = sink + tree.height() + tree.isomorphic() + tree.isFibonacci(); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "gen";
+    m.items = min<long>(probes.size(), degenerate ? DEGENERATE_GEN_PROBES : GEN_PROBES);
+    timeRun(m, [&](long k)
+    {
+        const long& entry = probes[k];
+        const long* relative;
+        relative = tree.getParent(entry);
+        relative = tree.getSibling(entry);
+        relative = tree.leftChild(entry);
+        relative = tree.rightChild(entry);
+        sink = sink + (relative != nullptr) + tree.ancestors(entry).size() + tree.descendants(entry).size();
+    });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "remove";
+    m.items = probes.size();
+    timeRun(m, [&](long k) { tree.remove(probes[k]); });
+    results.push_back(m);
+}
+
+/**
+ * Builds a Bstree from a key stream and measures every operation on it
+ * @param results receives the measurements
+ * @param workload the name of the workload
+ * @param keys the key stream, in insertion order
+ * @param probes the distinct keys in a random order
+ * @param degenerate whether the stream makes the tree degenerate
+ * @param alpha the scapegoat balance factor, or 0 for a plain tree
+ * @param indexed whether the tree keeps its hash index
+ */
+void benchBstree(vector<Measurement>& results, const string& workload, const vector<long>& keys,
+    const vector<long>& probes, bool degenerate, double alpha, bool indexed)
+{
+    Bstree<long> tree;
+    tree.setScapegoat(alpha);
+    tree.setIndexed(indexed);
+    string container = alpha > 0 ? "Bstree/scapegoat" : "Bstree";
+    if (indexed)
+        container += "/indexed";
+    benchTree(results, container, workload, keys, probes, degenerate, tree);
+}
+
+/**
+ * Builds a Treap from a key stream and measures every operation on it, and
+ * splitting it at a probe and merging the halves back
+ * @param results receives the measurements
+ * @param workload the name of the workload
+ * @param keys the key stream, in insertion order
+ * @param probes the distinct keys in a random order
+ * @param seed the seed of the treap priorities
+ */
+void benchTreap(vector<Measurement>& results, const string& workload, const vector<long>& keys,
+    const vector<long>& probes, uint64_t seed)
+{
+    Treap<long> tree(seed);
+    benchTree(results, "Treap", workload, keys, probes, false, tree);
+
+    for (long key : keys)
+        tree.insert(key);
+    Measurement m;
+    m.container = "Treap";
+    m.workload = workload;
+    m.size = keys.size();
+    m.operation = "split+merge";
+    m.items = min<long>(probes.size(), SPLIT_PROBES);
+    timeRun(m, [&](long k)
+    {
+        Treap<long> upper = tree.split(probes[k]);
+        sink = sink + upper.size();
+        tree.merge(upper);
+    });
+    results.push_back(m);
+}
+
+/**
+ * Measures refreshing a replica from a primary Bstree, by copy assignment
+ * and by a fresh copy, with and without changes to the primary in between
+ * @param results receives the measurements
+ * @param workload the name of the workload
+ * @param keys the key stream, in insertion order
+ * @param probes the distinct keys in a random order
+ */
+void benchRefresh(vector<Measurement>& results, const string& workload, const vector<long>& keys,
+    const vector<long>& probes)
+{
+    Bstree<long> primary;
+    for (long key : keys)
+        primary.insert(key);
+    long churn = max(1L, static_cast<long>(probes.size() * REFRESH_CHURN));
+    const char* const operations[4] = { "refresh-same/assign", "refresh-same/copy",
+        "refresh-near/assign", "refresh-near/copy" };
+    for (int op = 0; op < 4; op++)
+    {
+        bool near = op >= 2, recycle = op % 2 == 0;
+        Bstree<long> replica(primary);
+        Measurement m;
+        m.container = "Bstree";
+        m.workload = workload;
+        m.size = keys.size();
+        m.operation = operations[op];
+        m.items = REFRESH_ROUNDS;
+        m.seconds = 0;
+        for (long round = 0; round < REFRESH_ROUNDS; round++)
+        {
+            /* untimed: remove a window of entries, and put back the window
+               removed in the previous round */
+            if (near)
+            {
+                for (long k = 0; k < churn; k++)
+                {
+                    primary.remove(probes[(round * churn + k) % probes.size()]);
+                    if (round > 0)
+                        primary.insert(probes[((round - 1) * churn + k) % probes.size()]);
+                }
+            }
+            Clock::time_point start = Clock::now();
+            if (recycle)
+                replica = primary;
+            else
+                replica = Bstree<long>(primary);
+            Clock::duration elapsed = Clock::now() - start;
+            m.seconds += chrono::duration<double>(elapsed).count();
+            m.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+            sink = sink + replica.size();
+        }
+        if (near)
+            for (long k = 0; k < churn; k++)
+                primary.insert(probes[((REFRESH_ROUNDS - 1) * churn + k) % probes.size()]);
+        results.push_back(m);
+    }
+}
+
+/**
+ * Builds a std::set from a key stream and measures the operations it shares
+ * with Bstree
+ * @param results receives the measurements
+ * @param workload the name of the workload
+ * @param keys the key stream, in insertion order
+ * @param probes the distinct keys in a random order
+ */
+void benchStdSet(vector<Measurement>& results, const string& workload, const vector<long>& keys,
+    const vector<long>& probes)
+{
+    Measurement base;
+    base.container = "std::set";
+    base.workload = workload;
+    base.size = keys.size();
+    set<long> tree;
+
+    Measurement m = base;
+    m.operation = "insert";
+    m.items = keys.size();
+    timeRun(m, [&](long k) { tree.insert(keys[k]); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "lookup";
+    m.items = probes.size();
+    timeRun(m, [&](long k) { sink = sink + tree.count(probes[k]); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "traverse";
+    m.items = tree.size();
+    timeOnce(m, [&]() { for (const long& entry : tree) touch(entry); });
+    results.push_back(m);
+
+    m = base;
+    m.operation = "remove";
+    m.items = probes.size();
+    timeRun(m, [&](long k) { tree.erase(probes[k]); });
+    results.push_back(m);
+}
+
+/**
+ * Splits a comma separated list
+ * @param list the list
+ * @return its items
+ */
+vector<string> splitList(const string& list)
+{
+    vector<string> items;
+    stringstream in(list);
+    string item;
+    while (getline(in, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+int main(int argc, char** argv)
+{
+    vector<size_t> sizes;
+    size_t maxSize = 1000000;
+    vector<Workload> workloads;
+    uint64_t seed = 1254;
+    size_t degenerateLimit = 20000;
+    string jsonFile;
+    for (int k = 1; k < argc; k++)
+    {
+        string arg = argv[k];
+        size_t eq = arg.find('=');
+        string name = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--sizes")
+        {
+            for (const string& item : splitList(value))
+                sizes.push_back(strtoull(item.c_str(), nullptr, 10));
+        }
+        else if (name == "--max-size")
+            maxSize = min<size_t>(strtoull(value.c_str(), nullptr, 10), 100000000);
+        else if (name == "--workloads")
+        {
+            for (const string& item : splitList(value))
+            {
+                Workload workload;
+                if (!parseWorkload(item, workload))
+                {
+                    cerr << "Unknown workload " << item << endl;
+                    exit(1);
+                }
+                workloads.push_back(workload);
+            }
+        }
+        else if (name == "--seed")
+            seed = strtoull(value.c_str(), nullptr, 10);
+        else if (name == "--degenerate-limit")
+            degenerateLimit = strtoull(value.c_str(), nullptr, 10);
+        else if (name == "--json")
+            jsonFile = value;
+        else
+        {
+            cerr << "Usage: BstreeBench [--sizes=n,n,...] [--max-size=n] [--workloads=w,w,...] "
+                << "[--seed=n] [--degenerate-limit=n] [--json=<file>]" << endl;
+            exit(1);
+        }
+    }
+    if (sizes.empty())
+        for (size_t size = 1000; size <= maxSize; size *= 10)
+            sizes.push_back(size);
+    if (workloads.empty())
+        workloads.assign(begin(ALL_WORKLOADS), end(ALL_WORKLOADS));
+
+    vector<Measurement> results;
+    for (Workload workload : workloads)
+    {
+        for (size_t size : sizes)
+        {
+            vector<long> keys = generateKeys(workload, size, seed);
+            vector<long> probes = keys;
+            sort(probes.begin(), probes.end());
+            probes.erase(unique(probes.begin(), probes.end()), probes.end());
+            shuffleKeys(probes, seed + 1);
+
+            size_t first = results.size();
+            if (isDegenerate(workload) && size > degenerateLimit)
+                cerr << "skipping Bstree/" << workloadName(workload) << "/" << size
+                    << ": above --degenerate-limit" << endl;
+            else
+            {
+                benchBstree(results, workloadName(workload), keys, probes, isDegenerate(workload), 0, false);
+                benchRefresh(results, workloadName(workload), keys, probes);
+            }
+            benchBstree(results, workloadName(workload), keys, probes, false, SCAPEGOAT_ALPHA, false);
+            benchBstree(results, workloadName(workload), keys, probes, false, SCAPEGOAT_ALPHA, true);
+            benchTreap(results, workloadName(workload), keys, probes, seed);
+            benchStdSet(results, workloadName(workload), keys, probes);
+            for (size_t r = first; r < results.size(); r++)
+            {
+                const Measurement& m = results[r];
+                cerr << m.container << "/" << m.workload << "/" << m.size << "/" << m.operation << ": "
+                    << (m.seconds > 0 ? m.items / m.seconds : 0) << " items/s" << endl;
+            }
+        }
+    }
+
+    ofstream file;
+    if (!jsonFile.empty())
+    {
+        file.open(jsonFile.c_str(), ios::out | ios::trunc);
+        if (!file)
+        {
+            cerr << "Unable to open " << jsonFile << " for output." << endl;
+            exit(2);
+        }
+    }
+    ostream& out = jsonFile.empty() ? cout : file;
+    out << "{\"benchmark\": \"BstreeBench\", \"seed\": " << seed << ", \"results\": [" << endl;
+    for (size_t r = 0; r < results.size(); r++)
+        out << "  " << toJson(results[r]) << (r + 1 < results.size() ? "," : "") << endl;
+    out << "]}" << endl;
+    return 0;
+}
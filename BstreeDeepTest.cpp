@@ -0,0 +1,153 @@
+/**
+ * A test of the binary search trees on degenerate chains
+ * @author Preston Gautreaux
+ * @see Bstree, ArtBstree
+ * <pre>
+ * File: BstreeDeepTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Builds ascending and descending chains (every node has one child) of
+ * 10^7 nodes, and of 10^6 nodes for ArtBstree, then copies, assigns,
+ * traverses, measures and destroys them. None of these may recurse once
+ * per level, so the test runs to the end under the default stack only if
+ * every walk is iterative; a recursive one overflows the stack at about
+ * 10^5 levels. The ascending chains are inserted through a Finger; the
+ * descending one is opened from a snapshot written in preorder, since
+ * inserting it would raise the rank of every ancestor and take O(n^2).
+ * Prints each failed check and exits with the number of failures.
+ *
+ * Usage: BstreeDeepTest [n] : n is the length of the Bstree chains;
+ *                             default 10^7
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeDeepTest BstreeDeepTest.cpp ArtBstree.cpp BstreeStats.cpp BstreeOptimal.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+#include "Bstree.cpp"
+#include "ArtBstree.h"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * The number of items the traversals have visited
+ */
+static long visits = 0;
+
+/**
+ * Counts a visited item of a Bstree<int>
+ * @param item the item
+ */
+void visitInt(const int&)
+{
+    visits++;
+}
+
+/**
+ * Counts a visited item of an ArtBstree
+ * @param item the item
+ */
+void visitString(const string&)
+{
+    visits++;
+}
+
+/**
+ * Fills a tree with a descending chain: n, n - 1, ..., 1, each the left
+ * child of the one before
+ * @param chain the tree
+ * @param n the length of the chain
+ * @param filename the name of the snapshot the chain is opened from
+ */
+void descend(Bstree<int>& chain, long n, const string& filename)
+{
+    vector<int> keys(n);
+    vector<const int*> preorder(n);
+    vector<unsigned char> shape(n, 1);
+    for (long k = 0; k < n; k++)
+    {
+        keys[k] = static_cast<int>(n - k);
+        preorder[k] = &keys[k];
+    }
+    if (n > 0)
+        shape[n - 1] = 0;
+    writeSnapshot(filename, preorder, shape);
+    chain.open(filename);
+    remove(filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 10000000;
+    char name[] = "/tmp/BstreeDeepTest.XXXXXX";
+    int file = mkstemp(name);
+    if (file < 0)
+    {
+        cout << "FAILED: unable to create a temporary file" << endl;
+        return 1;
+    }
+    close(file);
+    for (int descending = 0; descending < 2; descending++)
+    {
+        string what = descending ? "descending chain" : "ascending chain";
+        int first = descending ? static_cast<int>(n) : 0;
+        int last = descending ? 1 : static_cast<int>(n - 1);
+        Bstree<int> chain;
+        if (descending)
+            descend(chain, n, name);
+        else
+        {
+            Bstree<int>::Finger finger;
+            for (long k = 0; k < n; k++)
+                chain.insert(finger, static_cast<int>(k));
+        }
+        check(chain.size() == n, what + ": size");
+        check(chain.height() == n - 1, what + ": height");
+        visits = 0;
+        chain.preorderTraverse(visitInt);
+        chain.inorderTraverse(visitInt);
+        chain.postorderTraverse(visitInt);
+        check(visits == 3 * n, what + ": the traversals visit every item");
+        check(!chain.isomorphic() || n <= 1, what + ": isomorphic");
+        check(!chain.isFibonacci() || n <= 2, what + ": isFibonacci");
+        check(chain.descendant_count(first) == n - 1, what + ": the root has every other item below it");
+        check(chain.descendant_count(last) == 0, what + ": the leaf has no descendants");
+        {
+            Bstree<int> copy(chain);
+            check(copy.size() == n && copy.height() == n - 1, what + ": copy");
+            Bstree<int> assigned;
+            assigned = copy;
+            check(assigned == chain, what + ": assignment");
+            /* the copies are destroyed here */
+        }
+        chain.clear();
+        check(chain.empty(), what + ": clear");
+    }
+
+    long m = n / 10;
+    {
+        ArtBstree chain;
+        ArtBstree::Finger finger;
+        for (long k = 0; k < m; k++)
+            chain.insert(finger, to_string(1000000000 + k));
+        check(chain.height() == m - 1, "ArtBstree chain: height");
+        visits = 0;
+        chain.preorderTraverse(visitString);
+        chain.inorderTraverse(visitString);
+        chain.postorderTraverse(visitString);
+        check(visits == 3 * m, "ArtBstree chain: the traversals visit every item");
+        check(!chain.isFibonacci() || m <= 2, "ArtBstree chain: isFibonacci");
+        chain.isomorphic();
+        /* the chain is destroyed here */
+    }
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
@@ -0,0 +1,184 @@
+/**
+ * A test of the genealogy functions of the binary search tree
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeGenealogyTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Inserts the same items into a Bstree and into a plain reference tree
+ * built here, and checks for every entry that descendants() lists its
+ * subtree in preorder, the entry itself excluded, as the gen statement of
+ * BstreeParser prints it; that descendant_count and the ranges agree; and
+ * that ancestors() lists the path to the entry, nearest first. The months
+ * of months.bst are checked against their known shape. Prints each failed
+ * check and exits with the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeGenealogyTest BstreeGenealogyTest.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include "Bstree.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * A node of the reference tree
+ */
+struct Reference
+{
+    /**
+     * the item of the node
+     */
+    long item;
+    /**
+     * the left and right subtrees, or null
+     */
+    Reference* left;
+    Reference* right;
+};
+
+/**
+ * Inserts an item into the reference tree
+ * @param link the link the item descends from
+ * @param item the item
+ */
+void insert(Reference*& link, long item)
+{
+    if (!link)
+        link = new Reference{ item, nullptr, nullptr };
+    else if (item < link->item)
+        insert(link->left, item);
+    else if (item > link->item)
+        insert(link->right, item);
+}
+
+/**
+ * Lists a subtree of the reference tree in preorder
+ * @param node the root of the subtree
+ * @param items receives the items
+ */
+void preorder(const Reference* node, vector<long>& items)
+{
+    if (!node)
+        return;
+    items.push_back(node->item);
+    preorder(node->left, items);
+    preorder(node->right, items);
+}
+
+/**
+ * Frees the reference tree
+ * @param node the root of the tree
+ */
+void destroy(Reference* node)
+{
+    if (!node)
+        return;
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+/**
+ * Checks the genealogy of every entry of a tree against the reference
+ * tree of the same items
+ * @param tree the tree
+ * @param root the root of the reference tree
+ * @param what the description of the tree
+ */
+void checkGenealogy(const Bstree<long>& tree, const Reference* root, const string& what)
+{
+    bool listed = true, counted = true, ranged = true, traced = true;
+    vector<const Reference*> path, pending;
+    vector<size_t> depths;
+    if (root)
+    {
+        pending.push_back(root);
+        depths.push_back(0);
+    }
+    while (!pending.empty())
+    {
+        const Reference* node = pending.back();
+        size_t depth = depths.back();
+        pending.pop_back();
+        depths.pop_back();
+        path.resize(depth);
+        vector<long> expected;
+        preorder(node, expected);
+        expected.erase(expected.begin());
+        vector<long> below = tree.descendants(node->item);
+        listed = listed && below == expected;
+        counted = counted && tree.descendant_count(node->item) == static_cast<long>(expected.size());
+        vector<long> range;
+        for (long item : tree.descendant_range(node->item))
+            range.push_back(item);
+        ranged = ranged && range == expected;
+        vector<long> above = tree.ancestors(node->item);
+        bool nearestFirst = above.size() == path.size();
+        for (size_t k = 0; nearestFirst && k < above.size(); k++)
+            nearestFirst = above[k] == path[path.size() - 1 - k]->item;
+        traced = traced && nearestFirst;
+        path.push_back(node);
+        if (node->right)
+        {
+            pending.push_back(node->right);
+            depths.push_back(depth + 1);
+        }
+        if (node->left)
+        {
+            pending.push_back(node->left);
+            depths.push_back(depth + 1);
+        }
+    }
+    check(listed, what + ": descendants lists each subtree in preorder");
+    check(counted, what + ": descendant_count counts each subtree");
+    check(ranged, what + ": descendant_range iterates each subtree in preorder");
+    check(traced, what + ": ancestors lists each path, nearest first");
+    check(tree.descendants(-1).empty(), what + ": a missing entry has no descendants");
+}
+
+int main()
+{
+    /* the months in the order of months.bst, whose tree is
+                       JANUARY
+              FEBRUARY          MARCH
+          APRIL              JUNE     MAY
+            AUGUST         JULY         SEPTEMBER
+              DECEMBER               OCTOBER
+                                  NOVEMBER */
+    Bstree<string> months;
+    for (const char* month : { "JANUARY", "FEBRUARY", "MARCH", "APRIL", "MAY", "JUNE", "JULY", "AUGUST",
+        "SEPTEMBER", "OCTOBER", "NOVEMBER", "DECEMBER" })
+        months.insert(month);
+    check(months.descendants("FEBRUARY") == vector<string>({ "APRIL", "AUGUST", "DECEMBER" }),
+        "months: gen FEBRUARY lists the chain below it");
+    check(months.descendants("MARCH") == vector<string>({ "JUNE", "JULY", "MAY", "SEPTEMBER", "OCTOBER",
+        "NOVEMBER" }), "months: gen MARCH lists both subtrees, left first");
+    check(months.descendants("NOVEMBER").empty(), "months: a leaf has no descendants");
+
+    mt19937 random(1254);
+    for (int round = 0; round < 50; round++)
+    {
+        Bstree<long> tree;
+        Reference* root = nullptr;
+        for (int k = 0; k < 200; k++)
+        {
+            long item = static_cast<long>(random() % 1000);
+            tree.insert(item);
+            insert(root, item);
+        }
+        checkGenealogy(tree, root, "random round " + to_string(round));
+        destroy(root);
+    }
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
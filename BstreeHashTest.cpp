@@ -0,0 +1,188 @@
+/**
+ * A test of the subtree hashes of the binary search tree
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeHashTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Checks operator== and diff() against the items the trees hold, in
+ * particular for items whose std::hash is 0 (the long 0 and the double
+ * 0.0), which must still change the content hash of every subtree above
+ * them. Then checks that the shape queries of a scapegoat tree pass over
+ * its tombstones and leave them in place. Prints each failed check and
+ * exits with the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeHashTest BstreeHashTest.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <random>
+#include "Bstree.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * Checks diff() and operator== of two trees against the sets of their items
+ * @param <T> the type of the items
+ * @param mine the first tree
+ * @param here the items of the first tree
+ * @param theirs the second tree
+ * @param there the items of the second tree
+ * @param what the description of the trees
+ */
+template <typename T>
+void checkDiff(const Bstree<T>& mine, const set<T>& here, const Bstree<T>& theirs, const set<T>& there,
+    const string& what)
+{
+    vector<T> onlyHere, onlyThere, expectHere, expectThere;
+    set_difference(here.begin(), here.end(), there.begin(), there.end(), back_inserter(expectHere));
+    set_difference(there.begin(), there.end(), here.begin(), here.end(), back_inserter(expectThere));
+    mine.diff(theirs, onlyHere, onlyThere);
+    check(onlyHere == expectHere, what + ": diff lists the items only in the first tree");
+    check(onlyThere == expectThere, what + ": diff lists the items only in the second tree");
+    check((mine == theirs) == (here == there), what + ": operator== agrees with the items");
+}
+
+/**
+ * Inserts an item into a tree and into the set of its items
+ * @param <T> the type of the items
+ * @param tree the tree
+ * @param items the items of the tree
+ * @param item the item to be inserted
+ */
+template <typename T>
+void insert(Bstree<T>& tree, set<T>& items, const T& item)
+{
+    tree.insert(item);
+    items.insert(item);
+}
+
+/**
+ * The items a traversal has visited
+ */
+static vector<long> visited;
+
+/**
+ * Records an item visited by a traversal
+ * @param item the item
+ */
+void visit(const long& item)
+{
+    visited.push_back(item);
+}
+
+/**
+ * Checks the traversals and genealogy of a scapegoat tree holding
+ * tombstones against the items it holds, and that none of them rebuilt it
+ * @param tree the tree
+ * @param items the items of the tree
+ * @param what the description of the tree
+ */
+void checkTombstones(const Bstree<long>& tree, const set<long>& items, const string& what)
+{
+    long nodes = tree.memory_usage().nodes;
+    vector<long> sorted(items.begin(), items.end());
+    visited.clear();
+    tree.preorderTraverse(visit);
+    sort(visited.begin(), visited.end());
+    check(visited == sorted, what + ": preorderTraverse visits the live items only");
+    visited.clear();
+    tree.postorderTraverse(visit);
+    sort(visited.begin(), visited.end());
+    check(visited == sorted, what + ": postorderTraverse visits the live items only");
+    bool live = true, counted = true, related = true;
+    for (long item : items)
+    {
+        vector<long> below = tree.descendants(item);
+        vector<long> above = tree.ancestors(item);
+        counted = counted && tree.descendant_count(item) == static_cast<long>(below.size());
+        for (long other : below)
+            live = live && items.count(other);
+        for (long other : above)
+            live = live && items.count(other);
+        const long* parent = tree.getParent(item);
+        related = related && (above.empty() ? !parent : parent && *parent == above.front());
+        for (const long* other : { tree.leftChild(item), tree.rightChild(item), tree.getSibling(item) })
+            live = live && (!other || items.count(*other));
+    }
+    check(live, what + ": the genealogy reports live items only");
+    check(counted, what + ": descendant_count counts the live descendants");
+    check(related, what + ": getParent is the nearest of the ancestors");
+    tree.height();
+    tree.isomorphic();
+    tree.isFibonacci();
+    check(tree.memory_usage().nodes == nodes, what + ": the queries leave the tombstones in place");
+}
+
+int main()
+{
+    /* trees that differ only by an item whose std::hash is 0 */
+    Bstree<long> longs, longsAndZero;
+    set<long> longItems, longAndZeroItems;
+    for (long item : { 5L, 2L, 8L })
+    {
+        insert(longs, longItems, item);
+        insert(longsAndZero, longAndZeroItems, item);
+    }
+    insert(longsAndZero, longAndZeroItems, 0L);
+    checkDiff(longs, longItems, longsAndZero, longAndZeroItems, "long 0");
+    checkDiff(longsAndZero, longAndZeroItems, longs, longItems, "long 0, reversed");
+
+    Bstree<double> doubles, doublesAndZero;
+    set<double> doubleItems, doubleAndZeroItems;
+    for (double item : { 5.5, -2.5, 8.0 })
+    {
+        insert(doubles, doubleItems, item);
+        insert(doublesAndZero, doubleAndZeroItems, item);
+    }
+    insert(doublesAndZero, doubleAndZeroItems, 0.0);
+    checkDiff(doubles, doubleItems, doublesAndZero, doubleAndZeroItems, "double 0.0");
+
+    /* one zero swapped for another item: equal sizes, so operator== rests
+       on the hashes */
+    Bstree<long> swapped(longsAndZero);
+    set<long> swappedItems(longAndZeroItems);
+    swapped.remove(0L);
+    swappedItems.erase(0L);
+    insert(swapped, swappedItems, 7L);
+    checkDiff(longsAndZero, longAndZeroItems, swapped, swappedItems, "0 swapped for 7");
+
+    /* random trees, plain and with lazy deletes, sharing most subtrees */
+    mt19937 random(1254);
+    for (int round = 0; round < 200; round++)
+    {
+        Bstree<long> mine, theirs;
+        set<long> here, there;
+        if (round % 2)
+            theirs.setScapegoat(0.7);
+        for (int k = 0; k < 300; k++)
+        {
+            long item = random() % 400;
+            insert(mine, here, item);
+            insert(theirs, there, item);
+        }
+        for (int k = 0; k < 5; k++)
+        {
+            insert(mine, here, static_cast<long>(random() % 400));
+            long item = random() % 400;
+            theirs.remove(item);
+            there.erase(item);
+        }
+        checkDiff(mine, here, theirs, there, "random round " + to_string(round));
+        if (round % 2 && theirs.memory_usage().nodes > theirs.size())
+            checkTombstones(theirs, there, "tombstones round " + to_string(round));
+    }
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
@@ -0,0 +1,130 @@
+/**
+ * Implementation file for functions of the BstreeIndex<T, V> class
+ * @author Preston Gautreaux
+ * @see BstreeIndex.h
+ * <pre>
+ * File: BstreeIndex.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "BstreeIndex.h"
+#include <vector>
+
+template <typename T, typename V>
+BstreeIndex<T, V>::BstreeIndex(Hasher hasher, Equal equal)
+{
+    count = 0;
+    shift = 64;
+    this->hasher = hasher;
+    this->equal = equal;
+}
+
+template <typename T, typename V>
+size_t BstreeIndex<T, V>::home(size_t hash) const
+{
+    return (static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift;
+}
+
+template <typename T, typename V>
+size_t BstreeIndex<T, V>::probe(const T& key, size_t hash) const
+{
+    size_t mask = slots.size() - 1;
+    size_t k = home(hash);
+    while (slots[k].key && !(slots[k].hash == hash && equal(*slots[k].key, key)))
+        k = (k + 1) & mask;
+    return k;
+}
+
+template <typename T, typename V>
+void BstreeIndex<T, V>::grow()
+{
+    vector<Slot> old(slots.empty() ? 16 : slots.size() * 2, Slot{ 0, nullptr, nullptr });
+    old.swap(slots);
+    shift = old.empty() ? 60 : shift - 1;
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : old)
+    {
+        if (!slot.key)
+            continue;
+        size_t k = home(slot.hash);
+        while (slots[k].key)
+            k = (k + 1) & mask;
+        slots[k] = slot;
+    }
+}
+
+template <typename T, typename V>
+V BstreeIndex<T, V>::find(const T& key) const
+{
+    if (count == 0)
+        return nullptr;
+    return slots[probe(key, hasher(key))].value;
+}
+
+template <typename T, typename V>
+void BstreeIndex<T, V>::insert(const T& key, V value)
+{
+    if ((count + 1) * 10 > slots.size() * 7)
+        grow();
+    size_t hash = hasher(key);
+    Slot& slot = slots[probe(key, hash)];
+    if (!slot.key)
+        count++;
+    slot = Slot{ hash, &key, value };
+}
+
+template <typename T, typename V>
+bool BstreeIndex<T, V>::erase(const T& key)
+{
+    if (count == 0)
+        return false;
+    size_t mask = slots.size() - 1;
+    size_t hole = probe(key, hasher(key));
+    if (!slots[hole].key)
+        return false;
+    count--;
+    /* shift back every later key of the run that may sit in the hole: one
+       whose home slot is not cyclically between the hole and its own slot */
+    for (size_t k = (hole + 1) & mask; slots[k].key; k = (k + 1) & mask)
+    {
+        size_t start = home(slots[k].hash);
+        if (((k - start) & mask) >= ((k - hole) & mask))
+        {
+            slots[hole] = slots[k];
+            hole = k;
+        }
+    }
+    slots[hole] = Slot{ 0, nullptr, nullptr };
+    return true;
+}
+
+template <typename T, typename V>
+void BstreeIndex<T, V>::clear()
+{
+    for (Slot& slot : slots)
+        slot = Slot{ 0, nullptr, nullptr };
+    count = 0;
+}
+
+template <typename T, typename V>
+size_t BstreeIndex<T, V>::size() const
+{
+    return count;
+}
+
+template <typename T, typename V>
+size_t BstreeIndex<T, V>::bytes() const
+{
+    return slots.capacity() * sizeof(Slot);
+}
+
+template <typename T, typename V>
+BstreeIndex<T, V>* BstreeIndex<T, V>::emptyCopy() const
+{
+    return new BstreeIndex<T, V>(hasher, equal);
+}
@@ -0,0 +1,154 @@
+/**
+ * The specification for a hash index from keys to the places that hold them.
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeIndex.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * An open-addressing table with linear probing. The keys are not copied:
+ * a slot refers to a key that lives elsewhere, in a tree node, and keeps
+ * its hash so that probing compares hashes before keys and growing never
+ * hashes a key again. The capacity is a power of two and the table grows
+ * at 70% load. A slot's home is taken from the high bits of the hash times
+ * 2^64 / golden ratio (Fibonacci hashing), since std::hash of an integer
+ * is the integer itself and dense keys would otherwise fill one long run.
+ * A removal shifts the rest of its probe run back instead of leaving a
+ * tombstone, so lookups never slow down with churn. The hash function and
+ * the equality test are plain function pointers, given at construction, so
+ * a tree only needs them for its keys when it asks for an index.
+ * </pre>
+ */
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef BSTREEINDEX_H
+#define BSTREEINDEX_H
+
+using namespace std;
+
+/**
+ * A hash index from keys held elsewhere to values
+ * @param <T> the type of the keys
+ * @param <V> the type of the values, a pointer type; null means absent
+ */
+template <typename T, typename V> class BstreeIndex
+{
+public:
+    /**
+     * a hash function for the keys
+     */
+    typedef size_t (*Hasher)(const T& key);
+    /**
+     * an equality test for the keys
+     */
+    typedef bool (*Equal)(const T& lft, const T& rgt);
+
+private:
+    /**
+     * a key, its hash and its value; an empty slot has no key
+     */
+    struct Slot
+    {
+        size_t hash;
+        const T* key;
+        V value;
+    };
+    /**
+     * the table; its size is zero or a power of two
+     */
+    vector<Slot> slots;
+    /**
+     * the number of keys
+     */
+    size_t count;
+    /**
+     * 64 less the base 2 logarithm of the capacity
+     */
+    unsigned shift;
+    /**
+     * the hash function
+     */
+    Hasher hasher;
+    /**
+     * the equality test
+     */
+    Equal equal;
+
+    /**
+     * Gives the slot where probing for a hash starts
+     * @param hash the hash of a key
+     * @return the index of the slot
+     */
+    size_t home(size_t hash) const;
+
+    /**
+     * Gives the slot holding a key, or the empty slot where it belongs
+     * @param key the key
+     * @param hash the hash of the key
+     * @return the index of the slot
+     */
+    size_t probe(const T& key, size_t hash) const;
+
+    /**
+     * Doubles the capacity, or allocates the first table
+     */
+    void grow();
+
+public:
+    /**
+     * Constructs an empty index
+     * @param hasher the hash function for the keys
+     * @param equal the equality test for the keys
+     */
+    BstreeIndex(Hasher hasher, Equal equal);
+
+    /**
+     * Gives the value of a key
+     * @param key the key
+     * @return the value, or null when the key is not in the index
+     */
+    V find(const T& key) const;
+
+    /**
+     * Adds a key, or replaces the key and value of an equal one
+     * @param key the key; it must stay in place, unchanged, while indexed
+     * @param value the value
+     */
+    void insert(const T& key, V value);
+
+    /**
+     * Removes a key
+     * @param key a key equal to the one to be removed
+     * @return true if it was in the index; otherwise, false
+     */
+    bool erase(const T& key);
+
+    /**
+     * Removes every key, keeping the table
+     */
+    void clear();
+
+    /**
+     * Gives the number of keys
+     * @return the number of keys
+     */
+    size_t size() const;
+
+    /**
+     * Gives the memory held by the table
+     * @return the bytes of the slots
+     */
+    size_t bytes() const;
+
+    /**
+     * Gives an empty index with the same hash function and equality test
+     * @return the new index, allocated with new
+     */
+    BstreeIndex<T, V>* emptyCopy() const;
+};
+#endif //BSTREEINDEX_H
@@ -0,0 +1,327 @@
+/**
+ * Implementation file for functions of the BstreeJournal<T> class
+ * @author Preston Gautreaux
+ * @see BstreeJournal.h
+ * <pre>
+ * File: BstreeJournal.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "BstreeJournal.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * Computes the FNV-1a checksum of a journal record
+ * @param bytes the op and key bytes of the record
+ * @param length the number of bytes
+ * @return the checksum
+ */
+inline uint32_t journalChecksum(const char* bytes, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t k = 0; k < length; k++)
+    {
+        hash ^= static_cast<unsigned char>(bytes[k]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Flushes a file or directory to stable storage
+ * @param filename the file or directory
+ * @return true on success; otherwise, false
+ */
+inline bool journalSync(const string& filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool synced = fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+template <typename T>
+BstreeJournal<T>::BstreeJournal(Bstree<T>& tree, const string& directory, size_t groupSize,
+    long checkpointInterval) : tree(tree)
+{
+    this->directory = directory;
+    this->groupSize = max(groupSize, static_cast<size_t>(1));
+    this->checkpointInterval = checkpointInterval;
+    generation = 0;
+    verified = 0;
+    oldest = 0;
+    logFd = -1;
+    groupCount = 0;
+    sinceCheckpoint = 0;
+}
+
+template <typename T>
+BstreeJournal<T>::~BstreeJournal()
+{
+    try
+    {
+        commit();
+    }
+    catch (const BstreeException& e)
+    {
+        cerr << e.what() << endl;
+    }
+    if (logFd >= 0)
+        ::close(logFd);
+}
+
+template <typename T>
+string BstreeJournal<T>::path(const string& prefix, uint64_t gen, const string& suffix) const
+{
+    return directory + "/" + prefix + "." + to_string(gen) + suffix;
+}
+
+template <typename T>
+long BstreeJournal<T>::recover()
+{
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+        throw BstreeException("Exception: unable to create journal directory " + directory);
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        throw BstreeException("Exception: unable to read journal directory " + directory);
+    vector<uint64_t> checkpoints, logs;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        string name = entry->d_name;
+        unsigned long long gen;
+        char suffix[8];
+        if (sscanf(name.c_str(), "checkpoint.%llu.%7s", &gen, suffix) == 2 && string(suffix) == "bsts")
+            checkpoints.push_back(gen);
+        else if (sscanf(name.c_str(), "journal.%llu.%7s", &gen, suffix) == 2 && string(suffix) == "log")
+            logs.push_back(gen);
+    }
+    closedir(dir);
+    uint64_t newest = 0;
+    oldest = UINT64_MAX;
+    for (uint64_t gen : checkpoints)
+    {
+        newest = max(newest, gen);
+        oldest = min(oldest, gen);
+    }
+    for (uint64_t gen : logs)
+    {
+        newest = max(newest, gen);
+        oldest = min(oldest, gen);
+    }
+    if (oldest == UINT64_MAX)
+        oldest = 0;
+
+    /* every generation that has a checkpoint is a candidate, newest first,
+       and generation 0 (the empty tree) last; a candidate needs the log of
+       every generation from its own up to the newest, which may be empty */
+    vector<uint64_t> candidates = checkpoints;
+    candidates.push_back(0);
+    sort(candidates.rbegin(), candidates.rend());
+    bool loaded = false;
+    uint64_t base = 0;
+    for (uint64_t gen : candidates)
+    {
+        bool chained = true;
+        for (uint64_t k = gen; k < newest && chained; k++)
+            chained = find(logs.begin(), logs.end(), k) != logs.end();
+        if (!chained)
+            continue;
+        try
+        {
+            if (gen > 0)
+                tree.open(path("checkpoint", gen, ".bsts"));
+            else
+                /* clear, not a fresh tree, keeps the settings of the tree:
+                   its hash index, balancing policy and reclaimer */
+                tree.clear();
+            base = gen;
+            loaded = true;
+            break;
+        }
+        catch (const BstreeException& e)
+        {
+            cerr << e.what() << "; falling back to an older checkpoint" << endl;
+        }
+    }
+    if (!loaded)
+        throw BstreeException("Exception: no checkpoint in " + directory
+            + " reads back and its logs do not reach back to the empty tree");
+
+    long replayed = 0;
+    for (uint64_t k = base; k <= newest; k++)
+        replayed += replay(path("journal", k, ".log"));
+    generation = newest;
+    verified = base;
+    openLog(false);
+    sinceCheckpoint = replayed;
+    return replayed;
+}
+
+template <typename T>
+long BstreeJournal<T>::replay(const string& filename)
+{
+    int fd = ::open(filename.c_str(), O_RDWR);
+    if (fd < 0)
+        return 0;
+    string log;
+    char buffer[1 << 16];
+    ssize_t got;
+    while ((got = ::read(fd, buffer, sizeof(buffer))) > 0)
+        log.append(buffer, got);
+
+    long replayed = 0;
+    size_t pos = 0;
+    T item;
+    while (pos + sizeof(uint32_t) <= log.size())
+    {
+        uint32_t length, checksum;
+        memcpy(&length, log.data() + pos, sizeof(length));
+        size_t body = pos + sizeof(length);
+        if (length == 0 || body + length + sizeof(checksum) > log.size())
+            break;
+        memcpy(&checksum, log.data() + body + length, sizeof(checksum));
+        uint8_t op = static_cast<uint8_t>(log[body]);
+        if (checksum != journalChecksum(log.data() + body, length)
+            || (op != INSERT_OP && op != DELETE_OP)
+            || !SnapshotCodec<T>::decode(log.data() + body + 1, length - 1, item))
+            break;
+        if (op == INSERT_OP)
+            tree.insert(item);
+        else
+            tree.remove(item);
+        replayed++;
+        pos = body + length + sizeof(checksum);
+    }
+    /* a crash can leave a partially written group at the end */
+    if (pos < log.size() && ftruncate(fd, pos) != 0)
+        cerr << "Exception: unable to truncate the torn tail of " << filename << endl;
+    ::close(fd);
+    return replayed;
+}
+
+template <typename T>
+void BstreeJournal<T>::openLog(bool truncate)
+{
+    if (logFd >= 0)
+        ::close(logFd);
+    string filename = path("journal", generation, ".log");
+    logFd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0), 0644);
+    if (logFd < 0)
+        throw BstreeException("Exception: unable to open journal " + filename);
+}
+
+template <typename T>
+void BstreeJournal<T>::append(uint8_t op, const T& item)
+{
+    size_t start = group.size();
+    group.append(sizeof(uint32_t), '\0');
+    group += static_cast<char>(op);
+    SnapshotCodec<T>::encode(group, item);
+    uint32_t length = group.size() - start - sizeof(uint32_t);
+    uint32_t checksum = journalChecksum(group.data() + start + sizeof(uint32_t), length);
+    memcpy(&group[start], &length, sizeof(length));
+    group.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    groupCount++;
+    sinceCheckpoint++;
+    if (groupCount >= groupSize)
+        commit();
+}
+
+template <typename T>
+void BstreeJournal<T>::checkpointIfDue()
+{
+    if (checkpointInterval > 0 && sinceCheckpoint >= checkpointInterval)
+        checkpoint();
+}
+
+template <typename T>
+void BstreeJournal<T>::logInsert(const T& item)
+{
+    append(INSERT_OP, item);
+    checkpointIfDue();
+}
+
+template <typename T>
+void BstreeJournal<T>::logRemove(const T& item)
+{
+    append(DELETE_OP, item);
+    checkpointIfDue();
+}
+
+template <typename T>
+void BstreeJournal<T>::logBatch(const vector<typename Bstree<T>::Op>& batch, const vector<bool>& applied)
+{
+    for (size_t k = 0; k < batch.size(); k++)
+        if (!batch[k].remove)
+            append(INSERT_OP, batch[k].item);
+        else if (applied[k])
+            append(DELETE_OP, batch[k].item);
+    checkpointIfDue();
+}
+
+template <typename T>
+void BstreeJournal<T>::commit()
+{
+    if (group.empty())
+        return;
+    if (logFd < 0)
+        throw BstreeException("Exception: journal used before recover()");
+    size_t written = 0;
+    while (written < group.size())
+    {
+        ssize_t put = ::write(logFd, group.data() + written, group.size() - written);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            throw BstreeException("Exception: unable to write journal " + path("journal", generation, ".log"));
+        written += put;
+    }
+    if (fdatasync(logFd) != 0)
+        throw BstreeException("Exception: unable to sync journal " + path("journal", generation, ".log"));
+    group.clear();
+    groupCount = 0;
+}
+
+template <typename T>
+void BstreeJournal<T>::checkpoint()
+{
+    commit();
+    string snapshot = path("checkpoint", generation + 1, ".bsts");
+    tree.save(snapshot);
+    if (!journalSync(snapshot))
+        throw BstreeException("Exception: unable to sync checkpoint " + snapshot);
+    try
+    {
+        SnapshotReader<T> check(snapshot);
+    }
+    catch (const BstreeException&)
+    {
+        throw BstreeException("Exception: checkpoint " + snapshot + " does not read back");
+    }
+    generation++;
+    openLog(true);
+    journalSync(directory);
+    /* the generation verified before this one stays as its fallback */
+    for (; oldest < verified; oldest++)
+    {
+        ::remove(path("journal", oldest, ".log").c_str());
+        ::remove(path("checkpoint", oldest, ".bsts").c_str());
+    }
+    verified = generation;
+    sinceCheckpoint = 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * The specification for a write-ahead command journal that makes the
+ * mutations of a binary search tree recoverable after a crash.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: BstreeJournal.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * A journal directory holds, for the current generation g,
+ *   checkpoint.g.bsts : a snapshot of the tree (absent for generation 0)
+ *   journal.g.log     : the mutations applied since that snapshot
+ * Each log record is
+ *   uint32 length | uint8 op | key (length - 1 bytes) | uint32 checksum
+ * where the checksum is FNV-1a over the op and key bytes. Records are
+ * buffered and written with a single write and fdatasync per group.
+ *
+ * The log of generation g takes the tree from checkpoint g to checkpoint
+ * g + 1, so any checkpoint followed by the logs of its generation and of
+ * every newer one rebuilds the current tree. A checkpoint writes generation
+ * g + 1 and reads it back (the snapshot CRC catches damage) before it
+ * removes anything, and then removes only the generations before the one
+ * verified last, which stays as a fallback. Recovery loads the newest
+ * checkpoint that reads back and replays the logs from there; it deletes
+ * nothing, and it fails rather than start from an empty tree when there
+ * are checkpoints and none of them reads back. Generation 0 has no
+ * checkpoint: it is the empty tree, a fallback while journal.0.log is kept.
+ * </pre>
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Bstree.h"
+
+#ifndef BSTREEJOURNAL_H
+#define BSTREEJOURNAL_H
+
+using namespace std;
+
+/**
+ * A journal of the insert and delete operations applied to one tree
+ * @param <T> the data type of the journaled tree
+ */
+template <typename T> class BstreeJournal
+{
+private:
+    /**
+     * the journaled tree
+     */
+    Bstree<T>& tree;
+    /**
+     * the directory holding the checkpoints and logs
+     */
+    string directory;
+    /**
+     * the current generation, the newest in the directory
+     */
+    uint64_t generation;
+    /**
+     * the newest generation whose checkpoint is known to read back, or 0
+     */
+    uint64_t verified;
+    /**
+     * the oldest generation that may still have files in the directory
+     */
+    uint64_t oldest;
+    /**
+     * the descriptor of the open log of the current generation, or -1
+     */
+    int logFd;
+    /**
+     * the encoded records not yet written to the log
+     */
+    string group;
+    /**
+     * the number of records in group
+     */
+    size_t groupCount;
+    /**
+     * the number of records that triggers a group commit
+     */
+    size_t groupSize;
+    /**
+     * the number of records logged since the last checkpoint
+     */
+    long sinceCheckpoint;
+    /**
+     * the number of records that triggers a checkpoint; 0 disables
+     * periodic checkpoints
+     */
+    long checkpointInterval;
+
+    /**
+     * Gives the path of a file of the specified generation
+     * @param prefix "checkpoint" or "journal"
+     * @param gen a generation
+     * @param suffix ".bsts" or ".log"
+     * @return the path
+     */
+    string path(const string& prefix, uint64_t gen, const string& suffix) const;
+
+    /**
+     * Replays the records of a log into the tree, truncating a torn or
+     * corrupt tail
+     * @param filename the log to replay
+     * @return the number of records replayed
+     */
+    long replay(const string& filename);
+
+    /**
+     * Opens the log of the current generation for appending
+     * @param truncate true to start an empty log
+     */
+    void openLog(bool truncate);
+
+    /**
+     * Appends a record to the current group, committing the group when it
+     * is full
+     * @param op the operation code
+     * @param item the operand
+     */
+    void append(uint8_t op, const T& item);
+
+    /**
+     * Takes a checkpoint if enough records have been logged since the last
+     * one; the tree must hold exactly the mutations logged so far
+     */
+    void checkpointIfDue();
+
+public:
+    /**
+     * the operation code of a logged insert
+     */
+    static const uint8_t INSERT_OP = 1;
+    /**
+     * the operation code of a logged delete
+     */
+    static const uint8_t DELETE_OP = 2;
+
+    /**
+     * Creates a journal for a tree; nothing is read or written until
+     * recover is called
+     * @param tree the tree to be journaled
+     * @param directory the journal directory; it is created if necessary
+     * @param groupSize the number of records committed together
+     * @param checkpointInterval the number of records between checkpoints,
+     * or 0 for no periodic checkpoints
+     */
+    BstreeJournal(Bstree<T>& tree, const string& directory, size_t groupSize = 64,
+        long checkpointInterval = 100000);
+
+    /**
+     * The journal owns a file descriptor and must not be copied
+     */
+    BstreeJournal(const BstreeJournal<T>& other) = delete;
+    BstreeJournal<T>& operator=(const BstreeJournal<T>& other) = delete;
+
+    /**
+     * Commits any buffered records and closes the log
+     */
+    virtual ~BstreeJournal();
+
+    /**
+     * Restores the tree from the newest readable checkpoint and the logs
+     * written since it, then opens the newest log for appending. No file
+     * is removed.
+     * @return the number of log records replayed
+     * @throw BstreeException when the directory cannot be used, or when no
+     * checkpoint reads back and the logs do not reach back to the empty
+     * tree; the files are then left as they are
+     */
+    long recover();
+
+    /**
+     * Logs an insert that has been applied to the tree
+     * @param item the inserted item
+     */
+    void logInsert(const T& item);
+
+    /**
+     * Logs a delete that has been applied to the tree
+     * @param item the deleted item
+     */
+    void logRemove(const T& item);
+
+    /**
+     * Logs a run of inserts and deletes that has been applied to the tree
+     * as a whole, as by Bstree::apply_batch. A checkpoint that falls due
+     * is taken after the whole run is logged, since the tree already holds
+     * the mutations of the run that are not yet logged.
+     * @param batch the inserts and deletes, in order
+     * @param applied whether each one changed the tree; deletes that did
+     * not are left out
+     */
+    void logBatch(const vector<typename Bstree<T>::Op>& batch, const vector<bool>& applied);
+
+    /**
+     * Writes the buffered records to the log and waits until they are on
+     * stable storage
+     * @throw BstreeException when the log cannot be written
+     */
+    void commit();
+
+    /**
+     * Writes a snapshot of the tree as a new generation and reads it back,
+     * starts an empty log for it, and removes the generations before the
+     * last one verified
+     * @throw BstreeException when the checkpoint cannot be written or does
+     * not read back; nothing is removed then
+     */
+    void checkpoint();
+};
+#endif //BSTREEJOURNAL_H
@@ -0,0 +1,230 @@
+/**
+ * A test of the recovery of a binary search tree from its journal
+ * @author Preston Gautreaux
+ * @see BstreeJournal
+ * <pre>
+ * File: BstreeJournalTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Journals inserts and removes into a temporary directory and recovers
+ * them into fresh trees, from the journal alone and from a checkpoint,
+ * checking that the items come back and that recovery keeps the settings
+ * of the tree it recovers into: its hash index (whose memory must still
+ * be reported, as BstreeParser --index --journal shows with mem) and its
+ * balancing policy. Checks that a run applied at once by apply_batch
+ * recovers into the same shape when a checkpoint falls due within it.
+ * Then damages checkpoints: recovery must fall back to
+ * the one before and the logs since, and must fail, deleting nothing,
+ * once no checkpoint reads back. Prints each failed check and exits with
+ * the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeJournalTest BstreeJournalTest.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Bstree.cpp"
+#include "BstreeJournal.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * Recovers an indexed scapegoat tree from a journal directory and checks
+ * its settings and items
+ * @param directory the journal directory
+ * @param what the description of the recovery
+ */
+void checkRecovery(const string& directory, const string& what)
+{
+    Bstree<long> tree;
+    tree.setIndexed(true);
+    tree.setScapegoat(0.7);
+    BstreeJournal<long> journal(tree, directory);
+    journal.recover();
+    check(tree.indexed(), what + ": the tree is still indexed");
+    check(tree.memory_usage().indexBytes > 0, what + ": the index memory is reported");
+    check(tree.size() == 99, what + ": every journaled item is back");
+    check(tree.inTree(0) && tree.inTree(98) && !tree.inTree(99), what + ": the removed item stays removed");
+    /* a scapegoat tree deletes lazily, so the node stays */
+    long nodes = tree.memory_usage().nodes;
+    tree.remove(5);
+    check(tree.memory_usage().nodes == nodes, what + ": the tree still deletes lazily");
+}
+
+/**
+ * the preorder a traversal has collected
+ */
+static vector<long> preorder;
+
+/**
+ * Collects an item of a preorder traversal
+ * @param item the item
+ */
+void collect(const long& item)
+{
+    preorder.push_back(item);
+}
+
+/**
+ * Gives the preorder of a tree, which determines its shape
+ * @param tree the tree
+ * @return the items in preorder
+ */
+vector<long> preorderOf(const Bstree<long>& tree)
+{
+    preorder.clear();
+    tree.preorderTraverse(collect);
+    return preorder;
+}
+
+/**
+ * Applies a run with apply_batch and logs it while a checkpoint falls due
+ * after its first record: the checkpoint must wait for the end of the run,
+ * or recovery replays the rest of the run onto a tree that already holds
+ * it. Inserting 10 after deleting it makes the replayed shape differ.
+ * @param directory an empty journal directory
+ */
+void checkBatch(const string& directory)
+{
+    vector<long> live;
+    {
+        Bstree<long> tree;
+        BstreeJournal<long> journal(tree, directory, 64, 4);
+        journal.recover();
+        for (long item = 1; item <= 3; item++)
+        {
+            tree.insert(item);
+            journal.logInsert(item);
+        }
+        vector<Bstree<long>::Op> batch = { { 10, false }, { 10, true }, { 10, false }, { 11, false } };
+        vector<bool> applied;
+        tree.apply_batch(batch, &applied);
+        journal.logBatch(batch, applied);
+        live = preorderOf(tree);
+    }
+    Bstree<long> tree;
+    BstreeJournal<long> journal(tree, directory, 64, 4);
+    journal.recover();
+    check(preorderOf(tree) == live, "batch: a checkpoint within a run recovers the shape of the run");
+}
+
+/**
+ * Determines whether a file exists
+ * @param filename the name of the file
+ * @return true if the file exists; otherwise, false
+ */
+bool exists(const string& filename)
+{
+    struct stat info;
+    return stat(filename.c_str(), &info) == 0;
+}
+
+/**
+ * Checks recovery from damaged checkpoints: three generations of 100
+ * items each, the newest checkpoint with a flipped byte, then the one
+ * before it cut short
+ * @param directory an empty journal directory
+ */
+void checkDamage(const string& directory)
+{
+    {
+        Bstree<long> tree;
+        BstreeJournal<long> journal(tree, directory);
+        journal.recover();
+        for (long item = 0; item < 300; item++)
+        {
+            tree.insert(item);
+            journal.logInsert(item);
+            if (item % 100 == 99 && item < 299)
+                journal.checkpoint();
+        }
+    }
+    string newest = directory + "/checkpoint.2.bsts", older = directory + "/checkpoint.1.bsts";
+    check(exists(older) && exists(newest) && !exists(directory + "/journal.0.log"),
+        "damage: a checkpoint keeps the generation before it");
+
+    FILE* file = fopen(newest.c_str(), "r+b");
+    fseek(file, -5, SEEK_END);
+    int byte = fgetc(file);
+    fseek(file, -5, SEEK_END);
+    fputc(byte ^ 1, file);
+    fclose(file);
+    {
+        Bstree<long> tree;
+        BstreeJournal<long> journal(tree, directory);
+        journal.recover();
+        check(tree.size() == 300 && tree.inTree(0) && tree.inTree(150) && tree.inTree(299),
+            "damage: a flipped byte falls back to the checkpoint before and the logs since");
+    }
+    check(exists(newest) && exists(older), "damage: recovery deletes no checkpoint");
+
+    if (truncate(older.c_str(), 20) != 0)
+        check(false, "damage: unable to truncate " + older);
+    bool thrown = false;
+    try
+    {
+        Bstree<long> tree;
+        BstreeJournal<long> journal(tree, directory);
+        journal.recover();
+    }
+    catch (const BstreeException&)
+    {
+        thrown = true;
+    }
+    check(thrown, "damage: recovery fails when no checkpoint reads back");
+    check(exists(newest) && exists(older) && exists(directory + "/journal.1.log")
+        && exists(directory + "/journal.2.log"), "damage: a failed recovery deletes nothing");
+}
+
+int main()
+{
+    char name[] = "/tmp/BstreeJournalTest.XXXXXX";
+    if (!mkdtemp(name))
+    {
+        cout << "FAILED: unable to create a temporary directory" << endl;
+        return 1;
+    }
+    string directory = name;
+    {
+        Bstree<long> tree;
+        BstreeJournal<long> journal(tree, directory);
+        journal.recover();
+        for (long item = 0; item < 100; item++)
+        {
+            tree.insert(item);
+            journal.logInsert(item);
+        }
+        tree.remove(99);
+        journal.logRemove(99);
+        journal.commit();
+    }
+    checkRecovery(directory, "from the journal");
+    {
+        Bstree<long> tree;
+        BstreeJournal<long> journal(tree, directory);
+        journal.recover();
+        journal.checkpoint();
+    }
+    checkRecovery(directory, "from a checkpoint");
+    string cleanup = "rm -rf " + directory;
+    if (system(cleanup.c_str()) != 0)
+        cout << "unable to remove " << directory << endl;
+    checkDamage(directory);
+    if (system(cleanup.c_str()) != 0)
+        cout << "unable to remove " << directory << endl;
+    checkBatch(directory);
+    if (system(cleanup.c_str()) != 0)
+        cout << "unable to remove " << directory << endl;
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
@@ -0,0 +1,205 @@
+/**
+ * Implementation file for functions of the BstreeMap<K, V, Compare> class
+ * @author Preston Gautreaux
+ * @see BstreeMap.h
+ * <pre>
+ * File: BstreeMap.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Bstree.cpp must be included before this file.
+ * </pre>
+ */
+
+using namespace std;
+
+#include "BstreeMap.h"
+
+/* Nested NodeHandle class definitions */
+template <typename K, typename V, typename Compare>
+BstreeMap<K, V, Compare>::NodeHandle::NodeHandle(Node* node)
+{
+    this->node = node;
+}
+
+template <typename K, typename V, typename Compare>
+BstreeMap<K, V, Compare>::NodeHandle::NodeHandle()
+{
+    node = nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+BstreeMap<K, V, Compare>::NodeHandle::NodeHandle(NodeHandle&& other)
+{
+    node = other.node;
+    other.node = nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+typename BstreeMap<K, V, Compare>::NodeHandle& BstreeMap<K, V, Compare>::NodeHandle::operator=(NodeHandle&& other)
+{
+    if (this != &other)
+    {
+        delete node;
+        node = other.node;
+        other.node = nullptr;
+    }
+    return *this;
+}
+
+template <typename K, typename V, typename Compare>
+BstreeMap<K, V, Compare>::NodeHandle::~NodeHandle()
+{
+    delete node;
+}
+
+template <typename K, typename V, typename Compare>
+bool BstreeMap<K, V, Compare>::NodeHandle::empty() const
+{
+    return node == nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+K& BstreeMap<K, V, Compare>::NodeHandle::key() const
+{
+    if (!node)
+        throw BstreeException("Exception: empty node handle on key().");
+    return node->data.key;
+}
+
+template <typename K, typename V, typename Compare>
+V& BstreeMap<K, V, Compare>::NodeHandle::value() const
+{
+    if (!node)
+        throw BstreeException("Exception: empty node handle on value().");
+    return node->data.value;
+}
+
+/* Outer BstreeMap class definitions */
+template <typename K, typename V, typename Compare>
+BstreeMap<K, V, Compare>::BstreeMap(const Compare& compare) : keyCompare(compare)
+{
+}
+
+template <typename K, typename V, typename Compare>
+bool BstreeMap<K, V, Compare>::empty() const
+{
+    return tree.empty();
+}
+
+template <typename K, typename V, typename Compare>
+long BstreeMap<K, V, Compare>::size() const
+{
+    return tree.size();
+}
+
+template <typename K, typename V, typename Compare>
+typename BstreeMap<K, V, Compare>::Node** BstreeMap<K, V, Compare>::locate(const K& key, long delta) const
+{
+    const Compare& before = keyCompare;
+    return const_cast<Bstree<Entry>&>(tree).descend([&before, &key](const Entry& here)
+        { return before(key, here.key) ? -1 : before(here.key, key) ? 1 : 0; }, delta);
+}
+
+template <typename K, typename V, typename Compare>
+void BstreeMap<K, V, Compare>::attach(Node** link, Node* node)
+{
+    *link = node;
+    tree.order++;
+    tree.nodes++;
+    tree.mutate(true);
+    /* the map descends by its own comparisons and marks no node stale */
+    tree.hashed = false;
+    locate(node->data.key, 1);
+}
+
+template <typename K, typename V, typename Compare>
+typename BstreeMap<K, V, Compare>::Node* BstreeMap<K, V, Compare>::detach(Node** link)
+{
+    locate((*link)->data.key, -1);
+    tree.order--;
+    tree.nodes--;
+    return tree.unlink(link);
+}
+
+template <typename K, typename V, typename Compare>
+V& BstreeMap<K, V, Compare>::operator[](const K& key)
+{
+    Node** link = locate(key);
+    if (!*link)
+        attach(link, tree.createNode(Entry{ key, V() }));
+    return (*link)->data.value;
+}
+
+template <typename K, typename V, typename Compare>
+V* BstreeMap<K, V, Compare>::find(const K& key)
+{
+    Node* node = *locate(key);
+    return node ? &node->data.value : nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+const V* BstreeMap<K, V, Compare>::find(const K& key) const
+{
+    Node* node = *locate(key);
+    return node ? &node->data.value : nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+bool BstreeMap<K, V, Compare>::contains(const K& key) const
+{
+    return *locate(key) != nullptr;
+}
+
+template <typename K, typename V, typename Compare>
+bool BstreeMap<K, V, Compare>::insert_or_assign(const K& key, V value)
+{
+    Node** link = locate(key);
+    if (*link)
+    {
+        (*link)->data.value = move(value);
+        return false;
+    }
+    attach(link, tree.createNode(Entry{ key, move(value) }));
+    return true;
+}
+
+template <typename K, typename V, typename Compare>
+bool BstreeMap<K, V, Compare>::erase(const K& key)
+{
+    Node** link = locate(key);
+    if (!*link)
+        return false;
+    tree.destroyNode(detach(link));
+    return true;
+}
+
+template <typename K, typename V, typename Compare>
+typename BstreeMap<K, V, Compare>::NodeHandle BstreeMap<K, V, Compare>::extract(const K& key)
+{
+    Node** link = locate(key);
+    if (!*link)
+        return NodeHandle();
+    return NodeHandle(detach(link));
+}
+
+template <typename K, typename V, typename Compare>
+bool BstreeMap<K, V, Compare>::insert(NodeHandle&& handle)
+{
+    if (!handle.node)
+        return false;
+    Node** link = locate(handle.node->data.key);
+    if (*link)
+        return false;
+    attach(link, handle.node);
+    handle.node = nullptr;
+    return true;
+}
+
+template <typename K, typename V, typename Compare>
+void BstreeMap<K, V, Compare>::inorderTraverse(FuncType apply)
+{
+    /* the flattened inorder of the tree, kept until the map changes shape */
+    for (const Node* node : tree.sequence(Bstree<Entry>::INORDER))
+        apply(node->data.key, const_cast<Node*>(node)->data.value);
+}
@@ -0,0 +1,243 @@
+/**
+ * The specification for a binary search tree map from keys to values.
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeMap.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * BstreeMap stores its entries in the nodes of a Bstree<Entry> and searches
+ * them with Compare applied to the keys alone, so a value never takes part
+ * in a comparison and is never copied by a search or an overwrite. A node
+ * can be extracted into a NodeHandle and inserted into another map with the
+ * same types without being reallocated.
+ * </pre>
+ */
+
+#include <functional>
+#include <utility>
+
+#include "Bstree.h"
+
+#ifndef BSTREEMAP_H
+#define BSTREEMAP_H
+
+using namespace std;
+
+/**
+ * An ordered map backed by an unbalanced binary search tree
+ * @param <K> the key type
+ * @param <V> the value type; it must be default constructible for
+ * operator[]
+ * @param <Compare> the strict weak ordering of the keys
+ */
+template <typename K, typename V, typename Compare = less<K>> class BstreeMap
+{
+public:
+    /**
+     * an entry of the map: a key and its value
+     */
+    struct Entry
+    {
+        K key;
+        V value;
+    };
+
+    /**
+     * forward declaration of the NodeHandle class
+     */
+    class NodeHandle;
+
+private:
+    /**
+     * forward declaration of a function pointer of type
+     * (const K&, V&) -> void
+     */
+    typedef void (*FuncType)(const K& key, V& value);
+    /**
+     * the node of the underlying tree
+     */
+    typedef typename Bstree<Entry>::Node Node;
+
+    /**
+     * the entries
+     */
+    Bstree<Entry> tree;
+    /**
+     * the ordering of the keys
+     */
+    Compare keyCompare;
+
+    /**
+     * Gives the link that holds the node of a key, or the empty link where
+     * such a node belongs, descending as Bstree::descend does by the keys
+     * alone
+     * @param key the search key
+     * @param delta the amount added to the left subtree counts of the nodes
+     * above the key whose left subtree holds it; 0 for a search
+     * @return the link
+     */
+    Node** locate(const K& key, long delta = 0) const;
+
+    /**
+     * Links a detached node into the empty link where its key belongs
+     * @param link the empty link, as given by locate
+     * @param node the node
+     */
+    void attach(Node** link, Node* node);
+
+    /**
+     * Unlinks the node held by a link, as Bstree::unlink does
+     * @param link the link, as given by locate
+     * @return the detached node
+     */
+    Node* detach(Node** link);
+
+public:
+    /**
+     * Constructs an empty map
+     * @param compare the ordering of the keys
+     */
+    BstreeMap(const Compare& compare = Compare());
+
+    /**
+     * Determines whether the map is empty.
+     * @return true if the map has no entries; otherwise, false
+     */
+    bool empty() const;
+
+    /**
+     * Gives the number of entries of this map
+     * @return the number of entries
+     */
+    long size() const;
+
+    /**
+     * Gives the value of a key, inserting a default value when the key is
+     * not in the map
+     * @param key the key
+     * @return a reference to the value
+     */
+    V& operator[](const K& key);
+
+    /**
+     * Gives the value of a key
+     * @param key the search key
+     * @return a pointer to the value, or null if the key is not in the map
+     */
+    V* find(const K& key);
+    const V* find(const K& key) const;
+
+    /**
+     * Determines whether a key is in the map
+     * @param key the search key
+     * @return true if the key is in the map; otherwise, false
+     */
+    bool contains(const K& key) const;
+
+    /**
+     * Sets the value of a key; the key is copied only when it is inserted
+     * @param key the key
+     * @param value the value, moved into the map
+     * @return true if the key was inserted; false if its value was replaced
+     */
+    bool insert_or_assign(const K& key, V value);
+
+    /**
+     * Removes a key and its value
+     * @param key the key
+     * @return true if the key was in the map; otherwise, false
+     */
+    bool erase(const K& key);
+
+    /**
+     * Detaches the node of a key from the map without freeing it
+     * @param key the key
+     * @return a handle owning the node, or an empty handle if the key is
+     * not in the map
+     */
+    NodeHandle extract(const K& key);
+
+    /**
+     * Links the node owned by a handle into this map without reallocating
+     * it; nothing happens when the handle is empty or its key is already in
+     * the map
+     * @param handle the handle; it is emptied when its node is inserted
+     * @return true if the node was inserted; otherwise, false
+     */
+    bool insert(NodeHandle&& handle);
+
+    /**
+     * Applies a function to every entry in key order
+     * @param apply a pointer to a function of type (const K&, V&) -> void
+     */
+    void inorderTraverse(FuncType apply);
+};
+
+/**
+ * nested NodeHandle class definition: the sole owner of a node extracted
+ * from a map; it can be moved but not copied
+ */
+template <typename K, typename V, typename Compare>
+class BstreeMap<K, V, Compare>::NodeHandle
+{
+private:
+    /**
+     * the node, or null for an empty handle
+     */
+    Node* node;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * BstreeMap class
+     */
+    friend class BstreeMap<K, V, Compare>;
+
+    /**
+     * Takes ownership of a detached node
+     * @param node the node or null
+     */
+    NodeHandle(Node* node);
+
+public:
+    /**
+     * Constructs an empty handle
+     */
+    NodeHandle();
+
+    NodeHandle(const NodeHandle& other) = delete;
+    NodeHandle& operator=(const NodeHandle& other) = delete;
+
+    /**
+     * Takes the node of another handle
+     * @param other the handle to be emptied
+     */
+    NodeHandle(NodeHandle&& other);
+    NodeHandle& operator=(NodeHandle&& other);
+
+    /**
+     * Frees the node, if the handle still owns one
+     */
+    ~NodeHandle();
+
+    /**
+     * Determines whether the handle owns a node
+     * @return true if the handle is empty; otherwise, false
+     */
+    bool empty() const;
+
+    /**
+     * Gives the key of the node; the key may be changed before the node is
+     * inserted into a map
+     * @return a reference to the key
+     */
+    K& key() const;
+
+    /**
+     * Gives the value of the node
+     * @return a reference to the value
+     */
+    V& value() const;
+};
+#endif //BSTREEMAP_H
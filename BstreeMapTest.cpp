@@ -0,0 +1,161 @@
+/**
+ * A test of the binary search tree map
+ * @author Preston Gautreaux
+ * @see BstreeMap
+ * <pre>
+ * File: BstreeMapTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Checks operator[], find, insert_or_assign and erase of BstreeMap against
+ * std::map on random operations, and moves entries between two maps with
+ * extract and insert(NodeHandle&&), checking that a moved entry keeps its
+ * node. Prints each failed check and exits with the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeMapTest BstreeMapTest.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <vector>
+#include <random>
+#include <functional>
+#include "Bstree.cpp"
+#include "BstreeMap.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * The entries an inorder traversal has visited
+ */
+static vector<pair<int, string>> visited;
+
+/**
+ * Records an entry visited by an inorder traversal
+ * @param key the key of the entry
+ * @param value the value of the entry
+ */
+void visit(const int& key, string& value)
+{
+    visited.push_back({ key, value });
+}
+
+/**
+ * Checks the entries of a map against those of a std::map
+ * @param <Compare> the ordering of the keys
+ * @param map the map
+ * @param expected the entries the map should hold, in key order
+ * @param what the description of the map
+ */
+template <typename Compare>
+void checkEntries(BstreeMap<int, string, Compare>& map, const std::map<int, string, Compare>& expected,
+    const string& what)
+{
+    check(map.size() == static_cast<long>(expected.size()), what + ": size");
+    check(map.empty() == expected.empty(), what + ": empty");
+    visited.clear();
+    map.inorderTraverse(visit);
+    check(visited == vector<pair<int, string>>(expected.begin(), expected.end()),
+        what + ": inorderTraverse visits the entries in key order");
+    for (int key = -1; key <= 100; key++)
+    {
+        auto entry = expected.find(key);
+        const string* value = map.find(key);
+        if (entry == expected.end())
+            check(!value && !map.contains(key), what + ": find of a missing key");
+        else
+            check(value && *value == entry->second && map.contains(key), what + ": find of a present key");
+    }
+}
+
+int main()
+{
+    /* random operations, checked against std::map */
+    mt19937 random(1254);
+    BstreeMap<int, string> map;
+    std::map<int, string> expected;
+    checkEntries(map, expected, "empty map");
+    for (int round = 0; round < 2000; round++)
+    {
+        int key = random() % 100;
+        string value = to_string(round);
+        switch (random() % 4)
+        {
+        case 0:
+            map[key] += value;
+            expected[key] += value;
+            break;
+        case 1:
+            check(map.insert_or_assign(key, value) == (expected.count(key) == 0), "insert_or_assign reports an insert");
+            expected[key] = value;
+            break;
+        case 2:
+            check(map.erase(key) == (expected.erase(key) == 1), "erase reports a removal");
+            break;
+        default:
+            if (const string* found = map.find(key))
+                check(expected.count(key) && *found == expected[key], "find");
+            else
+                check(expected.count(key) == 0, "find of a missing key");
+        }
+        if (round % 250 == 0)
+            checkEntries(map, expected, "round " + to_string(round));
+    }
+    checkEntries(map, expected, "after the random operations");
+
+    /* entries moved between two maps keep their nodes */
+    BstreeMap<int, string> other;
+    std::map<int, string> otherExpected;
+    for (int key = 0; key < 100; key += 2)
+    {
+        if (!map.find(key))
+            continue;
+        string* value = map.find(key);
+        BstreeMap<int, string>::NodeHandle handle = map.extract(key);
+        check(!handle.empty() && handle.key() == key && &handle.value() == value, "extract owns the node");
+        check(other.insert(move(handle)) && handle.empty(), "insert takes the node");
+        check(other.find(key) == value, "insert links the node without reallocating it");
+        otherExpected[key] = expected[key];
+        expected.erase(key);
+    }
+    checkEntries(map, expected, "the map extracted from");
+    checkEntries(other, otherExpected, "the map inserted into");
+    check(map.extract(0).empty(), "extract of a missing key");
+
+    /* a handle is not inserted over a present key, and can be rekeyed */
+    other[1] = "present";
+    otherExpected[1] = "present";
+    BstreeMap<int, string>::NodeHandle handle = other.extract(2);
+    if (!handle.empty())
+    {
+        string moved = handle.value();
+        otherExpected.erase(2);
+        handle.key() = 1;
+        check(!other.insert(move(handle)) && !handle.empty(), "insert over a present key");
+        handle.key() = 101;
+        check(other.insert(move(handle)), "insert of a rekeyed node");
+        otherExpected[101] = moved;
+    }
+    check(!other.insert(BstreeMap<int, string>::NodeHandle()), "insert of an empty handle");
+    checkEntries(other, otherExpected, "after rekeying");
+    check(other.find(101) && *other.find(101) == otherExpected[101], "find of a rekeyed node");
+
+    /* another ordering of the keys */
+    BstreeMap<int, string, greater<int>> descending;
+    std::map<int, string, greater<int>> descendingExpected;
+    for (int key : { 5, 2, 8, 1, 9, 5 })
+    {
+        descending[key] = to_string(key);
+        descendingExpected[key] = to_string(key);
+    }
+    descending.erase(8);
+    descendingExpected.erase(8);
+    checkEntries(descending, descendingExpected, "descending map");
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
@@ -0,0 +1,23 @@
+/**
+ * Implementation file for functions of the BstreeMemory class
+ * @author Preston Gautreaux
+ * @see BstreeMemory.h
+ * <pre>
+ * File: BstreeMemory.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include "BstreeMemory.h"
+
+using namespace std;
+
+void BstreeMemory::report(ostream& out) const
+{
+    out << "nodes = " << nodes << ", node bytes = " << nodeBytes << ", payload bytes = " << payloadBytes
+        << ", index bytes = " << indexBytes << ", traversal cache bytes = " << cacheBytes << endl;
+    out << "allocator overhead = " << overheadBytes << " (estimated), total = " << total()
+        << ", peak = " << peakBytes << endl;
+}
@@ -0,0 +1,152 @@
+/**
+ * The specification for the memory footprint report of the binary search
+ * tree.
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeMemory.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * A tree keeps its footprint in counters that it updates where it allocates
+ * and frees nodes and where it overwrites their data, so reading them costs
+ * O(1) and never walks the tree. An item's out-of-line storage is measured
+ * by BstreePayload<T>: a std::string whose characters do not fit in the
+ * string object holds capacity() + 1 bytes on the heap, and any other type
+ * holds none unless BstreePayload is specialized for it. The allocator
+ * cannot be asked what it spends on each block, so the overhead is
+ * estimated as a malloc that keeps an 8-byte header per block and rounds
+ * blocks up to multiples of 16 bytes with a minimum of 32, as glibc does.
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <functional>
+
+#ifndef BSTREEMEMORY_H
+#define BSTREEMEMORY_H
+
+using namespace std;
+
+/**
+ * The memory held by a binary search tree
+ */
+class BstreeMemory
+{
+public:
+    /**
+     * the number of nodes, tombstones included
+     */
+    long nodes;
+    /**
+     * the bytes of the nodes themselves, items included
+     */
+    size_t nodeBytes;
+    /**
+     * the bytes the items hold outside their nodes
+     */
+    size_t payloadBytes;
+    /**
+     * the bytes of the table of the hash index, if the tree is indexed
+     */
+    size_t indexBytes;
+    /**
+     * the bytes of the flattened traversals the tree keeps
+     */
+    size_t cacheBytes;
+    /**
+     * the estimated bytes the allocator spends on headers and rounding for
+     * the blocks above
+     */
+    size_t overheadBytes;
+    /**
+     * the largest total held at any time since the tree was built
+     */
+    size_t peakBytes;
+
+    /**
+     * Creates an empty report
+     */
+    BstreeMemory()
+    {
+        nodes = 0;
+        nodeBytes = 0;
+        payloadBytes = 0;
+        indexBytes = 0;
+        cacheBytes = 0;
+        overheadBytes = 0;
+        peakBytes = 0;
+    }
+
+    /**
+     * Gives the memory held now
+     * @return the sum of the node, payload, index, cache and overhead bytes
+     */
+    size_t total() const
+    {
+        return nodeBytes + payloadBytes + indexBytes + cacheBytes + overheadBytes;
+    }
+
+    /**
+     * Writes the report in human-readable form
+     * @param out the stream to write to
+     */
+    void report(ostream& out) const;
+
+    /**
+     * Estimates the bytes the allocator spends beyond a request
+     * @param bytes the size of the request
+     * @return the header and rounding bytes of the block
+     */
+    static size_t overhead(size_t bytes)
+    {
+        size_t block = (bytes + 8 + 15) & ~static_cast<size_t>(15);
+        return (block < 32 ? 32 : block) - bytes;
+    }
+};
+
+/**
+ * Measures the storage an item holds outside itself; none by default
+ * @param <T> the type of the items
+ */
+template <typename T>
+struct BstreePayload
+{
+    /**
+     * Gives the bytes an item holds outside itself
+     * @param item the item
+     * @return 0
+     */
+    static size_t bytes(const T&)
+    {
+        return 0;
+    }
+};
+
+/**
+ * A string holds its characters outside itself once they outgrow the
+ * buffer inside the string object
+ */
+template <typename C, typename Traits, typename Alloc>
+struct BstreePayload<basic_string<C, Traits, Alloc>>
+{
+    /**
+     * Gives the bytes a string holds outside itself
+     * @param item the string
+     * @return its capacity and terminator, or 0 for a string kept inside
+     * the object
+     */
+    static size_t bytes(const basic_string<C, Traits, Alloc>& item)
+    {
+        const void* chars = item.data();
+        const void* first = &item;
+        const void* last = &item + 1;
+        if (!less<const void*>()(chars, first) && less<const void*>()(chars, last))
+            return 0;
+        return (item.capacity() + 1) * sizeof(C);
+    }
+};
+#endif //BSTREEMEMORY_H
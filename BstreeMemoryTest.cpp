@@ -0,0 +1,79 @@
+/**
+ * A test of the memory footprint report of the binary search tree
+ * @author Preston Gautreaux
+ * @see BstreeMemory
+ * <pre>
+ * File: BstreeMemoryTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Fills trees of longs, which hold nothing outside their nodes, and of
+ * long strings, which do, then empties them by removing every item, by
+ * clear() and by lazy deletes compacted away, and checks that the report
+ * returns to nothing but keeps the footprint of the full tree as its
+ * peak. Prints each failed check and exits with the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o BstreeMemoryTest BstreeMemoryTest.cpp BstreeReclaimer.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Bstree.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * Fills a tree with items, empties it in one of three ways and checks the
+ * footprint before and after
+ * @param <T> the type of the items
+ * @param items the items, in the order they are inserted
+ * @param how 0 to remove every item, 1 to clear the tree, 2 to remove
+ * them lazily from a scapegoat tree
+ * @param what the description of the items
+ */
+template <typename T>
+void checkPeak(const vector<T>& items, int how, const string& what)
+{
+    Bstree<T> tree;
+    if (how == 2)
+        tree.setScapegoat(0.7);
+    for (const T& item : items)
+        tree.insert(item);
+    BstreeMemory full = tree.memory_usage();
+    check(full.nodes == static_cast<long>(items.size()) && full.total() > 0, what + ": the items are counted");
+    check(full.peakBytes == full.total(), what + ": a growing tree peaks at its footprint");
+    if (how == 1)
+        tree.clear();
+    else
+        for (const T& item : items)
+            tree.remove(item);
+    BstreeMemory empty = tree.memory_usage();
+    check(empty.nodes == 0 && empty.nodeBytes == 0 && empty.payloadBytes == 0, what + ": nothing is held after");
+    check(empty.peakBytes >= full.total(), what + ": the peak of the full tree is kept");
+}
+
+int main()
+{
+    vector<long> longs;
+    vector<string> strings;
+    for (long item = 0; item < 1000; item++)
+    {
+        /* an order that does not degenerate the tree */
+        long key = (item * 617) % 1000;
+        longs.push_back(key);
+        strings.push_back(string(100, 'k') + to_string(key));
+    }
+    const string hows[] = { "remove", "clear", "lazy remove" };
+    for (int how = 0; how < 3; how++)
+    {
+        checkPeak(longs, how, "longs, " + hows[how]);
+        checkPeak(strings, how, "strings, " + hows[how]);
+    }
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
@@ -0,0 +1,195 @@
+/**
+ * Implementation of the construction of binary search trees of least
+ * expected search cost.
+ * @author Preston Gautreaux
+ * @see BstreeOptimal.h
+ * <pre>
+ * File: BstreeOptimal.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "BstreeOptimal.h"
+#include "BstreeException.h"
+
+using namespace std;
+
+/**
+ * A range of keys [lo, hi) waiting for its subtree, in the order of the
+ * preorder; depth is that of the subtree's root
+ */
+struct ShapeRange
+{
+    size_t lo, hi;
+    long depth;
+};
+
+/**
+ * Checks the weights and gives their prefix sums
+ * @param hits the weights of the keys
+ * @param misses the weights of the gaps, or empty
+ * @param hitSum receives hitSum[k] = hits[0] + ... + hits[k - 1]
+ * @param missSum receives missSum[g] = misses[0] + ... + misses[g - 1]
+ * @throw BstreeException when the weights are negative or misses has the
+ * wrong size
+ */
+static void prefixSums(const vector<double>& hits, const vector<double>& misses, vector<double>& hitSum,
+    vector<double>& missSum)
+{
+    size_t n = hits.size();
+    if (!misses.empty() && misses.size() != n + 1)
+        throw BstreeException("Exception: there must be one miss weight per gap between the keys.");
+    hitSum.assign(n + 1, 0);
+    missSum.assign(n + 2, 0);
+    for (size_t k = 0; k < n; k++)
+    {
+        if (!(hits[k] >= 0))
+            throw BstreeException("Exception: access weights must not be negative.");
+        hitSum[k + 1] = hitSum[k] + hits[k];
+    }
+    for (size_t g = 0; g <= n; g++)
+    {
+        double miss = misses.empty() ? 0 : misses[g];
+        if (!(miss >= 0))
+            throw BstreeException("Exception: access weights must not be negative.");
+        missSum[g + 1] = missSum[g] + miss;
+    }
+}
+
+vector<size_t> exactOptimalShape(const vector<double>& hits, const vector<double>& misses)
+{
+    vector<double> hitSum, missSum;
+    prefixSums(hits, misses, hitSum, missSum);
+    size_t n = hits.size();
+    size_t width = n + 1;
+    /* cost[i][j] and root[i][j] are for the keys [i, j); Knuth showed that
+       root[i][j - 1] <= root[i][j] <= root[i + 1][j], which bounds the
+       candidate roots of all ranges of one length by O(n) in total */
+    vector<double> cost(width * width, 0);
+    vector<uint32_t> root(width * width, 0);
+    for (size_t len = 1; len <= n; len++)
+    {
+        for (size_t i = 0; i + len <= n; i++)
+        {
+            size_t j = i + len;
+            size_t first = len == 1 ? i : root[i * width + j - 1];
+            size_t last = len == 1 ? i : root[(i + 1) * width + j];
+            size_t best = first;
+            double least = cost[i * width + first] + cost[(first + 1) * width + j];
+            for (size_t r = first + 1; r <= last; r++)
+            {
+                double candidate = cost[i * width + r] + cost[(r + 1) * width + j];
+                if (candidate < least)
+                {
+                    least = candidate;
+                    best = r;
+                }
+            }
+            double weight = hitSum[j] - hitSum[i] + missSum[j + 1] - missSum[i];
+            cost[i * width + j] = least + weight;
+            root[i * width + j] = static_cast<uint32_t>(best);
+        }
+    }
+
+    vector<size_t> preorder;
+    preorder.reserve(n);
+    vector<ShapeRange> ranges;
+    ranges.push_back({ 0, n, 0 });
+    while (!ranges.empty())
+    {
+        ShapeRange range = ranges.back();
+        ranges.pop_back();
+        if (range.lo == range.hi)
+            continue;
+        size_t r = root[range.lo * width + range.hi];
+        preorder.push_back(r);
+        ranges.push_back({ r + 1, range.hi, range.depth + 1 });
+        ranges.push_back({ range.lo, r, range.depth + 1 });
+    }
+    return preorder;
+}
+
+vector<size_t> weightBalancedShape(const vector<double>& hits, const vector<double>& misses)
+{
+    vector<double> hitSum, missSum;
+    prefixSums(hits, misses, hitSum, missSum);
+    size_t n = hits.size();
+
+    vector<size_t> preorder;
+    preorder.reserve(n);
+    vector<ShapeRange> ranges;
+    ranges.push_back({ 0, n, 0 });
+    while (!ranges.empty())
+    {
+        ShapeRange range = ranges.back();
+        ranges.pop_back();
+        size_t i = range.lo, j = range.hi;
+        if (i == j)
+            continue;
+        /* the weight left of root r grows with r and the weight right of it
+           shrinks, so the balance point is found by binary search */
+        auto below = [&](size_t r) { return hitSum[r] - hitSum[i] + missSum[r + 1] - missSum[i]; };
+        auto above = [&](size_t r) { return hitSum[j] - hitSum[r + 1] + missSum[j + 1] - missSum[r + 1]; };
+        size_t lo = i, hi = j - 1;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (below(mid) >= above(mid))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        size_t r = lo;
+        if (r > i && above(r - 1) - below(r - 1) < below(r) - above(r))
+            r--;
+        /* with no weight at all, fall back to the middle key */
+        if (hitSum[j] - hitSum[i] + missSum[j + 1] - missSum[i] == 0)
+            r = i + (j - i) / 2;
+        preorder.push_back(r);
+        ranges.push_back({ r + 1, j, range.depth + 1 });
+        ranges.push_back({ i, r, range.depth + 1 });
+    }
+    return preorder;
+}
+
+vector<size_t> optimalShape(const vector<double>& hits, const vector<double>& misses)
+{
+    if (hits.size() <= OPTIMAL_EXACT_LIMIT)
+        return exactOptimalShape(hits, misses);
+    return weightBalancedShape(hits, misses);
+}
+
+double searchCost(const vector<size_t>& preorder, const vector<double>& hits, const vector<double>& misses)
+{
+    size_t n = hits.size();
+    if (preorder.size() != n || (!misses.empty() && misses.size() != n + 1))
+        throw BstreeException("Exception: the shape and the weights are of different sizes on searchCost().");
+    double cost = 0;
+    size_t next = 0;
+    vector<ShapeRange> ranges;
+    ranges.push_back({ 0, n, 0 });
+    while (!ranges.empty())
+    {
+        ShapeRange range = ranges.back();
+        ranges.pop_back();
+        if (range.lo == range.hi)
+        {
+            if (!misses.empty())
+                cost += misses[range.lo] * range.depth;
+            continue;
+        }
+        size_t r = preorder[next++];
+        if (r < range.lo || r >= range.hi)
+            throw BstreeException("Exception: the ranks are not the preorder of a tree on searchCost().");
+        cost += hits[r] * (range.depth + 1);
+        ranges.push_back({ r + 1, range.hi, range.depth + 1 });
+        ranges.push_back({ range.lo, r, range.depth + 1 });
+    }
+    return cost;
+}
@@ -0,0 +1,81 @@
+/**
+ * The specification for the construction of binary search trees of least
+ * expected search cost from access frequencies.
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeOptimal.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * Given n sorted keys, the weight hits[k] of looking up key k and the weight
+ * misses[g] of looking up a missing key in gap g (gap 0 is below key 0, gap
+ * g lies between keys g - 1 and g, gap n is above key n - 1), the cost of a
+ * tree is the weighted number of nodes visited by all these lookups. The
+ * shape of a tree is given as the ranks of its keys in preorder, which a
+ * tree relinks in one pass over its sorted nodes.
+ * - exactOptimalShape is Knuth's dynamic program: O(n^2) time and space,
+ *   minimum cost
+ * - weightBalancedShape is Mehlhorn's rule of rooting every range at the
+ *   key that best balances the weights on its two sides: O(n log n) time,
+ *   O(n) space, and a cost within a small constant of the minimum
+ * </pre>
+ */
+
+#include <vector>
+#include <cstddef>
+
+#ifndef BSTREEOPTIMAL_H
+#define BSTREEOPTIMAL_H
+
+using namespace std;
+
+/**
+ * The largest number of keys for which optimalShape runs the exact dynamic
+ * program; its tables take about 20 bytes per pair of keys
+ */
+const size_t OPTIMAL_EXACT_LIMIT = 1024;
+
+/**
+ * Computes a tree of minimum expected cost (Knuth)
+ * @param hits the weights of the keys, in key order
+ * @param misses the weights of the n + 1 gaps, or empty for no misses
+ * @return the ranks of the keys in the preorder of the tree
+ * @throw BstreeException when the weights are negative or misses has the
+ * wrong size
+ */
+vector<size_t> exactOptimalShape(const vector<double>& hits, const vector<double>& misses);
+
+/**
+ * Computes a weight-balanced tree of near minimum expected cost (Mehlhorn)
+ * @param hits the weights of the keys, in key order
+ * @param misses the weights of the n + 1 gaps, or empty for no misses
+ * @return the ranks of the keys in the preorder of the tree
+ * @throw BstreeException when the weights are negative or misses has the
+ * wrong size
+ */
+vector<size_t> weightBalancedShape(const vector<double>& hits, const vector<double>& misses);
+
+/**
+ * Computes the exact optimum for up to OPTIMAL_EXACT_LIMIT keys and a
+ * weight-balanced tree beyond
+ * @param hits the weights of the keys, in key order
+ * @param misses the weights of the n + 1 gaps, or empty for no misses
+ * @return the ranks of the keys in the preorder of the tree
+ * @throw BstreeException when the weights are negative or misses has the
+ * wrong size
+ */
+vector<size_t> optimalShape(const vector<double>& hits, const vector<double>& misses);
+
+/**
+ * Gives the expected cost of a tree: the weighted number of nodes visited
+ * by the lookups of the keys and of the gaps
+ * @param preorder the ranks of the keys in the preorder of the tree
+ * @param hits the weights of the keys, in key order
+ * @param misses the weights of the n + 1 gaps, or empty for no misses
+ * @return the cost
+ * @throw BstreeException when the arguments do not describe a tree
+ */
+double searchCost(const vector<size_t>& preorder, const vector<double>& hits, const vector<double>& misses);
+#endif //BSTREEOPTIMAL_H
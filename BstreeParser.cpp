@@ -25,6 +25,67 @@
  *    parent = ? or NONE, left-child = ? or NONE, right-child = ? or NONE
  *    sibling = ? or NONE, sibling's left-child = ? or NONE, sibling's right-child = ? or NONE
  *    #ancestors = ?, #descendants = ?
+ * save <file> : writes the tree to a binary snapshot file
+ * open <file> : replaces the tree with the contents of a snapshot file
+ * stats: displays the instrumentation counters of the tree; they are only
+ *        collected when the parser is compiled with -DBSTREE_STATS
+ * compact: rebuilds the tree into perfect balance, freeing the tombstones
+ *          left by lazy deletes
+ * optimize: reshapes the tree into the one of least expected search cost
+ *           for the gen statements run so far; every entry also counts as
+ *           looked up once, so a tree that was never queried is balanced
+ * mem: displays the memory held by the tree: its nodes, the storage its
+ *      items hold outside them, its hash index, its cached traversals,
+ *      the estimated allocator overhead and the peak total; the figures
+ *      are kept as the tree allocates, so the statement does not walk the
+ *      tree
+ *
+ * A run of insert and delete statements is buffered and applied as one
+ * batch (see Bstree::apply_batch) before the next statement of another
+ * kind, or once it grows to MUTATIONS_PER_FLUSH statements. The batch
+ * builds the tree the statements would have built one at a time, so the
+ * output is the same. With --profile, the insert and delete latencies
+ * cover buffering the statement only; applying it is reported as batch.
+ *
+ * Options:
+ * --journal=<dir> : recovers the tree from the checkpoint and command journal
+ *                   in <dir> before running the program, and journals every
+ *                   insert and delete applied by the program
+ * --stats         : displays the instrumentation counters on the standard
+ *                   error stream when the program ends
+ * --profile       : times every statement and displays the count, throughput
+ *                   and p50/p99/p99.9 latency of each kind of statement on
+ *                   the standard error stream when the program ends
+ * --profile-json=<file> : as --profile, and also writes the figures to <file>
+ *                   as JSON
+ * --engine=bst|art : the tree implementation; bst (the default) is Bstree,
+ *                   art is ArtBstree, which builds the same tree but locates
+ *                   keys through an adaptive radix tree. --journal requires
+ *                   the bst engine.
+ * --scapegoat[=<alpha>] : balances the tree with the scapegoat policy and
+ *                   lazy deletes (see Bstree.h); alpha is in (0.5, 1) and
+ *                   defaults to 0.7. Requires the bst engine.
+ * --index         : keeps a hash index from the keys to their nodes (see
+ *                   Bstree.h), so that lookups and the genealogy of a gen
+ *                   find the entry without descending. Requires the bst
+ *                   engine.
+ * --key-type=int64|uint64|double|string : the type of the keys; string (the
+ *                   default) orders the arguments lexicographically, the
+ *                   others parse them with from_chars and order them as
+ *                   numbers. An argument that is not a key of the type is a
+ *                   parsing error. Requires the bst engine for a type other
+ *                   than string.
+ * --serve=<socket> : instead of running a program, keeps the tree resident
+ *                   and runs the statements that local clients send over
+ *                   the Unix domain socket <socket>, replying to each
+ *                   client with the output of its statements, until SIGINT
+ *                   or SIGTERM. Clients may pipeline statements; a failing
+ *                   statement is answered with the reason and closes its
+ *                   connection. Only the user running the server may
+ *                   connect. The statements of all clients run on one
+ *                   thread in one serial order, and with --journal each
+ *                   reply is only written once the journal holds the
+ *                   mutations before it.
  *
  * </pre>
  */
@@ -35,137 +96,1382 @@
 #include <iomanip>
 #include <cmath>
 #include <vector>
+#include <thread>
+#include <sstream>
+#include <chrono>
+#include <map>
+#include <charconv>
+#include <system_error>
+#include <type_traits>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cctype>
+#include <csignal>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include "Bstree.cpp"
+#include "SpscQueue.cpp"
+#include "BstreeJournal.cpp"
+#include "BstreeProfiler.h"
+#include "ArtBstree.h"
 
 
 using namespace std;
 
 /**
- * Displays a string and advances the cursor to the next line
- * @param word the string to be displayed
+ * The number of commands the reader groups into one batch before handing
+ * them to the executor; batching amortizes the cost of the queue hand-off.
+ */
+const size_t COMMANDS_PER_BATCH = 1024;
+
+/**
+ * The number of batches that may be in flight between two adjacent stages
+ */
+const size_t BATCHES_IN_FLIGHT = 16;
+
+/**
+ * The number of inserts and deletes the executor buffers before it applies
+ * them, if no statement of another kind comes first
+ */
+const size_t MUTATIONS_PER_FLUSH = 1 << 16;
+
+/**
+ * The statements of the binary search tree language
+ */
+enum CommandType { DELETE_CMD, INSERT_CMD, TRAVERSE_CMD, PROP_CMD, GEN_CMD, SAVE_CMD, OPEN_CMD, STATS_CMD,
+    COMPACT_CMD, OPTIMIZE_CMD, MEM_CMD, INVALID_CMD, ERROR_CMD, EXIT_REPORT };
+
+/**
+ * The names of the statements, indexed by CommandType
+ */
+const char* const COMMAND_NAMES[] = { "delete", "insert", "traverse", "prop", "gen", "save", "open", "stats",
+    "compact", "optimize", "mem" };
+
+/**
+ * A tokenized statement produced by the reader stage
+ */
+struct Command
+{
+    /**
+     * the statement
+     */
+    CommandType type;
+    /**
+     * the argument of a delete, insert, gen, save or open statement
+     */
+    string token;
+};
+
+/**
+ * The outcome of executing a statement; everything the formatting stage
+ * needs is copied out of the tree so that the tree may be mutated by the
+ * next statement while this one is being displayed.
+ */
+struct Result
+{
+    /**
+     * the statement that produced this result, ERROR_CMD, or EXIT_REPORT
+     * for the report displayed on the standard error stream at the end
+     */
+    CommandType type;
+    /**
+     * the argument of the statement, or the reason for an ERROR_CMD
+     */
+    string token;
+    /**
+     * gen: whether the entry is in the tree
+     */
+    bool found;
+    /**
+     * prop: the height and size of the tree
+     */
+    long height, size;
+    /**
+     * prop: whether the tree is perfect, isomorphic and Fibonacci
+     */
+    bool perfect, isomorphic, fibonacci;
+    /**
+     * gen: the parent, sibling, left-child and right-child of the entry,
+     * "NONE" for a missing relative
+     */
+    string relatives[4];
+    /**
+     * traverse: the preorder, inorder and postorder sequences
+     */
+    vector<string> lists[3];
+    /**
+     * gen: the counted lines of ancestors and of descendants of the entry,
+     * formatted straight from the tree
+     */
+    string lineage[2];
+    /**
+     * stats, mem and EXIT_REPORT: the preformatted report
+     */
+    string report;
+};
+
+/**
+ * The settings given on the command line
+ */
+struct Options
+{
+    /**
+     * the name of the program to be parsed
+     */
+    string filename;
+    /**
+     * the journal directory, or empty when journaling is off
+     */
+    string journal;
+    /**
+     * whether the instrumentation counters are displayed at the end
+     */
+    bool stats = false;
+    /**
+     * whether every statement is timed
+     */
+    bool profile = false;
+    /**
+     * the file the profile is written to as JSON, or empty
+     */
+    string profileJson;
+    /**
+     * the tree implementation: "bst" or "art"
+     */
+    string engine = "bst";
+    /**
+     * the scapegoat balance factor, or 0 for a plain binary search tree
+     */
+    double scapegoat = 0;
+    /**
+     * whether the tree keeps a hash index
+     */
+    bool index = false;
+    /**
+     * the type of the keys: "int64", "uint64", "double" or "string"
+     */
+    string keyType = "string";
+    /**
+     * the path of the socket to serve clients on, or empty to run a program
+     */
+    string serve;
+};
+
+typedef vector<Command> CommandBatch;
+typedef vector<Result> ResultBatch;
+
+/**
+ * Converts between the arguments of statements and the keys of the tree
+ * @param <K> the type of the keys
+ */
+template <typename K, typename Enable = void> struct KeyCodec;
+
+/**
+ * Arithmetic keys are parsed with from_chars, straight from the characters
+ * of the argument, and displayed in the shortest form that parses back to
+ * the same key
+ */
+template <typename K>
+struct KeyCodec<K, typename enable_if<is_arithmetic<K>::value>::type>
+{
+    /**
+     * Parses an argument
+     * @param token the argument
+     * @param filename the name of the program, for error reporting
+     * @return the key
+     * @throw BstreeException when the argument is not a key of this type;
+     * the whole argument must be consumed, and NaN is refused since it is
+     * not ordered
+     */
+    static K parse(const string& token, const string& filename)
+    {
+        K key;
+        const char* last = token.data() + token.size();
+        from_chars_result parsed = from_chars(token.data(), last, key);
+        if (parsed.ec != errc() || parsed.ptr != last || !(key == key))
+            throw BstreeException(filename + " parsing error: " + token + " is not a valid key");
+        return key;
+    }
+
+    /**
+     * Displays a key
+     * @param key the key
+     * @return the text of the key
+     */
+    static string text(K key)
+    {
+        char buffer[32];
+        to_chars_result shown = to_chars(buffer, buffer + sizeof(buffer), key);
+        return string(buffer, shown.ptr);
+    }
+};
+
+/**
+ * String keys are the arguments themselves
  */
-void printWord(const string& word)
+template <>
+struct KeyCodec<string>
 {
-    cout << word << endl;
+    /**
+     * Parses an argument
+     * @param token the argument
+     * @param filename the name of the program, for error reporting; every
+     * string is a key, so none is reported
+     * @return the key: the argument itself
+     */
+    static const string& parse(const string& token, const string&)
+    {
+        return token;
+    }
+
+    /**
+     * Displays a key
+     * @param key the key
+     * @return the key itself
+     */
+    static const string& text(const string& key)
+    {
+        return key;
+    }
+};
+
+/**
+ * The number of gen statements run for each argument, whether or not it was
+ * in the tree; optimize turns them into access frequencies
+ * @param <K> the type of the keys
+ */
+template <typename K>
+using LookupCounts = map<K, long>;
+
+/**
+ * The state the executor keeps between statements
+ * @param <Tree> the tree type: a Bstree or an ArtBstree
+ */
+template <typename Tree>
+struct Session
+{
+    /**
+     * the type of the keys of the tree
+     */
+    typedef typename Tree::Relatives::iterator::value_type Key;
+    /**
+     * the gen statements run so far
+     */
+    LookupCounts<Key> lookups;
+    /**
+     * the position of the last insert into an ArtBstree; a run of inserts
+     * continues from it, so nearly sorted input does not descend from the
+     * root every time. Bstree::apply_batch keeps a finger of its own.
+     */
+    typename Tree::Finger finger;
+    /**
+     * the inserts and deletes run since the last statement of another
+     * kind, in order; they reach the tree when flushMutations applies them
+     */
+    vector<typename Bstree<Key>::Op> mutations;
+};
+
+/**
+ * The list that collectWord appends to; the traversal functions only accept
+ * a plain function pointer, so the executor points this at its destination
+ * before each traversal.
+ */
+static vector<string>* collected = nullptr;
+
+/**
+ * Appends the text of an entry to the list being collected by the executor
+ * @param word the entry to be collected
+ */
+template <typename K>
+void collectWord(const K& word)
+{
+    collected->push_back(KeyCodec<K>::text(word));
 }
 
-int main(int argc, char** argv)
+/**
+ * The list of entries that collectKey appends to, for optimize
+ */
+template <typename K>
+vector<K>* collectedKeys = nullptr;
+
+/**
+ * Appends an entry to the list of entries being collected by optimize
+ * @param key the entry to be collected
+ */
+template <typename K>
+void collectKey(const K& key)
+{
+    collectedKeys<K>->push_back(key);
+}
+
+/**
+ * Gives the text of the data pointed to, or "NONE" for a null pointer
+ * @param item a pointer to an entry of the tree or null
+ * @return the text of the entry or "NONE"
+ */
+template <typename K>
+string entryOrNone(const K* item)
+{
+    return item == nullptr ? "NONE" : string(KeyCodec<K>::text(*item));
+}
+
+/**
+ * Gives the statement a word names
+ * @param name the first word of a statement
+ * @return the statement, or INVALID_CMD for an unknown word
+ */
+CommandType commandType(const string& name)
+{
+    CommandType type = DELETE_CMD;
+    while (type < INVALID_CMD && name != COMMAND_NAMES[type])
+        type = static_cast<CommandType>(type + 1);
+    return type;
+}
+
+/**
+ * Determines whether a statement is followed by an argument
+ * @param type the statement
+ * @return true for delete, insert, gen, save and open; otherwise, false
+ */
+bool takesArgument(CommandType type)
+{
+    return type == DELETE_CMD || type == INSERT_CMD || type == GEN_CMD || type == SAVE_CMD || type == OPEN_CMD;
+}
+
+/**
+ * The reader stage: tokenizes the program into batches of commands. An
+ * empty batch marks the end of the program; reading stops at the first
+ * unknown statement.
+ * @param inFile the program being parsed
+ * @param commands the queue to the executor stage
+ */
+void readCommands(istream& inFile, SpscQueue<CommandBatch>& commands)
+{
+    string cmd, token;
+    CommandBatch batch;
+    batch.reserve(COMMANDS_PER_BATCH);
+    while (inFile >> cmd)
+    {
+        Command command;
+        command.type = commandType(cmd);
+        if (takesArgument(command.type))
+        {
+            inFile >> token;
+            command.token = token;
+        }
+        batch.push_back(move(command));
+        if (batch.back().type == INVALID_CMD)
+            break;
+        if (batch.size() == COMMANDS_PER_BATCH)
+        {
+            commands.push(move(batch));
+            batch = CommandBatch();
+            batch.reserve(COMMANDS_PER_BATCH);
+        }
+    }
+    if (!batch.empty())
+        commands.push(move(batch));
+    commands.push(CommandBatch());
+}
+
+/**
+ * Renders the instrumentation counters of a tree
+ * @param words the tree
+ * @return the report
+ */
+template <typename Tree>
+string statisticsReport(const Tree& words)
+{
+    const BstreeStats* stats = words.statistics();
+    if (!stats)
+        return "instrumentation disabled; compile with -DBSTREE_STATS to collect it\n";
+    ostringstream report;
+    stats->report(report);
+    return report.str();
+}
+
+/**
+ * Renders the memory held by a Bstree
+ * @param words the tree
+ * @return the report
+ */
+template <typename K>
+string memoryReport(const Bstree<K>& words)
+{
+    ostringstream report;
+    words.memory_usage().report(report);
+    return report.str();
+}
+
+/**
+ * Renders the memory held by an ArtBstree, which keeps no such counters
+ * @param words the tree
+ * @return the report
+ */
+string memoryReport(const ArtBstree&)
+{
+    return "memory accounting is kept by the bst engine only\n";
+}
+
+/**
+ * Reshapes a tree for the lookups counted so far. A lookup of an entry is a
+ * hit on it, and a lookup of a missing string is a miss in the gap where it
+ * would be inserted; every entry has one extra hit.
+ * @param words the tree: a Bstree or an ArtBstree
+ * @param lookups the lookups counted so far
+ */
+template <typename Tree, typename K>
+void optimize(Tree& words, const LookupCounts<K>& lookups)
+{
+    vector<K> entries;
+    collectedKeys<K> = &entries;
+    words.inorderTraverse(collectKey<K>);
+    collectedKeys<K> = nullptr;
+    vector<double> hits(entries.size(), 1);
+    vector<double> misses(entries.size() + 1, 0);
+    size_t k = 0;
+    for (const pair<const K, long>& lookup : lookups)
+    {
+        while (k < entries.size() && entries[k] < lookup.first)
+            k++;
+        if (k < entries.size() && entries[k] == lookup.first)
+            hits[k] += lookup.second;
+        else
+            misses[k] += lookup.second;
+    }
+    words.optimize(hits, misses);
+}
+
+/**
+ * Appends a comma separated list, or NONE if it is empty, and a newline
+ * @param out the text being formatted
+ * @param list the range of entries to be appended
+ */
+template <typename Range>
+void formatList(string& out, const Range& list)
+{
+    bool first = true;
+    for (const auto& word : list)
+    {
+        if (!first)
+            out += ", ";
+        out += KeyCodec<typename decay<decltype(word)>::type>::text(word);
+        first = false;
+    }
+    if (first)
+        out += "NONE";
+    out += "\n";
+}
+
+/**
+ * Applies the buffered inserts and deletes to a Bstree with
+ * Bstree::apply_batch, which builds the tree that applying them in order
+ * would
+ * @param <K> the type of the keys
+ * @param words the tree
+ * @param session the state kept between statements
+ * @param outcomes receives whether each one changed the tree, or null
+ */
+template <typename K>
+void applyMutations(Bstree<K>& words, Session<Bstree<K>>& session, vector<bool>* outcomes)
+{
+    words.apply_batch(session.mutations, outcomes);
+}
+
+/**
+ * Applies the buffered inserts and deletes to an ArtBstree one at a time;
+ * its ArtTree already finds each position without descending
+ * @param words the tree
+ * @param session the state kept between statements
+ * @param outcomes receives whether each one changed the tree, or null
+ */
+void applyMutations(ArtBstree& words, Session<ArtBstree>& session, vector<bool>* outcomes)
+{
+    for (const Bstree<string>::Op& op : session.mutations)
+    {
+        bool applied = true;
+        if (op.remove)
+            applied = words.remove(op.item);
+        else
+            words.insert(session.finger, op.item);
+        if (outcomes)
+            outcomes->push_back(applied);
+    }
+}
+
+/**
+ * Applies the inserts and deletes buffered in the session and journals
+ * those that changed the tree, timing them as one batch statement when
+ * profiling. Every statement other than insert
+ * and delete calls this first, so it sees the tree as if each statement
+ * had been applied when it was run.
+ * @param words the tree: a Bstree or an ArtBstree
+ * @param journal the journal of the tree, or null
+ * @param session the state kept between statements
+ * @param profiler receives the latency of the batch, or null
+ */
+template <typename Tree>
+void flushMutations(Tree& words, BstreeJournal<typename Session<Tree>::Key>* journal, Session<Tree>& session,
+    BstreeProfiler* profiler)
+{
+    if (session.mutations.empty())
+        return;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<bool> applied;
+    applyMutations(words, session, journal ? &applied : nullptr);
+    if (journal)
+        journal->logBatch(session.mutations, applied);
+    if (profiler)
+    {
+        chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+        profiler->record("batch", chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+    session.mutations.clear();
+}
+
+/**
+ * Applies a single statement to the tree. An insert or a delete is only
+ * buffered in the session; see flushMutations.
+ * @param words the tree: a Bstree or an ArtBstree
+ * @param journal the journal of the tree, or null
+ * @param session the state kept between statements
+ * @param command the statement to be applied
+ * @param filename the name of the program, for error reporting
+ * @param result receives the outcome of the statement
+ * @throw BstreeException when the statement is not part of the language
+ * or its argument is not a key of the tree
+ */
+template <typename Tree>
+void execute(Tree& words, BstreeJournal<typename Session<Tree>::Key>* journal, Session<Tree>& session,
+    const Command& command, const string& filename, Result& result)
+{
+    typedef KeyCodec<typename Session<Tree>::Key> Codec;
+    result.type = command.type;
+    result.token = command.token;
+    switch (command.type)
+    {
+    case DELETE_CMD:
+        session.mutations.push_back({Codec::parse(command.token, filename), true});
+        break;
+    case INSERT_CMD:
+        session.mutations.push_back({Codec::parse(command.token, filename), false});
+        break;
+    case TRAVERSE_CMD:
+        collected = &result.lists[0];
+        words.preorderTraverse(collectWord);
+        collected = &result.lists[1];
+        words.inorderTraverse(collectWord);
+        collected = &result.lists[2];
+        words.postorderTraverse(collectWord);
+        collected = nullptr;
+        break;
+    case PROP_CMD:
+        result.height = words.height();
+        result.size = words.size();
+        result.perfect = result.size == static_cast<long>(pow(2, result.height + 1)) - 1;
+        result.isomorphic = words.isomorphic();
+        result.fibonacci = words.isFibonacci();
+        break;
+    case GEN_CMD:
+    {
+        const auto& key = Codec::parse(command.token, filename);
+        session.lookups[key]++;
+        result.found = words.inTree(key);
+        if (result.found)
+        {
+            result.relatives[0] = entryOrNone(words.getParent(key));
+            result.relatives[1] = entryOrNone(words.getSibling(key));
+            result.relatives[2] = entryOrNone(words.leftChild(key));
+            result.relatives[3] = entryOrNone(words.rightChild(key));
+            /* the entries are appended as the ranges walk the tree */
+            typename Tree::Relatives ancestors = words.ancestor_range(key);
+            result.lineage[0] = "#ancestors " + to_string(ancestors.size()) + ": ";
+            formatList(result.lineage[0], ancestors);
+            typename Tree::Relatives descendants = words.descendant_range(key);
+            result.lineage[1] = "#descendants " + to_string(descendants.size()) + ": ";
+            formatList(result.lineage[1], descendants);
+        }
+        break;
+    }
+    case SAVE_CMD:
+        words.save(command.token);
+        break;
+    case OPEN_CMD:
+        words.open(command.token);
+        /* the replaced tree cannot be rebuilt from the journal */
+        if (journal)
+            journal->checkpoint();
+        break;
+    case STATS_CMD:
+        result.report = statisticsReport(words);
+        break;
+    case COMPACT_CMD:
+        words.compact();
+        break;
+    case MEM_CMD:
+        result.report = memoryReport(words);
+        break;
+    case OPTIMIZE_CMD:
+        optimize(words, session.lookups);
+        /* the journal replays keys, not shapes */
+        if (journal)
+            journal->checkpoint();
+        break;
+    default:
+        throw BstreeException(filename + " parsing error");
+    }
+}
+
+/**
+ * The formatting stage: renders the outcome of a statement as text
+ * @param out the text being formatted
+ * @param result the outcome of a statement
+ */
+void format(string& out, const Result& result)
+{
+    const string rule = "--------------------------------------\n";
+    switch (result.type)
+    {
+    case DELETE_CMD:
+        out += "deleted " + result.token + "\n";
+        break;
+    case INSERT_CMD:
+        out += "inserted " + result.token + "\n";
+        break;
+    case SAVE_CMD:
+        out += "saved " + result.token + "\n";
+        break;
+    case OPEN_CMD:
+        out += "opened " + result.token + "\n";
+        break;
+    case STATS_CMD:
+        out += "\n***Statistics***\n" + result.report + "\n";
+        break;
+    case COMPACT_CMD:
+        out += "compacted\n";
+        break;
+    case OPTIMIZE_CMD:
+        out += "optimized\n";
+        break;
+    case MEM_CMD:
+        out += "\n***Memory***\n" + result.report + "\n";
+        break;
+    case TRAVERSE_CMD:
+    {
+        const char* titles[3] = { "Preorder Traversal\n", "Inorder Traversal\n", "Postorder Traversal\n" };
+        out += "\n***Traversals***\n";
+        out += "======================================\n";
+        for (int t = 0; t < 3; t++)
+        {
+            out += titles[t];
+            out += rule;
+            for (const string& word : result.lists[t])
+                out += word + "\n";
+            out += rule;
+        }
+        out += "\n";
+        break;
+    }
+    case PROP_CMD:
+    {
+        string label1 = "?perfect = ", label2 = "?ismorphic = ", label3 = "?Fibonacci = ";
+        out += "\n***Properties***\n";
+        out += "height = " + to_string(result.height) + ", size = " + to_string(result.size) + "\n";
+        out += label1 + (result.perfect ? "true" : "false") + ", "
+            + label2 + (result.isomorphic ? "true" : "false") + ", "
+            + label3 + (result.fibonacci ? "true" : "false") + "\n\n";
+        break;
+    }
+    case GEN_CMD:
+        if (!result.found)
+            out += "***Geneology***: " + result.token + " Non-existent Entry\n\n";
+        else
+        {
+            string label0 = "parent = ", label1 = "sibling = ", label2 = "left-child = ", label3 = " right-child = ";
+            out += "\n***Geneology***: " + result.token + "\n";
+            out += label0 + result.relatives[0] + ", "
+                + label1 + result.relatives[1] + ", "
+                + label2 + result.relatives[2] + ", "
+                + label3 + result.relatives[3] + "\n";
+            out += result.lineage[0];
+            out += result.lineage[1];
+            out += "\n";
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Applies a single statement to the tree, timing it when profiling. The
+ * buffered inserts and deletes are applied before any other statement, and
+ * once MUTATIONS_PER_FLUSH of them are waiting.
+ * @param words the tree: a Bstree or an ArtBstree
+ * @param journal the journal of the tree, or null
+ * @param session the state kept between statements
+ * @param command the statement to be applied
+ * @param filename the name of the program, for error reporting
+ * @param result receives the outcome of the statement
+ * @param profiler receives the latency of the statement, or null
+ * @throw BstreeException when the statement fails; see execute
+ */
+template <typename Tree>
+void executeTimed(Tree& words, BstreeJournal<typename Session<Tree>::Key>* journal, Session<Tree>& session,
+    const Command& command, const string& filename, Result& result, BstreeProfiler* profiler)
+{
+    bool mutation = command.type == INSERT_CMD || command.type == DELETE_CMD;
+    if (!mutation)
+        flushMutations(words, journal, session, profiler);
+    if (!profiler)
+        execute(words, journal, session, command, filename, result);
+    else
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        execute(words, journal, session, command, filename, result);
+        chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+        profiler->record(COMMAND_NAMES[command.type], chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+    if (mutation && session.mutations.size() >= MUTATIONS_PER_FLUSH)
+        flushMutations(words, journal, session, profiler);
+}
+
+/**
+ * The number of events the server takes from epoll at a time
+ */
+const int EVENTS_PER_WAIT = 64;
+
+/**
+ * The number of bytes the server reads from one client in one round
+ */
+const size_t BYTES_PER_READ = 1 << 16;
+
+/**
+ * The number of bytes of replies a client may leave unread before the
+ * server stops running its statements
+ */
+const size_t REPLY_BACKLOG = 1 << 20;
+
+/**
+ * A client of the server
+ */
+struct Connection
+{
+    /**
+     * the socket of the client
+     */
+    int fd;
+    /**
+     * the bytes received and not yet run as statements
+     */
+    string input;
+    /**
+     * the replies not yet written
+     */
+    string output;
+    /**
+     * whether the client has finished sending
+     */
+    bool ended = false;
+    /**
+     * whether the connection is closed once its replies are written: the
+     * client finished sending, or a statement of it failed
+     */
+    bool closing = false;
+    /**
+     * the epoll events the connection is registered for
+     */
+    uint32_t events = 0;
+};
+
+/**
+ * Takes the next whitespace separated word from the bytes of a client. A
+ * word at the end of the bytes may still be growing, so it is only taken
+ * once the client has finished sending.
+ * @param input the bytes received
+ * @param pos the position to start at; advanced past the word
+ * @param ended whether the client has finished sending
+ * @param word receives the word
+ * @return true if a whole word was taken; otherwise, false
+ */
+bool takeWord(const string& input, size_t& pos, bool ended, string& word)
+{
+    size_t first = pos;
+    while (first < input.size() && isspace(static_cast<unsigned char>(input[first])))
+        first++;
+    size_t last = first;
+    while (last < input.size() && !isspace(static_cast<unsigned char>(input[last])))
+        last++;
+    if (first == last || (last == input.size() && !ended))
+        return false;
+    word.assign(input, first, last - first);
+    pos = last;
+    return true;
+}
+
+/**
+ * Takes the next whole statement from the bytes of a client
+ * @param client the client
+ * @param pos the position to start at; advanced past the statement
+ * @param command receives the statement
+ * @return true if a whole statement was taken; otherwise, false
+ */
+bool takeCommand(const Connection& client, size_t& pos, Command& command)
+{
+    size_t next = pos;
+    string name;
+    if (!takeWord(client.input, next, client.ended, name))
+        return false;
+    command.type = commandType(name);
+    command.token.clear();
+    if (takesArgument(command.type) && !takeWord(client.input, next, client.ended, command.token))
+        return false;
+    pos = next;
+    return true;
+}
+
+/**
+ * Creates the listening socket of the server; a stale socket file left by
+ * an earlier server is replaced, any other file is not
+ * @param path the path of the socket
+ * @return the descriptor of the socket
+ * @throw BstreeException when the socket cannot be created
+ */
+int listenOn(const string& path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw BstreeException("Exception: socket path " + path + " is too long");
+    memcpy(address.sun_path, path.c_str(), path.size());
+    struct stat status;
+    if (::stat(path.c_str(), &status) == 0)
+    {
+        if (!S_ISSOCK(status.st_mode))
+            throw BstreeException("Exception: " + path + " exists and is not a socket");
+        ::unlink(path.c_str());
+    }
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+        throw BstreeException("Exception: unable to create a socket");
+    /* the clients may save and open files as this user, so only this user
+       may connect */
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::chmod(path.c_str(), 0600) != 0 || ::listen(listener, SOMAXCONN) != 0)
+    {
+        ::close(listener);
+        throw BstreeException("Exception: unable to listen on " + path);
+    }
+    return listener;
+}
+
+/**
+ * Registers a descriptor with epoll, or changes the events it is
+ * registered for
+ * @param poller the epoll descriptor
+ * @param fd the descriptor
+ * @param events the events to wait for
+ * @param added whether the descriptor is registered already
+ */
+void watch(int poller, int fd, uint32_t events, bool added)
+{
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+    if (::epoll_ctl(poller, added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) != 0)
+        throw BstreeException("Exception: unable to watch a descriptor with epoll");
+}
+
+/**
+ * Runs the buffered statements of a client, appending their replies. A
+ * statement that fails is answered with the reason, and the rest of what
+ * the client sent is discarded, as a program stops at its first error.
+ * @param words the tree
+ * @param journal the journal of the tree, or null
+ * @param session the state kept between statements
+ * @param client the client
+ * @param profiler receives the latency of each statement, or null
+ * @param options the command line settings
+ * @return true if whole statements may remain for the next round
+ */
+template <typename Tree>
+bool runClient(Tree& words, BstreeJournal<typename Session<Tree>::Key>* journal, Session<Tree>& session,
+    Connection& client, BstreeProfiler* profiler, const Options& options)
 {
+    size_t pos = 0, ran = 0;
+    Command command;
+    while (!client.closing && ran < COMMANDS_PER_BATCH && client.output.size() < REPLY_BACKLOG
+        && takeCommand(client, pos, command))
+    {
+        Result result;
+        try
+        {
+            executeTimed(words, journal, session, command, options.serve, result, profiler);
+            format(client.output, result);
+        }
+        catch (const BstreeException& e)
+        {
+            client.output += string(e.what()) + "\n";
+            client.closing = true;
+        }
+        ran++;
+    }
+    client.input.erase(0, pos);
+    if (client.closing)
+        client.input.clear();
+    else if (client.ended && ran < COMMANDS_PER_BATCH && client.output.size() < REPLY_BACKLOG)
+    {
+        /* everything whole has run; a statement missing its argument is
+           all that can be left */
+        if (client.input.find_first_not_of(" \t\n\v\f\r") != string::npos)
+            client.output += options.serve + " parsing error\n";
+        client.closing = true;
+    }
+    return ran == COMMANDS_PER_BATCH && !client.closing;
+}
+
+/**
+ * The executor stage in server mode: runs the statements that local clients
+ * send over a Unix domain socket against the resident tree until SIGINT or
+ * SIGTERM arrives. A single thread runs every statement, so the mutations
+ * are applied in one serial order. Each round of the event loop reads from
+ * every client that is ready, runs the whole statements each of them sent,
+ * in the order the clients became ready, applies the inserts and deletes
+ * they buffered, commits the journal once for the round, and only then
+ * writes the replies, so no client sees the outcome of a mutation that
+ * could still be lost. A client may pipeline any number of statements; it
+ * is served at most COMMANDS_PER_BATCH of them per round, and none while
+ * REPLY_BACKLOG bytes of replies wait to be read.
+ * @param words the tree
+ * @param journal the journal of the tree, or null
+ * @param session the state kept between statements
+ * @param profiler receives the latency of each statement, or null
+ * @param options the command line settings
+ * @throw BstreeException when the socket cannot be set up
+ */
+template <typename Tree>
+void serveCommands(Tree& words, BstreeJournal<typename Session<Tree>::Key>* journal, Session<Tree>& session,
+    BstreeProfiler* profiler, const Options& options)
+{
+    sigset_t stops;
+    sigemptyset(&stops);
+    sigaddset(&stops, SIGINT);
+    sigaddset(&stops, SIGTERM);
+    int signals = ::signalfd(-1, &stops, SFD_NONBLOCK | SFD_CLOEXEC);
+    int poller = ::epoll_create1(EPOLL_CLOEXEC);
+    if (signals < 0 || poller < 0)
+    {
+        if (signals >= 0)
+            ::close(signals);
+        if (poller >= 0)
+            ::close(poller);
+        throw BstreeException("Exception: unable to set up the event loop");
+    }
+    int listener = -1;
+    map<int, Connection> clients;
     try
     {
-        if (argc != 2)
+        listener = listenOn(options.serve);
+        watch(poller, listener, EPOLLIN, false);
+        watch(poller, signals, EPOLLIN, false);
+        vector<int> pending;
+        epoll_event events[EVENTS_PER_WAIT];
+        bool running = true;
+        while (running)
         {
-            cerr << "Usage: BstreeParser <Bstree-Prog-Filename>" << endl;
-            exit(1);
+            /* clients with statements left from the last round are served
+               again without waiting */
+            int count = ::epoll_wait(poller, events, EVENTS_PER_WAIT, pending.empty() ? -1 : 0);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                throw BstreeException("Exception: epoll_wait failed");
+            vector<int> round;
+            round.swap(pending);
+            for (int e = 0; e < count; e++)
+            {
+                int fd = events[e].data.fd;
+                if (fd == signals)
+                    running = false;
+                else if (fd == listener)
+                {
+                    int accepted;
+                    while ((accepted = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                    {
+                        Connection& client = clients[accepted];
+                        client.fd = accepted;
+                        client.events = EPOLLIN;
+                        watch(poller, accepted, client.events, false);
+                    }
+                }
+                else
+                {
+                    Connection& client = clients[fd];
+                    if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    {
+                        char buffer[BYTES_PER_READ];
+                        ssize_t got = ::recv(fd, buffer, sizeof(buffer), 0);
+                        if (got > 0)
+                            client.input.append(buffer, got);
+                        else if (got == 0 || (errno != EAGAIN && errno != EINTR))
+                            client.ended = true;
+                    }
+                    if (find(round.begin(), round.end(), fd) == round.end())
+                        round.push_back(fd);
+                }
+            }
+            for (int fd : round)
+                if (runClient(words, journal, session, clients[fd], profiler, options))
+                    pending.push_back(fd);
+            flushMutations(words, journal, session, profiler);
+            if (journal)
+                journal->commit();
+            for (int fd : round)
+            {
+                Connection& client = clients[fd];
+                size_t written = 0;
+                while (written < client.output.size())
+                {
+                    ssize_t put = ::send(fd, client.output.data() + written, client.output.size() - written,
+                        MSG_NOSIGNAL);
+                    if (put > 0)
+                        written += put;
+                    else if (put < 0 && errno == EINTR)
+                        continue;
+                    else
+                    {
+                        /* a client that stopped reading loses its replies */
+                        if (errno != EAGAIN)
+                        {
+                            client.closing = true;
+                            written = client.output.size();
+                        }
+                        break;
+                    }
+                }
+                client.output.erase(0, written);
+                if (client.closing && client.output.empty())
+                {
+                    ::close(fd);
+                    clients.erase(fd);
+                    pending.erase(remove(pending.begin(), pending.end(), fd), pending.end());
+                    continue;
+                }
+                uint32_t wanted = (client.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT))
+                    | (client.ended || client.output.size() >= REPLY_BACKLOG ? 0u : static_cast<uint32_t>(EPOLLIN));
+                if (wanted != client.events)
+                {
+                    client.events = wanted;
+                    watch(poller, fd, wanted, true);
+                }
+            }
         }
-        string filename = argv[1];
-        fstream inFile;
-        inFile.open(filename.c_str(), ios::in);
-        if (!inFile)
+    }
+    catch (const BstreeException& e)
+    {
+        for (const pair<const int, Connection>& client : clients)
+            ::close(client.first);
+        if (listener >= 0)
+            ::close(listener);
+        ::close(poller);
+        ::close(signals);
+        throw;
+    }
+    for (const pair<const int, Connection>& client : clients)
+        ::close(client.first);
+    ::close(listener);
+    ::unlink(options.serve.c_str());
+    ::close(poller);
+    ::close(signals);
+}
+
+/**
+ * Runs the statements of the program against a tree. After an error it
+ * reports an ERROR_CMD result and discards the rest of the program.
+ * @param words the tree: a Bstree or an ArtBstree
+ * @param journal the journal of the tree, or null
+ * @param failed true when the tree could not be prepared; every statement
+ * is then discarded
+ * @param commands the queue from the reader stage
+ * @param results the queue to the formatting stage
+ * @param options the command line settings
+ */
+template <typename Tree>
+void runCommands(Tree& words, BstreeJournal<typename Session<Tree>::Key>* journal, bool failed,
+    SpscQueue<CommandBatch>& commands, SpscQueue<ResultBatch>& results, const Options& options)
+{
+    BstreeProfiler* profiler = options.profile ? new BstreeProfiler() : nullptr;
+    Session<Tree> session;
+    if (!options.serve.empty() && !failed)
+    {
+        try
+        {
+            serveCommands(words, journal, session, profiler, options);
+        }
+        catch (const BstreeException& e)
+        {
+            ResultBatch outcomes(1);
+            outcomes[0].type = ERROR_CMD;
+            outcomes[0].token = e.what();
+            results.push(move(outcomes));
+            failed = true;
+        }
+    }
+    CommandBatch batch;
+    while (options.serve.empty() && !(batch = commands.pop()).empty())
+    {
+        if (failed)
+            continue;
+        ResultBatch outcomes(batch.size());
+        size_t k = 0;
+        try
+        {
+            for (; k < batch.size(); k++)
+                executeTimed(words, journal, session, batch[k], options.filename, outcomes[k], profiler);
+        }
+        catch (const BstreeException& e)
+        {
+            outcomes[k].type = ERROR_CMD;
+            outcomes[k].token = e.what();
+            outcomes.resize(k + 1);
+            failed = true;
+        }
+        results.push(move(outcomes));
+    }
+    /* the statements before a failing one still take effect, and the
+       journal they are written to may fail as any statement does */
+    try
+    {
+        flushMutations(words, journal, session, profiler);
+    }
+    catch (const BstreeException& e)
+    {
+        ResultBatch outcomes(1);
+        outcomes[0].type = ERROR_CMD;
+        outcomes[0].token = e.what();
+        results.push(move(outcomes));
+        failed = true;
+    }
+    if (options.stats && !failed)
+    {
+        ResultBatch outcomes(1);
+        outcomes[0].type = EXIT_REPORT;
+        outcomes[0].report = "\n***Statistics***\n" + statisticsReport(words);
+        results.push(move(outcomes));
+    }
+    if (profiler)
+    {
+        ResultBatch outcomes(1);
+        ostringstream report;
+        profiler->report(report);
+        outcomes[0].type = EXIT_REPORT;
+        report << "insert and delete time the buffering only; their work on the tree is timed as batch" << endl;
+        outcomes[0].report = "\n***Profile***\n" + report.str();
+        if (!options.profileJson.empty())
+        {
+            ofstream json(options.profileJson.c_str(), ios::out | ios::trunc);
+            profiler->writeJson(json);
+            if (!json)
+                outcomes[0].report += "Unable to write " + options.profileJson + "\n";
+        }
+        results.push(move(outcomes));
+        delete profiler;
+    }
+}
+
+/**
+ * Builds a Bstree, recovers it from the journal if one is given, and runs
+ * the program against it
+ * @param <K> the type of the keys
+ * @param commands the queue from the reader stage
+ * @param results the queue to the formatting stage
+ * @param options the command line settings
+ */
+template <typename K>
+void executeBstree(SpscQueue<CommandBatch>& commands, SpscQueue<ResultBatch>& results, const Options& options)
+{
+    Bstree<K> words;
+    words.setIndexed(options.index);
+    BstreeJournal<K>* journal = nullptr;
+    bool failed = false;
+    if (!options.journal.empty())
+    {
+        journal = new BstreeJournal<K>(words, options.journal);
+        try
         {
-            cerr << "Unable to open " << filename << " for input." << endl;
-            exit(2);
+            journal->recover();
         }
-        string cmd, token;
-        Bstree<string> words;
-        while (inFile >> cmd)
+        catch (const BstreeException& e)
         {
-            if (cmd == "delete")
+            ResultBatch outcomes(1);
+            outcomes[0].type = ERROR_CMD;
+            outcomes[0].token = e.what();
+            results.push(move(outcomes));
+            failed = true;
+        }
+    }
+    /* the journal replays with eager deletes; the policy starts afterwards */
+    if (options.scapegoat > 0)
+        words.setScapegoat(options.scapegoat);
+    runCommands(words, journal, failed, commands, results, options);
+    delete journal;
+}
+
+/**
+ * The executor stage: the only thread that touches the tree. It builds the
+ * tree of the selected engine and key type and runs the program. An empty
+ * batch marks the end of the results.
+ * @param commands the queue from the reader stage
+ * @param results the queue to the formatting stage
+ * @param options the command line settings
+ */
+void executeCommands(SpscQueue<CommandBatch>& commands, SpscQueue<ResultBatch>& results, const Options& options)
+{
+    if (options.engine == "art")
+    {
+        ArtBstree words;
+        runCommands(words, nullptr, false, commands, results, options);
+    }
+    else if (options.keyType == "int64")
+        executeBstree<int64_t>(commands, results, options);
+    else if (options.keyType == "uint64")
+        executeBstree<uint64_t>(commands, results, options);
+    else if (options.keyType == "double")
+        executeBstree<double>(commands, results, options);
+    else
+        executeBstree<string>(commands, results, options);
+    results.push(ResultBatch());
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        Options options;
+        bool usage = false;
+        for (int k = 1; k < argc; k++)
+        {
+            string arg = argv[k];
+            if (arg.compare(0, 10, "--journal=") == 0)
+                options.journal = arg.substr(10);
+            else if (arg == "--stats")
+                options.stats = true;
+            else if (arg == "--profile")
+                options.profile = true;
+            else if (arg.compare(0, 15, "--profile-json=") == 0)
             {
-                inFile >> token;
-                words.remove(token);
-                cout << "deleted " << token << endl;
+                options.profile = true;
+                options.profileJson = arg.substr(15);
             }
-            else if (cmd == "insert")
+            else if (arg == "--scapegoat")
+                options.scapegoat = 0.7;
+            else if (arg.compare(0, 12, "--scapegoat=") == 0)
             {
-                inFile >> token;
-                words.insert(token);
-                cout << "inserted " << token << endl;
+                options.scapegoat = atof(arg.c_str() + 12);
+                if (!(options.scapegoat > 0.5 && options.scapegoat < 1))
+                    usage = true;
             }
-            else if (cmd == "traverse")
+            else if (arg == "--index")
+                options.index = true;
+            else if (arg.compare(0, 9, "--engine=") == 0)
             {
-                cout << endl << "***Traversals***" << endl;
-                cout << "======================================" << endl;
-                cout << "Preorder Traversal" << endl;
-                cout << "--------------------------------------" << endl;
-                words.preorderTraverse(printWord);
-                cout << "--------------------------------------" << endl;
-                cout << "Inorder Traversal" << endl;
-                cout << "--------------------------------------" << endl;
-                words.inorderTraverse(printWord);
-                cout << "--------------------------------------" << endl;
-                cout << "Postorder Traversal" << endl;
-                cout << "--------------------------------------" << endl;
-                words.postorderTraverse(printWord);
-                cout << "--------------------------------------" << endl;
-                cout << endl;
+                options.engine = arg.substr(9);
+                if (options.engine != "bst" && options.engine != "art")
+                    usage = true;
             }
-            else if (cmd == "prop")
+            else if (arg.compare(0, 11, "--key-type=") == 0)
             {
-                cout << endl << "***Properties***" << endl;
-                long treeHeight = words.height();
-                long treeSize = words.size();
-                string label1 = "?perfect = ", label2 = "?ismorphic = ", label3 = "?Fibonacci = ";
-                bool isPerfect = treeSize == static_cast<long>(pow(2, treeHeight + 1)) - 1;
-                cout << left << "height = " + to_string(treeHeight)
-                    << ", size = " + to_string(treeSize) << endl;
-                cout << label1 + (isPerfect ? "true" : "false") << ", "
-                    << label2 + (words.isomorphic() ? "true" : "false") << ", "
-                    << label3 + (words.isFibonacci() ? "true" : "false") << endl << endl;
+                options.keyType = arg.substr(11);
+                if (options.keyType != "int64" && options.keyType != "uint64" && options.keyType != "double"
+                    && options.keyType != "string")
+                    usage = true;
             }
-            else if (cmd == "gen")
+            else if (arg.compare(0, 8, "--serve=") == 0)
             {
-                inFile >> token;
-                if (!words.inTree(token))
-                    cout << "***Geneology***: " << token << " Non-existent Entry" << endl << endl;
-                else
-                {
-                    cout << endl << "***Geneology***: " << token << endl;
-                    const string* par = words.getParent(token);
-                    string paren = (par == nullptr ? "NONE" : *par);
-                    const string* sib = words.getSibling(token);
-                    string sibling = (sib == nullptr ? "NONE" : *sib);
-                    const string* lc = words.leftChild(token);
-                    string lftChild = (lc == nullptr ? "NONE" : *lc);
-                    const string* rc = words.rightChild(token);
-                    string rgtChild = (rc == nullptr ? "NONE" : *rc);
-
-                    string label0 = "parent = ", label1 = "sibling = ", label2 = "left-child = ", label3 = " right-child = ",
-                        label4 = "sibling = ", label5 = "#ancestors", label6 = "#descendants";
-                    cout << label0 + paren + ", "
-                        << label1 + sibling + ", "
-                        << label2 + lftChild + ", "
-                        << label3 + rgtChild << endl;
-                    vector<string> ances = words.ancestors(token);
-                    cout << label5 << " " << ances.size() << ": ";
-                    if (ances.size() > 0)
-                    {
-                        cout << ances[0];
-                        for (int k = 1; k < ances.size(); k++)
-                            cout << ", " << ances[k];
-                        cout << endl;
-                    }
-                    else
-                        cout << "NONE" << endl;
-                    vector<string> desc = words.descendants(token);
-                    cout << label6 << " " << desc.size() << ": ";
-                    if (desc.size() > 0)
-                    {
-                        cout << desc[0];
-                        for (int k = 1; k < desc.size(); k++)
-                            cout << ", " << desc[k];
-                        cout << endl;
-                    }
-                    else
-                        cout << "NONE" << endl;
-                    cout << endl;
-                }
+                options.serve = arg.substr(8);
+                if (options.serve.empty())
+                    usage = true;
             }
+            else if (arg.compare(0, 2, "--") == 0 || !options.filename.empty())
+                usage = true;
             else
+                options.filename = arg;
+        }
+        if (usage || options.filename.empty() == options.serve.empty()
+            || (options.engine != "bst" && (!options.journal.empty() || options.scapegoat > 0 || options.index
+                || options.keyType != "string")))
+        {
+            cerr << "Usage: BstreeParser [--engine=bst|art] [--key-type=int64|uint64|double|string] [--journal=<dir>] "
+                << "[--scapegoat[=<alpha>]] [--index] [--stats] [--profile] [--profile-json=<file>] "
+                << "(<Bstree-Prog-Filename> | --serve=<socket>)" << endl;
+            exit(1);
+        }
+        const string& filename = options.filename;
+        fstream inFile;
+        if (options.serve.empty())
+        {
+            inFile.open(filename.c_str(), ios::in);
+            if (!inFile)
             {
-                throw BstreeException(filename + " parsing error");
+                cerr << "Unable to open " << filename << " for input." << endl;
+                exit(2);
             }
         }
+        else
+        {
+            /* the server takes SIGINT and SIGTERM from a signalfd, so no
+               thread, all of which inherit this mask, may take them */
+            sigset_t stops;
+            sigemptyset(&stops);
+            sigaddset(&stops, SIGINT);
+            sigaddset(&stops, SIGTERM);
+            pthread_sigmask(SIG_BLOCK, &stops, nullptr);
+        }
+        /* reader -> executor -> formatter; this thread formats and writes.
+           A server has no reader: its executor reads from the clients. */
+        SpscQueue<CommandBatch> commands(BATCHES_IN_FLIGHT);
+        SpscQueue<ResultBatch> results(BATCHES_IN_FLIGHT);
+        thread reader;
+        if (options.serve.empty())
+            reader = thread(readCommands, ref(inFile), ref(commands));
+        thread executor(executeCommands, ref(commands), ref(results), cref(options));
+        string out, error;
+        bool failed = false;
+        ResultBatch batch;
+        while (!(batch = results.pop()).empty())
+        {
+            for (const Result& result : batch)
+            {
+                if (result.type == ERROR_CMD)
+                {
+                    error = result.token;
+                    failed = true;
+                    break;
+                }
+                if (result.type == EXIT_REPORT)
+                {
+                    cout << out << flush;
+                    out.clear();
+                    cerr << result.report;
+                    continue;
+                }
+                format(out, result);
+            }
+            cout << out << flush;
+            out.clear();
+        }
+        if (reader.joinable())
+            reader.join();
+        executor.join();
+        if (failed)
+            throw BstreeException(error);
     }
     catch (const BstreeException& e)
     {
@@ -173,4 +1479,3 @@ int main(int argc, char** argv)
     }
     return 0;
 }
-
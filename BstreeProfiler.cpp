@@ -0,0 +1,143 @@
+/**
+ * Implementation of the per-command latency profiler of BstreeParser.
+ * @author Preston Gautreaux
+ * @see BstreeProfiler.h
+ * <pre>
+ * File: BstreeProfiler.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "BstreeProfiler.h"
+
+using namespace std;
+
+LatencyHistogram::LatencyHistogram()
+{
+    const int half = 1 << (SUB_BITS - 1);
+    buckets.assign((1 << SUB_BITS) + (64 - SUB_BITS) * half, 0);
+    total = 0;
+    sum = 0;
+    smallest = 0;
+    largest = 0;
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t value)
+{
+    const uint64_t exact = 1 << SUB_BITS, half = exact / 2;
+    if (value < exact)
+        return value;
+    /* keep the SUB_BITS most significant bits of the value */
+    int shift = (63 - __builtin_clzll(value)) - SUB_BITS + 1;
+    return exact + (shift - 1) * half + ((value >> shift) - half);
+}
+
+uint64_t LatencyHistogram::highestIn(size_t index)
+{
+    const uint64_t exact = 1 << SUB_BITS, half = exact / 2;
+    if (index < exact)
+        return index;
+    int shift = (index - exact) / half + 1;
+    uint64_t top = (index - exact) % half + half;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    buckets[bucketOf(value)]++;
+    smallest = total == 0 ? value : min(smallest, value);
+    largest = max(largest, value);
+    total++;
+    sum += value;
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return total;
+}
+
+uint64_t LatencyHistogram::totalValue() const
+{
+    return sum;
+}
+
+uint64_t LatencyHistogram::minimum() const
+{
+    return smallest;
+}
+
+uint64_t LatencyHistogram::maximum() const
+{
+    return largest;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (total == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(fraction * total + 0.5);
+    rank = max<uint64_t>(1, min(rank, total));
+    uint64_t seen = 0;
+    for (size_t index = 0; index < buckets.size(); index++)
+    {
+        seen += buckets[index];
+        if (seen >= rank)
+            return min(highestIn(index), largest);
+    }
+    return largest;
+}
+
+void BstreeProfiler::record(const string& name, uint64_t nanoseconds)
+{
+    size_t k = find(names.begin(), names.end(), name) - names.begin();
+    if (k == names.size())
+    {
+        names.push_back(name);
+        histograms.push_back(LatencyHistogram());
+    }
+    histograms[k].record(nanoseconds);
+}
+
+void BstreeProfiler::report(ostream& out) const
+{
+    out << left << setw(10) << "statement" << right << setw(10) << "count" << setw(14) << "ops/s"
+        << setw(12) << "p50 ns" << setw(12) << "p99 ns" << setw(12) << "p99.9 ns" << setw(14) << "max ns" << endl;
+    for (size_t k = 0; k < names.size(); k++)
+    {
+        const LatencyHistogram& h = histograms[k];
+        double seconds = h.totalValue() / 1e9;
+        out << left << setw(10) << names[k] << right << setw(10) << h.count()
+            << setw(14) << fixed << setprecision(0) << (seconds > 0 ? h.count() / seconds : 0.0)
+            << setw(12) << h.percentile(0.50) << setw(12) << h.percentile(0.99)
+            << setw(12) << h.percentile(0.999) << setw(14) << h.maximum() << endl;
+    }
+    out << defaultfloat << setprecision(6);
+}
+
+void BstreeProfiler::writeJson(ostream& out) const
+{
+    out << "{\"statements\": [";
+    for (size_t k = 0; k < names.size(); k++)
+    {
+        const LatencyHistogram& h = histograms[k];
+        double seconds = h.totalValue() / 1e9;
+        out << (k > 0 ? "," : "") << endl << "  {\"statement\": \"" << names[k] << "\""
+            << ", \"count\": " << h.count()
+            << ", \"seconds\": " << seconds
+            << ", \"ops_per_second\": " << (seconds > 0 ? h.count() / seconds : 0.0)
+            << ", \"min_ns\": " << h.minimum()
+            << ", \"p50_ns\": " << h.percentile(0.50)
+            << ", \"p99_ns\": " << h.percentile(0.99)
+            << ", \"p999_ns\": " << h.percentile(0.999)
+            << ", \"max_ns\": " << h.maximum() << "}";
+    }
+    out << endl << "]}" << endl;
+}
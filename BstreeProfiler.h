@@ -0,0 +1,139 @@
+/**
+ * The specification for the per-command latency profiler of BstreeParser.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: BstreeProfiler.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifndef BSTREEPROFILER_H
+#define BSTREEPROFILER_H
+
+using namespace std;
+
+/**
+ * A log-linear histogram of latencies: values below 32 have a bucket each,
+ * and every power-of-two range above is split into 16 equal buckets, so a
+ * reported percentile is within about 6% of the true value while the
+ * histogram stays under a thousand counters.
+ */
+class LatencyHistogram
+{
+private:
+    /**
+     * log2 of the number of exact buckets at the bottom of the range
+     */
+    static const int SUB_BITS = 5;
+    /**
+     * the bucket counters
+     */
+    vector<uint64_t> buckets;
+    /**
+     * the number of recorded values, their sum, minimum and maximum
+     */
+    uint64_t total, sum, smallest, largest;
+
+    /**
+     * Gives the bucket of a value
+     * @param value a latency
+     * @return the index of its bucket
+     */
+    static size_t bucketOf(uint64_t value);
+
+    /**
+     * Gives the largest value that falls in a bucket
+     * @param index the index of a bucket
+     * @return the largest value of the bucket
+     */
+    static uint64_t highestIn(size_t index);
+
+public:
+    /**
+     * Creates an empty histogram
+     */
+    LatencyHistogram();
+
+    /**
+     * Records a latency
+     * @param value the latency
+     */
+    void record(uint64_t value);
+
+    /**
+     * Gives the number of recorded values
+     * @return the number of recorded values
+     */
+    uint64_t count() const;
+
+    /**
+     * Gives the sum of the recorded values
+     * @return the sum of the recorded values
+     */
+    uint64_t totalValue() const;
+
+    /**
+     * Gives the smallest recorded value
+     * @return the smallest recorded value, or 0 when the histogram is empty
+     */
+    uint64_t minimum() const;
+
+    /**
+     * Gives the largest recorded value
+     * @return the largest recorded value, or 0 when the histogram is empty
+     */
+    uint64_t maximum() const;
+
+    /**
+     * Gives a percentile of the recorded values
+     * @param fraction the percentile as a fraction, e.g. 0.999
+     * @return the upper bound of the bucket holding that percentile, clamped
+     * to the largest recorded value; 0 when the histogram is empty
+     */
+    uint64_t percentile(double fraction) const;
+};
+
+/**
+ * Collects the latency of every statement executed by the parser, by
+ * statement name, and reports percentiles and throughput per statement
+ */
+class BstreeProfiler
+{
+private:
+    /**
+     * the statement names, in order of first appearance
+     */
+    vector<string> names;
+    /**
+     * the latencies of each statement, in nanoseconds
+     */
+    vector<LatencyHistogram> histograms;
+
+public:
+    /**
+     * Records the execution of a statement
+     * @param name the name of the statement
+     * @param nanoseconds the time it took
+     */
+    void record(const string& name, uint64_t nanoseconds);
+
+    /**
+     * Displays count, throughput and p50/p99/p99.9/max per statement
+     * @param out the stream to display the report on
+     */
+    void report(ostream& out) const;
+
+    /**
+     * Writes the same figures as report as a JSON object
+     * @param out the stream to write to
+     */
+    void writeJson(ostream& out) const;
+};
+#endif //BSTREEPROFILER_H
@@ -0,0 +1,82 @@
+/**
+ * Implementation of the background thread that frees detached trees.
+ * @author Preston Gautreaux
+ * @see BstreeReclaimer.h
+ * <pre>
+ * File: BstreeReclaimer.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include "BstreeReclaimer.h"
+
+using namespace std;
+
+BstreeReclaimer::BstreeReclaimer()
+{
+    busy = false;
+    stopping = false;
+    worker = thread(&BstreeReclaimer::run, this);
+}
+
+BstreeReclaimer::~BstreeReclaimer()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    queued.notify_one();
+    worker.join();
+}
+
+void BstreeReclaimer::defer(void* garbage, Reclaim reclaim)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        jobs.push_back({ garbage, reclaim });
+    }
+    queued.notify_one();
+}
+
+void BstreeReclaimer::drain()
+{
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this] { return jobs.empty() && !busy; });
+}
+
+void BstreeReclaimer::run()
+{
+    vector<Job> batch;
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        queued.wait(guard, [this] { return !jobs.empty() || stopping; });
+        if (jobs.empty())
+            break;
+        /* free the whole queue outside the lock, so defer never waits for
+           a tree to be freed */
+        batch.swap(jobs);
+        busy = true;
+        guard.unlock();
+        for (const Job& job : batch)
+            job.reclaim(job.garbage);
+        batch.clear();
+        guard.lock();
+        busy = false;
+        if (jobs.empty())
+            idle.notify_all();
+    }
+}
+
+BstreeReclaimer& BstreeReclaimer::shared()
+{
+    static BstreeReclaimer reclaimer;
+    return reclaimer;
+}
@@ -0,0 +1,124 @@
+/**
+ * The specification for a background thread that frees detached trees.
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: BstreeReclaimer.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * Freeing a tree of n nodes takes n calls to delete; for tens of millions
+ * of nodes that is seconds. A tree that is given a reclaimer detaches its
+ * nodes instead when it is destroyed, cleared or replaced, and hands them
+ * to the reclaimer's thread, so the caller only pays for the hand-off.
+ * The garbage is queued with the function that frees it, so one reclaimer
+ * serves trees of every type. The destructor frees whatever is still
+ * queued before the thread is joined.
+ * </pre>
+ */
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#ifndef BSTREERECLAIMER_H
+#define BSTREERECLAIMER_H
+
+using namespace std;
+
+/**
+ * A thread that frees detached trees in the background
+ */
+class BstreeReclaimer
+{
+public:
+    /**
+     * a function that frees a detached tree
+     */
+    typedef void (*Reclaim)(void* garbage);
+
+private:
+    /**
+     * a detached tree and the function that frees it
+     */
+    struct Job
+    {
+        void* garbage;
+        Reclaim reclaim;
+    };
+    /**
+     * guards jobs, busy and stopping
+     */
+    mutex lock;
+    /**
+     * signalled when a job is queued or the reclaimer stops
+     */
+    condition_variable queued;
+    /**
+     * signalled when the queue runs empty
+     */
+    condition_variable idle;
+    /**
+     * the trees waiting to be freed
+     */
+    vector<Job> jobs;
+    /**
+     * whether the thread is freeing a batch of jobs
+     */
+    bool busy;
+    /**
+     * set by the destructor to stop the thread once the queue is empty
+     */
+    bool stopping;
+    /**
+     * the thread that frees the trees
+     */
+    thread worker;
+
+    /**
+     * The body of the thread: frees the queued trees in batches until the
+     * reclaimer stops
+     */
+    void run();
+
+public:
+    /**
+     * Starts the thread
+     */
+    BstreeReclaimer();
+
+    /**
+     * The thread is shared by every tree handed to it and must not be
+     * copied
+     */
+    BstreeReclaimer(const BstreeReclaimer& other) = delete;
+    BstreeReclaimer& operator=(const BstreeReclaimer& other) = delete;
+
+    /**
+     * Frees the trees still queued and joins the thread
+     */
+    ~BstreeReclaimer();
+
+    /**
+     * Queues a detached tree to be freed; returns at once
+     * @param garbage the tree; it must no longer be reachable by its owner
+     * @param reclaim the function that frees it, called on the thread
+     */
+    void defer(void* garbage, Reclaim reclaim);
+
+    /**
+     * Waits until every tree queued so far has been freed
+     */
+    void drain();
+
+    /**
+     * Gives a reclaimer shared by the whole program, started on first use
+     * and stopped at exit; trees that use it must not be destroyed by the
+     * destructors of other static objects
+     * @return the shared reclaimer
+     */
+    static BstreeReclaimer& shared();
+};
+#endif //BSTREERECLAIMER_H
@@ -0,0 +1,534 @@
+/**
+ * The specification of the versioned binary snapshot format written by
+ * Bstree<T>::save and read by Bstree<T>::open.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: BstreeSnapshot.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * A snapshot file has three sections, each starting on an 8-byte boundary:
+ * 1. a SnapshotHeader, holding the CRC-32 of the two sections after it
+ * 2. one shape byte per node in preorder: bit 0 is set when the node has a
+ *    left child, bit 1 when it has a right child
+ * 3. the keys in preorder, laid out by SnapshotCodec<T>: arithmetic keys are
+ *    stored as a plain array; string keys as count + 1 offsets followed by a
+ *    contiguous pool of characters
+ * A preorder sequence plus the shape bytes determines the tree, so it can be
+ * rebuilt in O(n) without comparing any keys. Since no key is compared, a
+ * damaged byte would load as a misordered tree; the reader checks the CRC
+ * first and rejects the file instead. Version 1 snapshots, written before
+ * the CRC was added, are still read, unchecked. writeSnapshot and
+ * SnapshotReader handle the file itself, so every tree engine that can list
+ * its keys and shape in preorder shares the format.
+ * </pre>
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "BstreeException.h"
+
+#ifndef BSTREESNAPSHOT_H
+#define BSTREESNAPSHOT_H
+
+using namespace std;
+
+/**
+ * the first four bytes of every snapshot
+ */
+const char SNAPSHOT_MAGIC[4] = { 'B', 'S', 'T', 'S' };
+/**
+ * the version of the layout described above
+ */
+const uint32_t SNAPSHOT_VERSION = 2;
+/**
+ * written in host byte order; a snapshot from a machine of the other
+ * byte order is rejected
+ */
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+/**
+ * The fixed-size header at the start of a snapshot
+ */
+struct SnapshotHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    /**
+     * identifies the key encoding; see SnapshotCodec<T>::KIND
+     */
+    uint32_t keyKind;
+    /**
+     * the number of nodes in the tree
+     */
+    uint64_t count;
+    /**
+     * the size in bytes of the key section
+     */
+    uint64_t keyBytes;
+    /**
+     * the CRC-32 of the shape and key sections, padding included; absent
+     * from version 1
+     */
+    uint32_t checksum;
+    /**
+     * zero; keeps the sections 8-byte aligned
+     */
+    uint32_t reserved;
+};
+
+/**
+ * the size of the header of a version 1 snapshot, which ends before the
+ * checksum
+ */
+const size_t SNAPSHOT_V1_HEADER = offsetof(SnapshotHeader, checksum);
+
+/**
+ * Continues a CRC-32 (the polynomial of zlib and PNG) over more bytes
+ * @param crc the CRC of the bytes before, or 0 to start
+ * @param bytes the bytes
+ * @param length the number of bytes
+ * @return the CRC of all the bytes so far
+ */
+inline uint32_t snapshotCrc(uint32_t crc, const char* bytes, size_t length)
+{
+    static const vector<uint32_t> table = []()
+    {
+        vector<uint32_t> entries(256);
+        for (uint32_t k = 0; k < 256; k++)
+        {
+            uint32_t entry = k;
+            for (int bit = 0; bit < 8; bit++)
+                entry = (entry & 1) ? 0xEDB88320u ^ (entry >> 1) : entry >> 1;
+            entries[k] = entry;
+        }
+        return entries;
+    }();
+    crc = ~crc;
+    for (size_t k = 0; k < length; k++)
+        crc = table[(crc ^ static_cast<unsigned char>(bytes[k])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/**
+ * A file being written as a snapshot that keeps the CRC of what it has
+ * written since it was opened
+ */
+class SnapshotSink
+{
+private:
+    /**
+     * the file
+     */
+    ofstream& out;
+    /**
+     * the CRC of the bytes written so far
+     */
+    uint32_t crc;
+
+public:
+    /**
+     * Starts the CRC at the current position of a file
+     * @param out the file
+     */
+    SnapshotSink(ofstream& out) : out(out), crc(0)
+    {
+    }
+
+    /**
+     * Writes bytes to the file and adds them to the CRC
+     * @param bytes the bytes
+     * @param length the number of bytes
+     */
+    void write(const char* bytes, size_t length)
+    {
+        out.write(bytes, length);
+        crc = snapshotCrc(crc, bytes, length);
+    }
+
+    /**
+     * Gives the CRC of the bytes written so far
+     * @return the CRC
+     */
+    uint32_t checksum() const
+    {
+        return crc;
+    }
+};
+
+/**
+ * Rounds a size up to the next multiple of 8
+ * @param bytes a size in bytes
+ * @return the padded size
+ */
+inline uint64_t snapshotPad(uint64_t bytes)
+{
+    return (bytes + 7) & ~static_cast<uint64_t>(7);
+}
+
+/**
+ * Encodes and decodes the key section of a snapshot. Only arithmetic and
+ * string keys are supported; saving any other tree does not compile.
+ * @param <T> the key type
+ */
+template <typename T, typename Enable = void> struct SnapshotCodec;
+
+/**
+ * The codec for arithmetic keys: a plain array of T
+ */
+template <typename T>
+struct SnapshotCodec<T, typename enable_if<is_arithmetic<T>::value>::type>
+{
+    /**
+     * the key kind recorded in the header: the size of T, with bit 8 set for
+     * floating point and bit 9 set for signed integers
+     */
+    static const uint32_t KIND = sizeof(T) | (is_floating_point<T>::value ? 0x100 : 0)
+        | (is_signed<T>::value && !is_floating_point<T>::value ? 0x200 : 0);
+
+    /**
+     * Gives the size of the key section for the specified keys
+     * @param keys the keys in preorder
+     * @return the size in bytes
+     */
+    static uint64_t keyBytes(const vector<const T*>& keys)
+    {
+        return keys.size() * sizeof(T);
+    }
+
+    /**
+     * Writes the key section
+     * @param out the snapshot being written
+     * @param keys the keys in preorder
+     */
+    static void write(SnapshotSink& out, const vector<const T*>& keys)
+    {
+        for (const T* key : keys)
+            out.write(reinterpret_cast<const char*>(key), sizeof(T));
+    }
+
+    /**
+     * Determines whether a mapped key section is well formed
+     * @param section the start of the key section
+     * @param bytes the size of the key section
+     * @param count the number of keys
+     * @return true if the section can be decoded; otherwise, false
+     */
+    static bool valid([[maybe_unused]] const char* section, uint64_t bytes, uint64_t count)
+    {
+        return bytes == count * sizeof(T);
+    }
+
+    /**
+     * Decodes one key from a validated key section
+     * @param section the start of the key section
+     * @param count the number of keys
+     * @param index the preorder position of the key
+     * @return the key
+     */
+    static T read(const char* section, [[maybe_unused]] uint64_t count, uint64_t index)
+    {
+        T key;
+        memcpy(&key, section + index * sizeof(T), sizeof(T));
+        return key;
+    }
+
+    /**
+     * Appends a single self-delimited key; used by the journal records
+     * @param out the buffer being written
+     * @param key the key to be encoded
+     */
+    static void encode(string& out, const T& key)
+    {
+        out.append(reinterpret_cast<const char*>(&key), sizeof(T));
+    }
+
+    /**
+     * Decodes a single key written by encode
+     * @param bytes the encoded key
+     * @param length the size of the encoded key
+     * @param key receives the key
+     * @return true if the bytes are a well-formed key; otherwise, false
+     */
+    static bool decode(const char* bytes, uint64_t length, T& key)
+    {
+        if (length != sizeof(T))
+            return false;
+        memcpy(&key, bytes, sizeof(T));
+        return true;
+    }
+};
+
+/**
+ * The codec for string keys: count + 1 offsets into a contiguous pool
+ */
+template <>
+struct SnapshotCodec<string>
+{
+    /**
+     * the key kind recorded in the header
+     */
+    static const uint32_t KIND = 0x400;
+
+    /**
+     * Gives the size of the key section for the specified keys
+     * @param keys the keys in preorder
+     * @return the size in bytes: the offsets and the pool
+     */
+    static uint64_t keyBytes(const vector<const string*>& keys)
+    {
+        uint64_t pool = 0;
+        for (const string* key : keys)
+            pool += key->size();
+        return (keys.size() + 1) * sizeof(uint64_t) + pool;
+    }
+
+    /**
+     * Writes the key section: the offset of each key in the pool and the
+     * end of the pool, then the characters of the keys back to back
+     * @param out the snapshot being written
+     * @param keys the keys in preorder
+     */
+    static void write(SnapshotSink& out, const vector<const string*>& keys)
+    {
+        uint64_t offset = 0;
+        out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        for (const string* key : keys)
+        {
+            offset += key->size();
+            out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        }
+        for (const string* key : keys)
+            out.write(key->data(), key->size());
+    }
+
+    /**
+     * Determines whether a mapped key section is well formed: the offsets
+     * start at 0, never decrease and end where the section does
+     * @param section the start of the key section
+     * @param bytes the size of the key section
+     * @param count the number of keys
+     * @return true if the section can be decoded; otherwise, false
+     */
+    static bool valid(const char* section, uint64_t bytes, uint64_t count)
+    {
+        uint64_t table = (count + 1) * sizeof(uint64_t);
+        if (bytes < table)
+            return false;
+        uint64_t prev = 0, offset;
+        for (uint64_t k = 0; k <= count; k++)
+        {
+            memcpy(&offset, section + k * sizeof(uint64_t), sizeof(offset));
+            if (offset < prev || (k == 0 && offset != 0))
+                return false;
+            prev = offset;
+        }
+        return table + prev == bytes;
+    }
+
+    /**
+     * Decodes one key from a validated key section
+     * @param section the start of the key section
+     * @param count the number of keys
+     * @param index the preorder position of the key
+     * @return the key
+     */
+    static string read(const char* section, uint64_t count, uint64_t index)
+    {
+        uint64_t range[2];
+        memcpy(range, section + index * sizeof(uint64_t), sizeof(range));
+        const char* pool = section + (count + 1) * sizeof(uint64_t);
+        return string(pool + range[0], range[1] - range[0]);
+    }
+
+    /**
+     * Appends a single key; used by the journal records, whose length
+     * delimits it
+     * @param out the buffer being written
+     * @param key the key to be encoded
+     */
+    static void encode(string& out, const string& key)
+    {
+        out += key;
+    }
+
+    /**
+     * Decodes a single key written by encode
+     * @param bytes the encoded key
+     * @param length the size of the encoded key
+     * @param key receives the key
+     * @return true; every sequence of bytes is a string
+     */
+    static bool decode(const char* bytes, uint64_t length, string& key)
+    {
+        key.assign(bytes, length);
+        return true;
+    }
+};
+
+/**
+ * Writes a snapshot; the file is written under a temporary name and renamed
+ * into place, so an existing snapshot is never left half overwritten. The
+ * header is written again at the end, with the CRC of the sections.
+ * @param filename the name of the snapshot
+ * @param keys the keys of the tree in preorder
+ * @param shape the shape byte of each node, parallel to keys
+ * @throw BstreeException when the file cannot be written
+ */
+template <typename T>
+void writeSnapshot(const string& filename, const vector<const T*>& keys, const vector<unsigned char>& shape)
+{
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.keyKind = SnapshotCodec<T>::KIND;
+    header.count = keys.size();
+    header.keyBytes = SnapshotCodec<T>::keyBytes(keys);
+    header.checksum = 0;
+    header.reserved = 0;
+    const char padding[8] = { 0 };
+
+    string tmpname = filename + ".tmp";
+    ofstream out(tmpname.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out)
+        throw BstreeException("Exception: unable to create " + filename + " on save().");
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    SnapshotSink sections(out);
+    sections.write(reinterpret_cast<const char*>(shape.data()), shape.size());
+    sections.write(padding, snapshotPad(shape.size()) - shape.size());
+    SnapshotCodec<T>::write(sections, keys);
+    sections.write(padding, snapshotPad(header.keyBytes) - header.keyBytes);
+    header.checksum = sections.checksum();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out || rename(tmpname.c_str(), filename.c_str()) != 0)
+    {
+        ::remove(tmpname.c_str());
+        throw BstreeException("Exception: unable to write " + filename + " on save().");
+    }
+}
+
+/**
+ * A snapshot mapped into memory and validated, read node by node in
+ * preorder. The mapping is released when the reader is destroyed.
+ * @param <T> the key type
+ */
+template <typename T> class SnapshotReader
+{
+private:
+    void* image;
+    size_t length;
+    SnapshotHeader header;
+    const unsigned char* shapes;
+    const char* keys;
+
+public:
+    /**
+     * Maps and validates a snapshot, checking its CRC
+     * @param filename the name of the snapshot
+     * @throw BstreeException when the file cannot be read, is damaged or
+     * is not a well-formed snapshot of T keys
+     */
+    SnapshotReader(const string& filename)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw BstreeException("Exception: unable to open " + filename + " on open().");
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(SNAPSHOT_V1_HEADER))
+        {
+            ::close(fd);
+            throw BstreeException("Exception: " + filename + " is not a snapshot on open().");
+        }
+        length = info.st_size;
+        image = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (image == MAP_FAILED)
+            throw BstreeException("Exception: unable to map " + filename + " on open().");
+        madvise(image, length, MADV_SEQUENTIAL);
+
+        const char* base = static_cast<const char*>(image);
+        header = SnapshotHeader();
+        memcpy(&header, base, min(length, sizeof(header)));
+        size_t headerBytes = header.version == 1 ? SNAPSHOT_V1_HEADER : sizeof(header);
+        /* the sizes are bounded by the length before they are added, and
+           the sections are located only once they are known to fit */
+        bool valid = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0
+            && (header.version == 1 || header.version == SNAPSHOT_VERSION)
+            && header.byteOrder == SNAPSHOT_BYTE_ORDER
+            && header.keyKind == SnapshotCodec<T>::KIND
+            && headerBytes <= length
+            && header.count <= length
+            && header.keyBytes <= length
+            && headerBytes + snapshotPad(header.count) + snapshotPad(header.keyBytes) == length;
+        shapes = nullptr;
+        keys = nullptr;
+        if (valid && header.version != 1)
+            valid = snapshotCrc(0, base + headerBytes, length - headerBytes) == header.checksum;
+        if (valid)
+        {
+            shapes = reinterpret_cast<const unsigned char*>(base + headerBytes);
+            keys = base + headerBytes + snapshotPad(header.count);
+            valid = SnapshotCodec<T>::valid(keys, header.keyBytes, header.count);
+        }
+        if (!valid)
+        {
+            munmap(image, length);
+            throw BstreeException("Exception: " + filename + " is corrupt or of another key type on open().");
+        }
+    }
+
+    SnapshotReader(const SnapshotReader<T>& other) = delete;
+    SnapshotReader<T>& operator=(const SnapshotReader<T>& other) = delete;
+
+    ~SnapshotReader()
+    {
+        munmap(image, length);
+    }
+
+    /**
+     * Gives the number of nodes in the snapshot
+     * @return the number of nodes
+     */
+    uint64_t size() const
+    {
+        return header.count;
+    }
+
+    /**
+     * Gives the shape byte of a node
+     * @param index the preorder position of the node
+     * @return bit 0 set for a left child, bit 1 for a right child
+     */
+    unsigned char shape(uint64_t index) const
+    {
+        return shapes[index];
+    }
+
+    /**
+     * Decodes the key of a node
+     * @param index the preorder position of the node
+     * @return the key
+     */
+    T key(uint64_t index) const
+    {
+        return SnapshotCodec<T>::read(keys, header.count, index);
+    }
+};
+#endif //BSTREESNAPSHOT_H
@@ -0,0 +1,58 @@
+/**
+ * Implementation of the hot-path instrumentation counters of the binary
+ * search tree.
+ * @author Preston Gautreaux
+ * @see BstreeStats.h
+ * <pre>
+ * File: BstreeStats.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+
+#include "BstreeStats.h"
+
+using namespace std;
+
+BstreeStats::BstreeStats()
+{
+    reset();
+}
+
+void BstreeStats::reset()
+{
+    comparisons = 0;
+    allocations = 0;
+    deallocations = 0;
+    for (int k = 0; k < DESCENT_KINDS; k++)
+    {
+        calls[k] = 0;
+        visits[k] = 0;
+    }
+    for (int b = 0; b < DEPTH_BUCKETS; b++)
+        depths[b] = 0;
+}
+
+void BstreeStats::report(ostream& out) const
+{
+    const char* names[DESCENT_KINDS] = { "search", "findParent", "insert", "remove" };
+    out << "comparisons = " << comparisons << ", allocations = " << allocations
+        << ", deallocations = " << deallocations << endl;
+    for (int k = 0; k < DESCENT_KINDS; k++)
+    {
+        out << names[k] << ": calls = " << calls[k] << ", nodes visited = " << visits[k]
+            << ", per call = " << (calls[k] > 0 ? static_cast<double>(visits[k]) / calls[k] : 0.0) << endl;
+    }
+    out << "descent depths:" << endl;
+    for (int b = 0; b < DEPTH_BUCKETS; b++)
+    {
+        if (depths[b] == 0)
+            continue;
+        long low = b == 0 ? 0 : 1L << (b - 1), high = 1L << b;
+        out << "  [" << low << ", " << high << "): " << depths[b] << endl;
+    }
+}
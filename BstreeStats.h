@@ -0,0 +1,106 @@
+/**
+ * The specification for the hot-path instrumentation counters of the
+ * binary search tree.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: BstreeStats.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * The counters are compiled in only when BSTREE_STATS is defined, e.g.
+ *     g++ -DBSTREE_STATS ...
+ * Otherwise BSTREE_STAT(...) expands to nothing, BSTREE_COMPARED(stats, c)
+ * expands to just the comparison c, and a Bstree carries no counters, so the
+ * instrumentation costs nothing.
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+
+#ifndef BSTREESTATS_H
+#define BSTREESTATS_H
+
+#ifdef BSTREE_STATS
+#define BSTREE_STAT(statement) statement
+#define BSTREE_COMPARED(counters, comparison) ((counters).comparisons++, (comparison))
+#else
+#define BSTREE_STAT(statement)
+#define BSTREE_COMPARED(counters, comparison) (comparison)
+#endif
+
+using namespace std;
+
+/**
+ * The descents of a tree that are counted separately
+ */
+enum DescentKind { SEARCH_DESCENT, FIND_PARENT_DESCENT, INSERT_DESCENT, REMOVE_DESCENT, DESCENT_KINDS };
+
+/**
+ * Counters describing the work done by a binary search tree
+ */
+class BstreeStats
+{
+public:
+    /**
+     * the number of buckets of the depth histogram; bucket b counts the
+     * descents that stopped at a depth in [2^(b-1), 2^b), bucket 0 those
+     * that stopped at the root
+     */
+    static const int DEPTH_BUCKETS = 48;
+
+    /**
+     * the number of key comparisons (each == or > counts once)
+     */
+    long comparisons;
+    /**
+     * the number of nodes allocated and freed
+     */
+    long allocations, deallocations;
+    /**
+     * the number of descents of each kind
+     */
+    long calls[DESCENT_KINDS];
+    /**
+     * the number of nodes visited by the descents of each kind
+     */
+    long visits[DESCENT_KINDS];
+    /**
+     * the histogram of the depths at which descents stopped
+     */
+    long depths[DEPTH_BUCKETS];
+
+    /**
+     * Creates a set of zeroed counters
+     */
+    BstreeStats();
+
+    /**
+     * Zeroes every counter
+     */
+    void reset();
+
+    /**
+     * Records a completed descent
+     * @param kind the kind of descent
+     * @param visited the number of nodes it visited; the depth at which it
+     * stopped is one less
+     */
+    void descent(DescentKind kind, long visited)
+    {
+        calls[kind]++;
+        visits[kind] += visited;
+        int bucket = 0;
+        for (long depth = visited > 0 ? visited - 1 : 0; depth > 0 && bucket < DEPTH_BUCKETS - 1; depth >>= 1)
+            bucket++;
+        depths[bucket]++;
+    }
+
+    /**
+     * Displays the counters
+     * @param out the stream to display them on
+     */
+    void report(ostream& out) const;
+};
+#endif //BSTREESTATS_H
@@ -0,0 +1,43 @@
+/**
+ * The checks shared by the test programs of the binary search tree.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: BstreeTest.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * Every test program is a single translation unit that includes this
+ * header once, records its checks with check() and exits with the number
+ * that failed, so each program keeps a count of its own.
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+
+#ifndef BSTREETEST_H
+#define BSTREETEST_H
+
+using namespace std;
+
+/**
+ * The number of checks that failed
+ */
+static int failures = 0;
+
+/**
+ * Records a check, printing it when it fails
+ * @param passed whether the check passed
+ * @param what the description of the check
+ */
+inline void check(bool passed, const string& what)
+{
+    if (!passed)
+    {
+        cout << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+#endif //BSTREETEST_H
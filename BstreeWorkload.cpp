@@ -0,0 +1,148 @@
+/**
+ * Implementation of the key stream generators used to benchmark the
+ * binary search tree implementations.
+ * @author Preston Gautreaux
+ * @see BstreeWorkload.h
+ * <pre>
+ * File: BstreeWorkload.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <numeric>
+
+#include "BstreeWorkload.h"
+
+using namespace std;
+
+string workloadName(Workload workload)
+{
+    switch (workload)
+    {
+    case SORTED_WORKLOAD:
+        return "sorted";
+    case REVERSE_WORKLOAD:
+        return "reverse";
+    case RANDOM_WORKLOAD:
+        return "random";
+    case ZIPFIAN_WORKLOAD:
+        return "zipfian";
+    default:
+        return "zigzag";
+    }
+}
+
+bool parseWorkload(const string& name, Workload& workload)
+{
+    for (Workload candidate : ALL_WORKLOADS)
+    {
+        if (workloadName(candidate) == name)
+        {
+            workload = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isDegenerate(Workload workload)
+{
+    return workload == SORTED_WORKLOAD || workload == REVERSE_WORKLOAD || workload == ZIGZAG_WORKLOAD;
+}
+
+/**
+ * Gives a multiplier for scramble that is coprime to the number of keys;
+ * an affine map with such a multiplier is a bijection on 0 .. count-1
+ * @param count the number of keys
+ * @return the multiplier
+ */
+static uint64_t scrambleMultiplier(uint64_t count)
+{
+    uint64_t multiplier = 0x9E3779B97F4A7C15ull % count;
+    while (gcd(multiplier, count) != 1)
+        multiplier++;
+    return multiplier;
+}
+
+/**
+ * Maps a rank onto a key so that the popular Zipf ranks are spread over the
+ * key space instead of all being the smallest keys
+ * @param rank a rank in 0 .. count-1
+ * @param count the number of keys
+ * @param multiplier the result of scrambleMultiplier(count)
+ * @return a key in 0 .. count-1; distinct ranks give distinct keys
+ */
+static long scramble(uint64_t rank, uint64_t count, uint64_t multiplier)
+{
+    return static_cast<long>((static_cast<unsigned __int128>(rank) * multiplier + 12345) % count);
+}
+
+vector<long> generateKeys(Workload workload, size_t count, uint64_t seed)
+{
+    vector<long> keys(count);
+    if (count == 0)
+        return keys;
+    switch (workload)
+    {
+    case SORTED_WORKLOAD:
+        for (size_t k = 0; k < count; k++)
+            keys[k] = k;
+        break;
+    case REVERSE_WORKLOAD:
+        for (size_t k = 0; k < count; k++)
+            keys[k] = count - 1 - k;
+        break;
+    case RANDOM_WORKLOAD:
+        for (size_t k = 0; k < count; k++)
+            keys[k] = k;
+        shuffleKeys(keys, seed);
+        break;
+    case ZIPFIAN_WORKLOAD:
+    {
+        /* Gray et al., "Quickly generating billion-record synthetic
+           databases": inverts an approximation of the Zipf CDF */
+        const double theta = 0.99;
+        double zetan = 0;
+        for (size_t k = 1; k <= count; k++)
+            zetan += 1.0 / pow(static_cast<double>(k), theta);
+        double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+        double alpha = 1.0 / (1.0 - theta);
+        double eta = (1.0 - pow(2.0 / count, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+        uint64_t multiplier = scrambleMultiplier(count);
+        mt19937_64 random(seed);
+        uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (size_t k = 0; k < count; k++)
+        {
+            double u = uniform(random);
+            double uz = u * zetan;
+            uint64_t rank;
+            if (uz < 1.0)
+                rank = 0;
+            else if (uz < zeta2)
+                rank = 1;
+            else
+                rank = static_cast<uint64_t>(count * pow(eta * u - eta + 1.0, alpha));
+            keys[k] = scramble(min<uint64_t>(rank, count - 1), count, multiplier);
+        }
+        break;
+    }
+    case ZIGZAG_WORKLOAD:
+        for (size_t k = 0; k < count; k++)
+            keys[k] = (k % 2 == 0) ? k / 2 : count - 1 - k / 2;
+        break;
+    }
+    return keys;
+}
+
+void shuffleKeys(vector<long>& keys, uint64_t seed)
+{
+    mt19937_64 random(seed);
+    shuffle(keys.begin(), keys.end(), random);
+}
@@ -0,0 +1,84 @@
+/**
+ * The specification of the key stream generators used to benchmark the
+ * binary search tree implementations.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: BstreeWorkload.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifndef BSTREEWORKLOAD_H
+#define BSTREEWORKLOAD_H
+
+using namespace std;
+
+/**
+ * The shapes of key stream a benchmark can insert
+ */
+enum Workload
+{
+    /** 0, 1, 2, ... */
+    SORTED_WORKLOAD,
+    /** n-1, n-2, ..., 0 */
+    REVERSE_WORKLOAD,
+    /** a random permutation of 0 .. n-1 */
+    RANDOM_WORKLOAD,
+    /** n draws from a Zipf(0.99) distribution over n scrambled keys */
+    ZIPFIAN_WORKLOAD,
+    /** 0, n-1, 1, n-2, ...; every key lands on the opposite side of the last */
+    ZIGZAG_WORKLOAD
+};
+
+/**
+ * every workload, in the order the benchmark reports them
+ */
+const Workload ALL_WORKLOADS[] = { SORTED_WORKLOAD, REVERSE_WORKLOAD, RANDOM_WORKLOAD,
+    ZIPFIAN_WORKLOAD, ZIGZAG_WORKLOAD };
+
+/**
+ * Gives the name of a workload
+ * @param workload a workload
+ * @return its name, as accepted by parseWorkload
+ */
+string workloadName(Workload workload);
+
+/**
+ * Gives the workload with the specified name
+ * @param name sorted, reverse, random, zipfian or zigzag
+ * @param workload receives the workload
+ * @return true if the name is known; otherwise, false
+ */
+bool parseWorkload(const string& name, Workload& workload);
+
+/**
+ * Determines whether inserting the workload into an unbalanced binary search
+ * tree produces a tree whose height is linear in its size
+ * @param workload a workload
+ * @return true for sorted, reverse and zigzag streams; otherwise, false
+ */
+bool isDegenerate(Workload workload);
+
+/**
+ * Generates a key stream
+ * @param workload the shape of the stream
+ * @param count the number of keys
+ * @param seed the seed of the random streams; equal seeds give equal streams
+ * @return the keys, in insertion order; the Zipfian stream repeats keys
+ */
+vector<long> generateKeys(Workload workload, size_t count, uint64_t seed);
+
+/**
+ * Shuffles keys with a seeded generator, e.g. to order the lookups and
+ * removals of a benchmark independently of the insertion order
+ * @param keys the keys to shuffle
+ * @param seed the seed of the shuffle
+ */
+void shuffleKeys(vector<long>& keys, uint64_t seed);
+#endif //BSTREEWORKLOAD_H
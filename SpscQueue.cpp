@@ -0,0 +1,104 @@
+/**
+ * Implementation file for functions of the SpscQueue<T> class
+ * @author Preston Gautreaux
+ * @see SpscQueue.h
+ * <pre>
+ * File: SpscQueue.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "SpscQueue.h"
+#include <thread>
+#include <utility>
+
+template <typename T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+{
+    size_t slotCount = 2;
+    while (slotCount < capacity)
+        slotCount <<= 1;
+    slots.resize(slotCount);
+    mask = slotCount - 1;
+    head.store(0, memory_order_relaxed);
+    tail.store(0, memory_order_relaxed);
+    sleepers.store(0, memory_order_relaxed);
+}
+
+template <typename T>
+template <typename Ready>
+void SpscQueue<T>::await(Ready ready)
+{
+    for (int spin = 0; spin < SPINS; spin++)
+    {
+        if (ready())
+            return;
+        this_thread::yield();
+    }
+    unique_lock<mutex> guard(sleep);
+    /* announce the sleep before the last look at the condition; wake
+       publishes its progress before it looks for sleepers, so one of the
+       two sees the other */
+    sleepers.fetch_add(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    wakeup.wait(guard, ready);
+    sleepers.fetch_sub(1, memory_order_relaxed);
+}
+
+template <typename T>
+void SpscQueue<T>::wake()
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleepers.load(memory_order_relaxed) > 0)
+    {
+        /* taking the lock orders the notify after the sleeper's wait */
+        lock_guard<mutex> guard(sleep);
+        wakeup.notify_all();
+    }
+}
+
+template <typename T>
+bool SpscQueue<T>::tryPush(T& item)
+{
+    size_t pos = tail.load(memory_order_relaxed);
+    /* the consumer publishes freed slots with a release store to head */
+    if (pos - head.load(memory_order_acquire) == slots.size())
+        return false;
+    slots[pos & mask] = move(item);
+    tail.store(pos + 1, memory_order_release);
+    wake();
+    return true;
+}
+
+template <typename T>
+void SpscQueue<T>::push(T item)
+{
+    while (!tryPush(item))
+        await([this]() { return tail.load(memory_order_relaxed) - head.load(memory_order_acquire) < slots.size(); });
+}
+
+template <typename T>
+bool SpscQueue<T>::tryPop(T& item)
+{
+    size_t pos = head.load(memory_order_relaxed);
+    /* the producer publishes filled slots with a release store to tail */
+    if (pos == tail.load(memory_order_acquire))
+        return false;
+    item = move(slots[pos & mask]);
+    head.store(pos + 1, memory_order_release);
+    wake();
+    return true;
+}
+
+template <typename T>
+T SpscQueue<T>::pop()
+{
+    T item;
+    while (!tryPop(item))
+        await([this]() { return head.load(memory_order_relaxed) != tail.load(memory_order_acquire); });
+    return item;
+}
@@ -0,0 +1,124 @@
+/**
+ * The specification for a bounded lock-free single-producer/single-consumer
+ * queue used to connect the stages of the BstreeParser pipeline.
+ * @author Preston Gautreaux
+ * <pre>
+ * File: SpscQueue.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+using namespace std;
+
+/**
+ * A bounded ring buffer that exactly one thread pushes into and exactly
+ * one other thread pops from. Neither side takes a lock while the queue
+ * has room and items; a side that finds the queue full (or empty) yields
+ * its time slice a few times and then sleeps until the other side makes
+ * progress, so an idle pipeline costs no CPU.
+ * @param <T> the type of the queued items; it must be default constructible
+ * and movable
+ */
+template <typename T> class SpscQueue
+{
+private:
+    /**
+     * the storage for the queued items; its size is a power of two
+     */
+    vector<T> slots;
+    /**
+     * slots.size() - 1; used to map a position onto a slot
+     */
+    size_t mask;
+    /**
+     * the position of the next item to be popped; written only by the consumer
+     */
+    alignas(64) atomic<size_t> head;
+    /**
+     * the position of the next free slot; written only by the producer
+     */
+    alignas(64) atomic<size_t> tail;
+    /**
+     * the number of sides asleep in await; read by every push and pop, so
+     * a side only takes the lock to wake one that is asleep
+     */
+    alignas(64) atomic<int> sleepers;
+    /**
+     * guards the sleep of a side against the wakeup it waits for
+     */
+    mutex sleep;
+    /**
+     * signalled by a push or pop while a side is asleep
+     */
+    condition_variable wakeup;
+    /**
+     * the number of times a side yields before it sleeps
+     */
+    static constexpr int SPINS = 64;
+
+    /**
+     * Waits until the other side makes a condition true, first yielding,
+     * then asleep
+     * @param ready a function of type () -> bool; the condition
+     */
+    template <typename Ready>
+    void await(Ready ready);
+
+    /**
+     * Wakes the other side if it is asleep; called after every push and pop
+     */
+    void wake();
+
+public:
+    /**
+     * Constructs an empty queue
+     * @param capacity the minimum number of items the queue can hold; it is
+     * rounded up to a power of two
+     */
+    SpscQueue(size_t capacity);
+
+    /**
+     * The queue is shared between two threads and must not be copied
+     */
+    SpscQueue(const SpscQueue<T>& other) = delete;
+    SpscQueue<T>& operator=(const SpscQueue<T>& other) = delete;
+
+    /**
+     * Attempts to append an item to the queue without waiting
+     * @param item the item to be appended; it is moved from on success
+     * @return true if the item was appended; false if the queue is full
+     */
+    bool tryPush(T& item);
+
+    /**
+     * Appends an item to the queue, waiting while the queue is full
+     * @param item the item to be appended
+     */
+    void push(T item);
+
+    /**
+     * Attempts to remove the item at the front of the queue without waiting
+     * @param item receives the removed item on success
+     * @return true if an item was removed; false if the queue is empty
+     */
+    bool tryPop(T& item);
+
+    /**
+     * Removes the item at the front of the queue, waiting while the queue
+     * is empty
+     * @return the removed item
+     */
+    T pop();
+};
+#endif //SPSCQUEUE_H
@@ -0,0 +1,172 @@
+/**
+ * Implementation file for functions of the StaticBstree<T, N> class
+ * @author Preston Gautreaux
+ * @see StaticBstree.h
+ * <pre>
+ * File: StaticBstree.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "StaticBstree.h"
+
+template <typename T, size_t N>
+constexpr StaticBstree<T, N>::StaticBstree(const array<T, N>& items) : nodes()
+{
+    /* insertion sort: std::sort is not constexpr before C++20, and static
+       key sets are small */
+    array<T, N> sorted = items;
+    for (size_t k = 1; k < N; k++)
+    {
+        T key = sorted[k];
+        size_t j = k;
+        for (; j > 0 && sorted[j - 1] > key; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = key;
+    }
+    for (size_t k = 1; k < N; k++)
+    {
+        if (sorted[k - 1] == sorted[k])
+            throw BstreeException("Exception: duplicate key in StaticBstree.");
+    }
+    size_t next = 0;
+    fill(sorted, 0, next);
+}
+
+template <typename T, size_t N>
+constexpr void StaticBstree<T, N>::fill(const array<T, N>& sorted, size_t index, size_t& next)
+{
+    if (index < N)
+    {
+        fill(sorted, 2 * index + 1, next);
+        nodes[index] = sorted[next++];
+        fill(sorted, 2 * index + 2, next);
+    }
+}
+
+template <typename T, size_t N>
+constexpr size_t StaticBstree<T, N>::search(const T& item) const
+{
+    size_t index = 0;
+    while (index < N)
+    {
+        if (nodes[index] == item)
+            return index;
+        index = nodes[index] > item ? 2 * index + 1 : 2 * index + 2;
+    }
+    return N;
+}
+
+template <typename T, size_t N>
+constexpr bool StaticBstree<T, N>::empty() const
+{
+    return N == 0;
+}
+
+template <typename T, size_t N>
+constexpr long StaticBstree<T, N>::size() const
+{
+    return N;
+}
+
+template <typename T, size_t N>
+constexpr long StaticBstree<T, N>::height() const
+{
+    long h = -1;
+    for (size_t levels = N; levels > 0; levels >>= 1)
+        h++;
+    return h;
+}
+
+template <typename T, size_t N>
+constexpr bool StaticBstree<T, N>::inTree(const T& item) const
+{
+    return search(item) < N;
+}
+
+template <typename T, size_t N>
+constexpr const T& StaticBstree<T, N>::retrieve(const T& key) const
+{
+    size_t index = search(key);
+    if (index == N)
+        throw BstreeException("Exception: non-existent key on retrieve().");
+    return nodes[index];
+}
+
+template <typename T, size_t N>
+void StaticBstree<T, N>::preorderTraverse(size_t index, FuncType apply) const
+{
+    if (index < N)
+    {
+        apply(nodes[index]);
+        preorderTraverse(2 * index + 1, apply);
+        preorderTraverse(2 * index + 2, apply);
+    }
+}
+
+template <typename T, size_t N>
+void StaticBstree<T, N>::postorderTraverse(size_t index, FuncType apply) const
+{
+    if (index < N)
+    {
+        postorderTraverse(2 * index + 1, apply);
+        postorderTraverse(2 * index + 2, apply);
+        apply(nodes[index]);
+    }
+}
+
+template <typename T, size_t N>
+void StaticBstree<T, N>::preorderTraverse(FuncType apply) const
+{
+    preorderTraverse(0, apply);
+}
+
+template <typename T, size_t N>
+void StaticBstree<T, N>::postorderTraverse(FuncType apply) const
+{
+    postorderTraverse(0, apply);
+}
+
+template <typename T, size_t N>
+void StaticBstree<T, N>::inorderTraverse(FuncType apply) const
+{
+    /* descend to the leftmost node, then repeatedly step to the inorder
+       successor using only index arithmetic */
+    if (N == 0)
+        return;
+    size_t index = 0;
+    while (2 * index + 1 < N)
+        index = 2 * index + 1;
+    while (true)
+    {
+        apply(nodes[index]);
+        if (2 * index + 2 < N)
+        {
+            index = 2 * index + 2;
+            while (2 * index + 1 < N)
+                index = 2 * index + 1;
+        }
+        else
+        {
+            /* climb while coming from a right child */
+            while (index > 0 && index % 2 == 0)
+                index = (index - 1) / 2;
+            if (index == 0)
+                return;
+            index = (index - 1) / 2;
+        }
+    }
+}
+
+template <typename T, size_t N>
+constexpr StaticBstree<T, N> makeStaticBstree(const T (&items)[N])
+{
+    array<T, N> keys{};
+    for (size_t k = 0; k < N; k++)
+        keys[k] = items[k];
+    return StaticBstree<T, N>(keys);
+}
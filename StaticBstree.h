@@ -0,0 +1,158 @@
+/**
+ * The specification for a read-only binary search tree over a key set that
+ * is known when the program is compiled.
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: StaticBstree.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * The keys are sorted and laid out in a single array in breadth-first
+ * (Eytzinger) order: the children of the node at index i are at 2i + 1 and
+ * 2i + 2. The tree is therefore complete, no node is allocated, and a tree
+ * declared constexpr is built entirely by the compiler into static storage:
+ *
+ *     constexpr auto MONTHS = makeStaticBstree<string_view>({ "JANUARY",
+ *         "FEBRUARY", "MARCH", ..., "DECEMBER" });
+ *     static_assert(MONTHS.inTree("MAY"), "");
+ *
+ * T must be a literal type with == and > (e.g. an integer or string_view);
+ * a duplicate key is a compile-time error in a constant expression and a
+ * BstreeException otherwise.
+ * </pre>
+ */
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "BstreeException.h"
+
+#ifndef STATICBSTREE_H
+#define STATICBSTREE_H
+
+using namespace std;
+
+/**
+ * A read-only, perfectly balanced binary search tree of N keys
+ * @param <T> the key type
+ * @param <N> the number of keys
+ */
+template <typename T, size_t N> class StaticBstree
+{
+private:
+    /**
+     * forward declaration of a function pointer of type (const T&) -> void
+     */
+    typedef void (*FuncType)(const T& item);
+
+    /**
+     * the keys in breadth-first order
+     */
+    array<T, N> nodes;
+
+    /**
+     * Copies sorted keys into breadth-first order by walking the implicit
+     * tree in inorder
+     * @param sorted the keys in ascending order
+     * @param index the node being filled
+     * @param next the position of the next sorted key to place
+     */
+    constexpr void fill(const array<T, N>& sorted, size_t index, size_t& next);
+
+    /**
+     * Traverses the subtree rooted at the specified index in preorder
+     * @param index the root of a subtree
+     * @param apply the function applied to each key
+     */
+    void preorderTraverse(size_t index, FuncType apply) const;
+
+    /**
+     * Traverses the subtree rooted at the specified index in postorder
+     * @param index the root of a subtree
+     * @param apply the function applied to each key
+     */
+    void postorderTraverse(size_t index, FuncType apply) const;
+
+    /**
+     * Gives the index of the node holding the specified key
+     * @param item the search key
+     * @return the index of the node, or N if the key is not in the tree
+     */
+    constexpr size_t search(const T& item) const;
+
+public:
+    /**
+     * Builds the tree from a list of distinct keys in any order
+     * @param items the keys
+     * @throw BstreeException when a key occurs twice
+     */
+    constexpr StaticBstree(const array<T, N>& items);
+
+    /**
+     * Determines whether the tree is empty
+     * @return true if the tree has no keys; otherwise, false
+     */
+    constexpr bool empty() const;
+
+    /**
+     * Gives the number of keys in this tree
+     * @return the size of the tree
+     */
+    constexpr long size() const;
+
+    /**
+     * Gives the height of this tree; the tree is complete, so this is
+     * floor(log2(N)), or -1 for the empty tree
+     * @return the height of this tree
+     */
+    constexpr long height() const;
+
+    /**
+     * Determines whether an item is in the tree.
+     * @param item item with a specified search key.
+     * @return true on success; false on failure.
+     */
+    constexpr bool inTree(const T& item) const;
+
+    /**
+     * Returns the item in the tree with the specified key.
+     * @param key the key to the item to be retrieved.
+     * @return it with the specified key.
+     * @throws BstreeException if the item with the specified key is not
+     * in the tree
+     */
+    constexpr const T& retrieve(const T& key) const;
+
+    /**
+     * Traverses the tree in preorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const T&) -> void
+     */
+    void preorderTraverse(FuncType apply) const;
+
+    /**
+     * Traverses the tree in inorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const T&) -> void
+     */
+    void inorderTraverse(FuncType apply) const;
+
+    /**
+     * Traverses the tree in postorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const T&) -> void
+     */
+    void postorderTraverse(FuncType apply) const;
+};
+
+/**
+ * Builds a StaticBstree from a braced list of keys, deducing its size
+ * @param items the keys
+ * @return the tree
+ */
+template <typename T, size_t N>
+constexpr StaticBstree<T, N> makeStaticBstree(const T (&items)[N]);
+#endif //STATICBSTREE_H
@@ -0,0 +1,163 @@
+/**
+ * A test of the compile-time binary search tree
+ * @author Preston Gautreaux
+ * @see StaticBstree
+ * <pre>
+ * File: StaticBstreeTest.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * Builds the months of months.bst as a constexpr StaticBstree and checks
+ * its searches with static_assert, so that this program compiles only if
+ * the tree is built by the compiler. Then checks the traversals, and trees
+ * of every size up to 100 built at run time. Prints each failed check and
+ * exits with the number of failures.
+ *
+ * Build: g++ -std=c++17 -O2 -o StaticBstreeTest StaticBstreeTest.cpp BstreeException.cpp
+ * </pre>
+ */
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include "StaticBstree.cpp"
+#include "BstreeTest.h"
+
+using namespace std;
+
+/**
+ * the months, in calendar order
+ */
+constexpr auto MONTHS = makeStaticBstree<string_view>({ "JANUARY", "FEBRUARY", "MARCH", "APRIL", "MAY", "JUNE",
+    "JULY", "AUGUST", "SEPTEMBER", "OCTOBER", "NOVEMBER", "DECEMBER" });
+
+static_assert(MONTHS.size() == 12 && !MONTHS.empty(), "the tree holds every month");
+static_assert(MONTHS.height() == 3, "twelve keys fit in a complete tree of height 3");
+static_assert(MONTHS.inTree("MAY") && MONTHS.inTree("APRIL") && MONTHS.inTree("SEPTEMBER"), "inTree finds a month");
+static_assert(!MONTHS.inTree("SMARCH") && !MONTHS.inTree(""), "inTree misses a non-month");
+static_assert(MONTHS.retrieve("JUNE") == "JUNE", "retrieve gives the month");
+
+/**
+ * The months a traversal has visited
+ */
+static vector<string_view> months;
+
+/**
+ * The integers a traversal has visited
+ */
+static vector<int> integers;
+
+/**
+ * Records a month visited by a traversal
+ * @param month the month
+ */
+void visitMonth(const string_view& month)
+{
+    months.push_back(month);
+}
+
+/**
+ * Records an integer visited by a traversal
+ * @param item the integer
+ */
+void visitInteger(const int& item)
+{
+    integers.push_back(item);
+}
+
+/**
+ * Builds a tree of the integers 0, ..., N - 1 at run time, given in
+ * descending order, and checks its searches and traversals
+ * @param <N> the number of keys
+ */
+template <size_t N>
+void checkSize()
+{
+    string what = "size " + to_string(N);
+    array<int, N> items{};
+    for (size_t k = 0; k < N; k++)
+        items[k] = static_cast<int>(N - 1 - k);
+    StaticBstree<int, N> tree(items);
+    long height = -1;
+    for (size_t levels = N; levels > 0; levels >>= 1)
+        height++;
+    check(tree.size() == static_cast<long>(N) && tree.height() == height, what + ": size and height");
+    bool found = !tree.inTree(-1) && !tree.inTree(static_cast<int>(N));
+    for (int item = 0; item < static_cast<int>(N); item++)
+        found = found && tree.inTree(item) && tree.retrieve(item) == item;
+    check(found, what + ": inTree and retrieve");
+
+    integers.clear();
+    tree.inorderTraverse(visitInteger);
+    vector<int> sorted(N);
+    for (size_t k = 0; k < N; k++)
+        sorted[k] = static_cast<int>(k);
+    check(integers == sorted, what + ": inorderTraverse visits the keys in order");
+    integers.clear();
+    tree.preorderTraverse(visitInteger);
+    vector<int> preorder = integers;
+    integers.clear();
+    tree.postorderTraverse(visitInteger);
+    vector<int> postorder = integers;
+    check(is_permutation(preorder.begin(), preorder.end(), sorted.begin(), sorted.end())
+        && is_permutation(postorder.begin(), postorder.end(), sorted.begin(), sorted.end()),
+        what + ": preorderTraverse and postorderTraverse visit every key once");
+    if (N > 0)
+        check(preorder.front() == postorder.back(), what + ": the root comes first in preorder, last in postorder");
+}
+
+/**
+ * Builds and checks trees of every size from N down to 0
+ * @param <N> the largest number of keys
+ */
+template <size_t N>
+void checkSizes()
+{
+    checkSize<N>();
+    if constexpr (N > 0)
+        checkSizes<N - 1>();
+}
+
+int main()
+{
+    months.clear();
+    MONTHS.inorderTraverse(visitMonth);
+    vector<string_view> sorted = { "APRIL", "AUGUST", "DECEMBER", "FEBRUARY", "JANUARY", "JULY", "JUNE", "MARCH",
+        "MAY", "NOVEMBER", "OCTOBER", "SEPTEMBER" };
+    check(months == sorted, "months: inorderTraverse visits the months in alphabetical order");
+    /* the last level of the complete tree holds five keys, four of them on
+       the left of the root, so seven keys are below it on the left */
+    months.clear();
+    MONTHS.preorderTraverse(visitMonth);
+    check(months.size() == 12 && months.front() == "MARCH" && months[1] == "FEBRUARY",
+        "months: preorderTraverse starts at the root and its left child");
+    months.clear();
+    MONTHS.postorderTraverse(visitMonth);
+    check(months.size() == 12 && months.back() == "MARCH", "months: postorderTraverse ends at the root");
+
+    try
+    {
+        MONTHS.retrieve("SMARCH");
+        check(false, "months: retrieve of a non-month throws");
+    }
+    catch (const BstreeException&)
+    {
+    }
+    try
+    {
+        StaticBstree<int, 3> duplicates({ 1, 2, 1 });
+        check(false, "a duplicate key throws");
+    }
+    catch (const BstreeException&)
+    {
+    }
+
+    checkSizes<100>();
+
+    if (failures == 0)
+        cout << "all checks passed" << endl;
+    return failures;
+}
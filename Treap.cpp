@@ -0,0 +1,549 @@
+/**
+ * Implementation file for functions of the Treap<T> class
+ * @author Preston Gautreaux
+ * @see Treap.h
+ * <pre>
+ * File: Treap.cpp
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ * </pre>
+ */
+
+using namespace std;
+
+#include "Treap.h"
+#include <algorithm>
+#include <functional>
+
+/* Nested Node class definitions */
+template <typename T>
+Treap<T>::Node::Node(const T& item, uint64_t priority) : data(item)
+{
+    left = nullptr;
+    right = nullptr;
+    this->priority = priority;
+    count = 1;
+}
+
+/* Outer Treap class definitions */
+template <typename T>
+Treap<T>::Treap(uint64_t seed)
+{
+    root = nullptr;
+    state = seed;
+}
+
+template <typename T>
+Treap<T>::Treap(const Treap<T>& other)
+{
+    root = copy(other.root);
+    state = other.state;
+}
+
+template <typename T>
+Treap<T>::Treap(Treap<T>&& other)
+{
+    root = other.root;
+    state = other.state;
+    other.root = nullptr;
+}
+
+template <typename T>
+Treap<T>::~Treap()
+{
+    destroy(root);
+}
+
+template <typename T>
+Treap<T>& Treap<T>::operator=(const Treap<T>& other)
+{
+    if (this != &other)
+    {
+        Node* clone = copy(other.root);
+        destroy(root);
+        root = clone;
+        state = other.state;
+    }
+    return *this;
+}
+
+template <typename T>
+uint64_t Treap<T>::nextPriority()
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+template <typename T>
+long Treap<T>::count(const Node* node)
+{
+    return node ? node->count : 0;
+}
+
+template <typename T>
+void Treap<T>::update(Node* node)
+{
+    node->count = 1 + count(node->left) + count(node->right);
+}
+
+template <typename T>
+void Treap<T>::split(Node* node, const T& key, Node*& lft, Node*& rgt)
+{
+    if (!node)
+    {
+        lft = nullptr;
+        rgt = nullptr;
+    }
+    else if (key > node->data)
+    {
+        split(node->right, key, node->right, rgt);
+        lft = node;
+        update(node);
+    }
+    else
+    {
+        split(node->left, key, lft, node->left);
+        rgt = node;
+        update(node);
+    }
+}
+
+template <typename T>
+typename Treap<T>::Node* Treap<T>::merge(Node* lft, Node* rgt)
+{
+    if (!lft)
+        return rgt;
+    if (!rgt)
+        return lft;
+    if (lft->priority > rgt->priority)
+    {
+        lft->right = merge(lft->right, rgt);
+        update(lft);
+        return lft;
+    }
+    rgt->left = merge(lft, rgt->left);
+    update(rgt);
+    return rgt;
+}
+
+template <typename T>
+typename Treap<T>::Node* Treap<T>::insert(Node* node, Node* fresh)
+{
+    if (!node)
+        return fresh;
+    if (fresh->priority > node->priority)
+    {
+        /* the new node takes this place; the subtree is cut around it */
+        split(node, fresh->data, fresh->left, fresh->right);
+        update(fresh);
+        return fresh;
+    }
+    if (node->data > fresh->data)
+        node->left = insert(node->left, fresh);
+    else
+        node->right = insert(node->right, fresh);
+    update(node);
+    return node;
+}
+
+template <typename T>
+typename Treap<T>::Node* Treap<T>::copy(const Node* src)
+{
+    if (!src)
+        return nullptr;
+    Node* dest = new Node(src->data, src->priority);
+    dest->count = src->count;
+    dest->left = copy(src->left);
+    dest->right = copy(src->right);
+    return dest;
+}
+
+template <typename T>
+void Treap<T>::destroy(Node* node)
+{
+    if (node)
+    {
+        destroy(node->left);
+        destroy(node->right);
+        delete node;
+    }
+}
+
+template <typename T>
+typename Treap<T>::Node* Treap<T>::search(const T& item, Node** parent) const
+{
+    Node* above = nullptr;
+    Node* tmp = root;
+    while (tmp && !(tmp->data == item))
+    {
+        above = tmp;
+        tmp = tmp->data > item ? tmp->left : tmp->right;
+    }
+    if (parent)
+        *parent = above;
+    return tmp;
+}
+
+template <typename T>
+bool Treap<T>::empty() const
+{
+    return root == nullptr;
+}
+
+template <typename T>
+void Treap<T>::insert(T item)
+{
+    Node* existing = search(item);
+    if (existing)
+    {
+        existing->data = item;
+        return;
+    }
+    root = insert(root, new Node(item, nextPriority()));
+}
+
+template <typename T>
+bool Treap<T>::inTree(T item) const
+{
+    return search(item) != nullptr;
+}
+
+template <typename T>
+bool Treap<T>::remove(const T& item)
+{
+    if (!search(item))
+        return false;
+    /* every subtree on the way down loses one node */
+    Node** link = &root;
+    while (!((*link)->data == item))
+    {
+        (*link)->count--;
+        link = (*link)->data > item ? &(*link)->left : &(*link)->right;
+    }
+    Node* node = *link;
+    *link = merge(node->left, node->right);
+    delete node;
+    return true;
+}
+
+template <typename T>
+const T& Treap<T>::retrieve(const T& key) const
+{
+    if (!root)
+        throw BstreeException("Exception:tree empty on retrieve().");
+    Node* node = search(key);
+    if (!node)
+        throw BstreeException("Exception: non-existent key on retrieve().");
+    return node->data;
+}
+
+template <typename T>
+long Treap<T>::size() const
+{
+    return count(root);
+}
+
+template <typename T>
+void Treap<T>::inorderTraverse(Node* node, FuncType apply) const
+{
+    if (node)
+    {
+        inorderTraverse(node->left, apply);
+        apply(node->data);
+        inorderTraverse(node->right, apply);
+    }
+}
+
+template <typename T>
+void Treap<T>::preorderTraverse(Node* node, FuncType apply) const
+{
+    if (node)
+    {
+        apply(node->data);
+        preorderTraverse(node->left, apply);
+        preorderTraverse(node->right, apply);
+    }
+}
+
+template <typename T>
+void Treap<T>::postorderTraverse(Node* node, FuncType apply) const
+{
+    if (node)
+    {
+        postorderTraverse(node->left, apply);
+        postorderTraverse(node->right, apply);
+        apply(node->data);
+    }
+}
+
+template <typename T>
+void Treap<T>::inorderTraverse(FuncType apply) const
+{
+    inorderTraverse(root, apply);
+}
+
+template <typename T>
+void Treap<T>::preorderTraverse(FuncType apply) const
+{
+    preorderTraverse(root, apply);
+}
+
+template <typename T>
+void Treap<T>::postorderTraverse(FuncType apply) const
+{
+    postorderTraverse(root, apply);
+}
+
+template <typename T>
+long Treap<T>::height(const Node* node) const
+{
+    if (!node)
+        return -1;
+    return 1 + max(height(node->left), height(node->right));
+}
+
+template <typename T>
+long Treap<T>::height() const
+{
+    return height(root);
+}
+
+template <typename T>
+vector<T> Treap<T>::ancestors(T entry) const
+{
+    if (!search(entry))
+        throw BstreeException("Ancestors could not be found, element does not exist in tree");
+    vector<T> anc;
+    for (Node* tmp = root; !(tmp->data == entry); tmp = tmp->data > entry ? tmp->left : tmp->right)
+        anc.push_back(tmp->data);
+    reverse(anc.begin(), anc.end());
+    return anc;
+}
+
+template <typename T>
+vector<T> Treap<T>::descendants(T entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Descendants could not be found, element does not exist in tree");
+    vector<T> desc;
+    vector<const Node*> pending;
+    if (node->right)
+        pending.push_back(node->right);
+    if (node->left)
+        pending.push_back(node->left);
+    while (!pending.empty())
+    {
+        const Node* cur = pending.back();
+        pending.pop_back();
+        desc.push_back(cur->data);
+        if (cur->right)
+            pending.push_back(cur->right);
+        if (cur->left)
+            pending.push_back(cur->left);
+    }
+    return desc;
+}
+
+template <typename T>
+bool Treap<T>::isomorphic(const Node* lft, const Node* rgt) const
+{
+    if (!lft && !rgt)
+        return true;
+    else if (!lft || !rgt)
+        return false;
+    else
+        return isomorphic(lft->left, rgt->left) && isomorphic(lft->right, rgt->right);
+}
+
+template <typename T>
+bool Treap<T>::isomorphic() const
+{
+    if (!root)
+        return true;
+    return isomorphic(root->left, root->right);
+}
+
+template <typename T>
+const T* Treap<T>::getParent(T entry) const
+{
+    Node* parent;
+    if (!search(entry, &parent))
+        throw BstreeException("Entry does not exist in tree, cannot use getParent");
+    return parent ? &parent->data : nullptr;
+}
+
+template <typename T>
+const T* Treap<T>::getSibling(T entry) const
+{
+    Node* parent;
+    Node* node = search(entry, &parent);
+    if (!node)
+        throw BstreeException("Cannot find sibling: element does not exist in this tree");
+    if (!parent)
+        return nullptr;
+    Node* sibling = parent->left == node ? parent->right : parent->left;
+    return sibling ? &sibling->data : nullptr;
+}
+
+template <typename T>
+const T* Treap<T>::leftChild(T entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Entry does not exist in tree");
+    return node->left ? &node->left->data : nullptr;
+}
+
+template <typename T>
+const T* Treap<T>::rightChild(T entry) const
+{
+    Node* node = search(entry);
+    if (!node)
+        throw BstreeException("Entry does not exist in tree");
+    return node->right ? &node->right->data : nullptr;
+}
+
+template <typename T>
+void Treap<T>::bias(bool& hlb, bool& hrb, const Node* cur) const
+{
+    if (!cur)
+        return;
+    long leftH = height(cur->left);
+    long rightH = height(cur->right);
+    if (leftH < rightH)
+        hrb = true;
+    if (leftH > rightH)
+        hlb = true;
+    bias(hlb, hrb, cur->left);
+    bias(hlb, hrb, cur->right);
+}
+
+template <typename T>
+bool Treap<T>::isFibonacci() const
+{
+    bool leftcheck = false;
+    bool rightcheck = false;
+    bias(leftcheck, rightcheck, root);
+    if (size() <= 1)
+        return true;
+    if (leftcheck && rightcheck)
+        return false;
+    long prev = 0;
+    long fib = 1;
+    long next = 1;
+    long final = size() + 1;
+    long h = height(root);
+    long i = 3;
+    for (; fib < final; i++)
+    {
+        next = prev + fib;
+        prev = fib;
+        fib = next;
+    }
+    return fib == final && h == i - 2;
+}
+
+template <typename T>
+Treap<T> Treap<T>::split(const T& key)
+{
+    Treap<T> upper(nextPriority());
+    split(root, key, root, upper.root);
+    return upper;
+}
+
+template <typename T>
+void Treap<T>::merge(Treap<T>& other)
+{
+    if (this == &other || !other.root)
+        return;
+    if (root)
+    {
+        const Node* highest = root;
+        while (highest->right)
+            highest = highest->right;
+        const Node* lowest = other.root;
+        while (lowest->left)
+            lowest = lowest->left;
+        if (!(lowest->data > highest->data))
+            throw BstreeException("Exception: overlapping key ranges on merge().");
+    }
+    root = merge(root, other.root);
+    other.root = nullptr;
+}
+
+template <typename T>
+void Treap<T>::save(const string& filename) const
+{
+    vector<const T*> keys;
+    vector<unsigned char> shape;
+    vector<const Node*> pending;
+    keys.reserve(size());
+    shape.reserve(size());
+    if (root)
+        pending.push_back(root);
+    while (!pending.empty())
+    {
+        const Node* cur = pending.back();
+        pending.pop_back();
+        keys.push_back(&cur->data);
+        shape.push_back((cur->left ? 1 : 0) | (cur->right ? 2 : 0));
+        if (cur->right)
+            pending.push_back(cur->right);
+        if (cur->left)
+            pending.push_back(cur->left);
+    }
+    writeSnapshot<T>(filename, keys, shape);
+}
+
+template <typename T>
+void Treap<T>::open(const string& filename)
+{
+    SnapshotReader<T> snapshot(filename);
+    vector<uint64_t> priorities(snapshot.size());
+    for (uint64_t& priority : priorities)
+        priority = nextPriority();
+    sort(priorities.begin(), priorities.end(), greater<uint64_t>());
+
+    /* rebuild in preorder as Bstree::open does; every node on the stack
+       still owes its right child, and sizes are summed once a subtree is
+       complete */
+    Treap<T> loaded(state);
+    vector<Node*> pending;
+    vector<Node*> built;
+    Node** link = &loaded.root;
+    bool valid = true;
+    for (uint64_t k = 0; k < snapshot.size(); k++)
+    {
+        if (!link)
+        {
+            valid = false;
+            break;
+        }
+        *link = new Node(snapshot.key(k), priorities[k]);
+        built.push_back(*link);
+        if (snapshot.shape(k) & 2)
+            pending.push_back(*link);
+        if (snapshot.shape(k) & 1)
+            link = &(*link)->left;
+        else if (!pending.empty())
+        {
+            link = &pending.back()->right;
+            pending.pop_back();
+        }
+        else
+            link = nullptr;
+    }
+    if (!valid || (snapshot.size() > 0 && link) || !pending.empty())
+        throw BstreeException("Exception: " + filename + " is corrupt or of another key type on open().");
+    /* children come after their parent in preorder */
+    for (size_t k = built.size(); k-- > 0;)
+        update(built[k]);
+
+    destroy(root);
+    root = loaded.root;
+    loaded.root = nullptr;
+}
@@ -0,0 +1,403 @@
+/**
+ * The specification for a randomized balanced binary search tree (treap).
+ * @author Preston Gautreaux
+ * @see Bstree
+ * <pre>
+ * File: Treap.h
+ * Date: 9999-99-99
+ * Course: csc 1254 Section 1
+ * Instructor: Dr. Duncan
+ *
+ * Every node carries a random priority, and the tree is a binary search tree
+ * by data and a max-heap by priority. Its shape is therefore that of a
+ * binary search tree built by inserting the data in random order, whatever
+ * the actual order, and its expected height is O(log n). All balancing is
+ * done by two primitives:
+ * - split(t, key) cuts a tree into the data below key and the rest
+ * - merge(a, b) joins two trees when all data of a is below that of b
+ * Both follow one root-to-leaf path. Every node also records the size of its
+ * subtree, so splitting a Treap into two Treaps is O(log n) as well.
+ * The priorities come from a generator seeded at construction, so the same
+ * seed and the same operations always build the same tree.
+ * </pre>
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "BstreeException.h"
+#include "BstreeSnapshot.h"
+
+#ifndef TREAP_H
+#define TREAP_H
+
+using namespace std;
+
+/**
+ * A treap with the public interface of Bstree
+ * @param <T> the data type; it must support == and >
+ */
+template <typename T> class Treap
+{
+private:
+    /**
+     * forward declaration of a function pointer of type (const T&) -> void
+     */
+    typedef void (*FuncType)(const T& item);
+    /**
+     * forward declaration of the Node class
+     */
+    class Node;
+    /**
+     * A pointer to the root node of this tree
+     */
+    Node* root;
+    /**
+     * the state of the priority generator
+     */
+    uint64_t state;
+
+    /**
+     * Draws the next priority (splitmix64)
+     * @return a pseudo-random priority
+     */
+    uint64_t nextPriority();
+
+    /**
+     * Gives the number of nodes of a subtree
+     * @param node the root of a subtree or null
+     * @return the number of nodes
+     */
+    static long count(const Node* node);
+
+    /**
+     * Recomputes the subtree size of a node from its children
+     * @param node a node
+     */
+    static void update(Node* node);
+
+    /**
+     * Splits a subtree into the data below a key and the data at or above it
+     * @param node the root of the subtree
+     * @param key the key
+     * @param lft receives the subtree of the data below the key
+     * @param rgt receives the subtree of the data at or above the key
+     */
+    static void split(Node* node, const T& key, Node*& lft, Node*& rgt);
+
+    /**
+     * Joins two subtrees; all data of the first is below that of the second
+     * @param lft the root of the first subtree
+     * @param rgt the root of the second subtree
+     * @return the root of the joined subtree
+     */
+    static Node* merge(Node* lft, Node* rgt);
+
+    /**
+     * Inserts a node that is not yet in a subtree
+     * @param node the root of the subtree
+     * @param fresh the node to be inserted
+     * @return the new root of the subtree
+     */
+    static Node* insert(Node* node, Node* fresh);
+
+    /**
+     * An auxiliary recursive function for the copy constructor
+     * @param src the root of a subtree of the source tree
+     * @return the root of the copy
+     */
+    static Node* copy(const Node* src);
+
+    /**
+     * An auxiliary recursive function for the destructor
+     * @param node the root of a subtree
+     */
+    static void destroy(Node* node);
+
+    /**
+     * searches for the specified item in this tree
+     * @param item the search key
+     * @param parent receives the parent of the node found, or null
+     * @return the node holding the item, or null
+     */
+    Node* search(const T& item, Node** parent = nullptr) const;
+
+    /**
+     * Traverses the subtree rooted at the specified node in inorder
+     * @param node a node of this tree
+     * @param apply the function applied to each entry
+     */
+    void inorderTraverse(Node* node, FuncType apply) const;
+
+    /**
+     * Traverses the subtree rooted at the specified node in preorder
+     * @param node a node of this tree
+     * @param apply the function applied to each entry
+     */
+    void preorderTraverse(Node* node, FuncType apply) const;
+
+    /**
+     * Traverses the subtree rooted at the specified node in postorder
+     * @param node a node of this tree
+     * @param apply the function applied to each entry
+     */
+    void postorderTraverse(Node* node, FuncType apply) const;
+
+    /**
+     * Computes the height of the subtree rooted at the specified node
+     * @param node the root of a subtree
+     * @return the height of the subtree
+     */
+    long height(const Node* node) const;
+
+    /**
+     * Determines whether two subtrees have the same shape
+     * @param lft the root of the left subtree
+     * @param rgt the root of the right subtree
+     * @return true if the subtrees are isomorphic; otherwise, false
+     */
+    bool isomorphic(const Node* lft, const Node* rgt) const;
+
+    /**
+     * Determines whether the subtree rooted at the specified node has a
+     * left-heavy and/or a right-heavy node
+     * @param hlb set when a left-heavy node is found
+     * @param hrb set when a right-heavy node is found
+     * @param cur the root of a subtree
+     */
+    void bias(bool& hlb, bool& hrb, const Node* cur) const;
+
+public:
+    /**
+     * Constructs an empty treap
+     * @param seed the seed of the priority generator
+     */
+    Treap(uint64_t seed = 1254);
+
+    /**
+     * Copy constructor; the copy has the same shape and generator state
+     * @param other the tree to copy
+     */
+    Treap(const Treap<T>& other);
+
+    /**
+     * Move constructor
+     * @param other the tree to move
+     */
+    Treap(Treap<T>&& other);
+
+    /**
+     * Returns the tree memory to the system
+     */
+    virtual ~Treap();
+
+    /**
+     * copy assignment operator
+     * @param other the src tree
+     */
+    Treap<T>& operator=(const Treap<T>& other);
+
+    /**
+     * Determines whether the tree is empty.
+     * @return true if the tree is empty; otherwise, false
+     */
+    bool empty() const;
+
+    /**
+     * Inserts an item into the tree, or overwrites the item with the same
+     * key.
+     * @param item the value to be inserted.
+     */
+    void insert(T item);
+
+    /**
+     * Determines whether an item is in the tree.
+     * @param item item with a specified search key.
+     * @return true on success; false on failure.
+     */
+    bool inTree(T item) const;
+
+    /**
+     * Deletes an item from the tree.
+     * @param item item with a specified search key.
+     * @return true on success; false on failure.
+     */
+    bool remove(const T& item);
+
+    /**
+     * Returns the item in the tree with the specified key.
+     * @param key the key to the item to be retrieved.
+     * @return it with the specified key.
+     * @throws BstreeException if the item is not in the tree
+     */
+    const T& retrieve(const T& key) const;
+
+    /**
+     * Gives the number of node in this tree
+     * @return the size of the tree; the number of nodes in this tree.
+     */
+    long size() const;
+
+    /**
+     * Traverses the tree in inorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const T&) -> void
+     */
+    void inorderTraverse(FuncType apply) const;
+
+    /**
+     * Traverses the tree in preorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const T&) -> void
+     */
+    void preorderTraverse(FuncType apply) const;
+
+    /**
+     * Traverses the tree in postorder and applies the function visit
+     * once for each node.
+     * @param apply a pointer to a function of type (const T&) -> void
+     */
+    void postorderTraverse(FuncType apply) const;
+
+    /**
+     * Gives the height of this tree
+     * @return the height of this tree
+     */
+    long height() const;
+
+    /**
+     * Generates a vector of ancestors of the specified entry, nearest first
+     * @param entry an entry in this tree
+     * @return a vector of ancestors of the specified entry
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    vector<T> ancestors(T entry) const;
+
+    /**
+     * Generates the entries of the subtree rooted at the node containing
+     * the specified entry, the entry itself excluded, in preorder
+     * @param entry an entry in this tree
+     * @return a vector of descendants of the specified entry
+     * @throw BstreeException when the specified entry is not in this tree
+     */
+    vector<T> descendants(T entry) const;
+
+    /**
+     * Determines whether the left and right subtrees of the root
+     * of this tree are isomorphic
+     * @return true if they are isomorphic or the tree is empty;
+     * otherwise, false
+     */
+    bool isomorphic() const;
+
+    /**
+     * Gives a pointer to the parent of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the parent data or null for the root
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const T* getParent(T entry) const;
+
+    /**
+     * Gives a pointer to the sibling of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the sibling's data or null if it has none
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const T* getSibling(T entry) const;
+
+    /**
+     * Gives a pointer to the left child of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the left child's data or null if it has none
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const T* leftChild(T entry) const;
+
+    /**
+     * Gives a pointer to the right child of the specified entry
+     * @param entry an entry of this tree
+     * @return a pointer to the right child's data or null if it has none
+     * @throw BstreeException when this entry is not in this tree
+     */
+    const T* rightChild(T entry) const;
+
+    /**
+     * Determines whether this tree is a Fibonacci tree
+     * @return true if the tree is a Fibonacci tree; otherwise, false
+     */
+    bool isFibonacci() const;
+
+    /**
+     * Moves every item at or above a key into a new treap, in O(log n)
+     * @param key the key at which the tree is cut
+     * @return a treap of the items at or above the key; its generator is
+     * seeded from this one
+     */
+    Treap<T> split(const T& key);
+
+    /**
+     * Moves every item of another treap into this one, in O(log n); every
+     * item of the other treap must be above every item of this one
+     * @param other the treap to be emptied into this one
+     * @throw BstreeException when the key ranges overlap
+     */
+    void merge(Treap<T>& other);
+
+    /**
+     * Writes the tree to a snapshot file; see BstreeSnapshot.h
+     * @param filename the name of the snapshot
+     * @throw BstreeException when the file cannot be written
+     */
+    void save(const string& filename) const;
+
+    /**
+     * Replaces the tree by the contents of a snapshot file with the same
+     * shape; priorities are drawn anew and assigned in decreasing order
+     * along the preorder, which keeps the heap order
+     * @param filename the name of the snapshot
+     * @throw BstreeException when the file cannot be read
+     */
+    void open(const string& filename);
+};
+
+/**
+ * nested Node class definition
+ * @param <T> the data type of the treap
+ */
+template <typename T>
+class Treap<T>::Node
+{
+private:
+    /**
+     * the data item in this Node
+     */
+    T data;
+    /**
+     * pointers to the children of this Node
+     */
+    Node* left;
+    Node* right;
+    /**
+     * the heap priority of this Node
+     */
+    uint64_t priority;
+    /**
+     * the number of nodes in the subtree rooted at this Node
+     */
+    long count;
+    /**
+     * Granting friendship - access to private members of this class to the
+     * Treap<T> class
+     */
+    friend class Treap<T>;
+public:
+    /**
+     * Constructs a leaf node
+     * @param item the data to store in this node
+     * @param priority the heap priority of this node
+     */
+    Node(const T& item, uint64_t priority);
+};
+#endif //TREAP_H